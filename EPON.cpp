@@ -43,8 +43,8 @@ int main( int argc, char* argv[] )
                              parsed_time.tm_min,
                              parsed_time.tm_sec );
 
-    if( pos < 0 || pos > BUFFER_SIZE - 10 )
-        pos = BUFFER_SIZE - 10;
+    if( pos < 0 || pos > (int32s)( BUFFER_SIZE - 10 ))
+        pos = (int32s)( BUFFER_SIZE - 10 );
 
     ////////////////////////////////////////////////////////////
     // Initialize output streams
@@ -53,6 +53,7 @@ int main( int argc, char* argv[] )
     buffer[pos] = '\0';  OPEN_CONF_STREAM( buffer, BUFFER_SIZE );
     buffer[pos] = '\0';  OPEN_INFO_STREAM( buffer, BUFFER_SIZE );
     buffer[pos] = '\0';  OPEN_RSLT_STREAM( buffer, BUFFER_SIZE );
+    START_LOG();
 
     
     ////////////////////////////////////////////////////////////
@@ -72,6 +73,7 @@ int main( int argc, char* argv[] )
     ////////////////////////////////////////////////////////////
     // Close output streams
     ////////////////////////////////////////////////////////////
+    STOP_LOG();
     CLOSE_WARN_STREAM();
     CLOSE_CONF_STREAM();
     CLOSE_INFO_STREAM();
@@ -0,0 +1,925 @@
+/**********************************************************
+ * Filename:    EPON_bench.cpp
+ *
+ * Description: Microbenchmarks of the simulation kernel, the
+ *              traffic generator and the statistics, and an
+ *              end-to-end benchmark of scenario 001.
+ *
+ * Usage:       EPON_bench [--quick] [--filter text] [--out file.json]
+ *
+ *              --quick     short runs, for a smoke test
+ *              --filter    run only benchmarks whose name contains text
+ *              --out       write JSON to a file instead of stdout
+ *
+ *              Results are written in JSON format (see _bench.h),
+ *              progress is printed to stderr.
+ *********************************************************/
+
+#include <time.h>
+#include <iostream>
+
+using namespace std;
+
+#include "_types.h"
+#include "_util.h"
+#include "_bench.h"
+#include "sim_config.h"
+
+
+/////////////////////////////////////////////////////////////////////
+// Benchmark Parameters
+/////////////////////////////////////////////////////////////////////
+const DOUBLE        BENCH_MIN_TIME      = 0.2;      // seconds per timed run
+const DOUBLE        BENCH_QUICK_TIME    = 0.01;
+const int32s        BENCH_REPEATS       = 5;
+const int32s        BENCH_QUICK_REPEATS = 1;
+const int32u        BENCH_SEED          = 1;
+const int32s        BENCH_TABLE_SIZE    = 1 << 16;  // precomputed random values (power of 2)
+const GEN::load_t   BENCH_LOAD          = 0.5F;     // load of a single packet generator
+const float         BENCH_EPON_LOAD     = 0.5F;     // load of each LLID in the end-to-end benchmark
+const int32s        BENCH_EPON_WARMUP   = 1000000;  // events simulated before timing
+
+/////////////////////////////////////////////////////////////////////
+// Distributions of event intervals (ns) used by the event queue
+// benchmarks
+/////////////////////////////////////////////////////////////////////
+enum { DIST_EXPON, DIST_UNIFORM, DIST_BIMODAL };
+
+const char* DIST_NAME[] = { "expon", "uniform", "bimodal" };
+
+DESL::time_t NextInterval( int32s dist )
+{
+    switch( dist )
+    {
+        case DIST_EXPON:    return (DESL::time_t)( _exponent_() * 1000 ) + 1;
+        case DIST_UNIFORM:  return _uniform_int_( 1, 2000 );
+        default:            /* mostly packet-scale intervals, some timer-scale ones */
+                            return _uniform_real_0_1() < 0.9? _uniform_int_( 1, 100 ): _uniform_int_( 100000, 1000000 );
+    }
+}
+
+
+/////////////////////////////////////////////////////////////////////
+// CLASS:        class BenchEventHold
+// PURPOSE:      "Hold" model: the queue keeps 'pending' events; each
+//               operation takes the next event and registers it again
+//               with a new interval
+/////////////////////////////////////////////////////////////////////
+class BenchEventHold : public Benchmark
+{
+private:
+    int32s          Pending;
+    DESL::time_t*   pInterval;
+
+public:
+    BenchEventHold( const char* name, int32s pending, int32s dist ) : Benchmark( name )
+    {
+        Pending   = pending;
+        pInterval = new DESL::time_t[ BENCH_TABLE_SIZE ];
+        for( int32s n = 0; n < BENCH_TABLE_SIZE; n++ )
+            pInterval[n] = NextInterval( dist );
+    }
+
+    virtual ~BenchEventHold()       { delete [] pInterval; }
+
+    virtual void Setup( void )
+    {
+        for( int32s n = 0; n < Pending; n++ )
+            DESL::RegisterEvent( DESL::AllocateEvent(), pInterval[ n & ( BENCH_TABLE_SIZE - 1 ) ], NULL );
+    }
+
+    virtual int64u Run( int64u ops )
+    {
+        for( int64u n = 0; n < ops; n++ )
+            DESL::RegisterEvent( DESL::GetNextEvent(), pInterval[ n & ( BENCH_TABLE_SIZE - 1 ) ], NULL );
+        return (int64u) DESL::GlobalTime();
+    }
+
+    virtual void TearDown( void )   { DESL::GlobalReset(); }
+};
+
+/////////////////////////////////////////////////////////////////////
+// CLASS:        class BenchEventFillDrain
+// PURPOSE:      Registers 'pending' events, then takes all of them;
+//               one operation is one event registered and taken
+/////////////////////////////////////////////////////////////////////
+class BenchEventFillDrain : public Benchmark
+{
+private:
+    int32s          Pending;
+    DESL::time_t*   pInterval;
+
+public:
+    BenchEventFillDrain( const char* name, int32s pending, int32s dist ) : Benchmark( name )
+    {
+        Pending   = pending;
+        pInterval = new DESL::time_t[ BENCH_TABLE_SIZE ];
+        for( int32s n = 0; n < BENCH_TABLE_SIZE; n++ )
+            pInterval[n] = NextInterval( dist );
+    }
+
+    virtual ~BenchEventFillDrain()  { delete [] pInterval; }
+
+    virtual int64u Run( int64u ops )
+    {
+        int64u sum = 0;
+        for( int64u done = 0; done < ops; )
+        {
+            int64u batch = MIN< int64u >( ops - done, Pending );
+
+            for( int64u n = 0; n < batch; n++ )
+                DESL::RegisterEvent( DESL::AllocateEvent(), pInterval[ ( done + n ) & ( BENCH_TABLE_SIZE - 1 ) ], NULL );
+
+            for( int64u n = 0; n < batch; n++ )
+            {
+                DESL::evnt_t* pEvent = DESL::GetNextEvent();
+                sum += (int64u) DESL::GlobalTime();
+                DESL::DestroyEvent( pEvent );
+            }
+            done += batch;
+        }
+        return sum;
+    }
+
+    virtual void TearDown( void )   { DESL::GlobalReset(); }
+};
+
+
+/////////////////////////////////////////////////////////////////////
+// CLASS:        class TimerObject, class TimerProcess
+// PURPOSE:      Wake up every 'interval': event-driven (the object 
+//               registers its event again in ProcessEvent) and 
+//               process-oriented (co_await Delay)
+/////////////////////////////////////////////////////////////////////
+class TimerObject : public SimBase<>
+{
+private:
+    DESL::time_t    Interval;
+
+public:
+    TimerObject( DESL::time_t interval ) : SimBase<>( 0 )   { Interval = interval; }
+
+    void Begin( void )
+    {
+        DESL::evnt_t* ptr = DESL::AllocateEvent();
+        ptr->Consumer     = this;
+        RegisterEvent( ptr, Interval );
+    }
+
+    virtual void ProcessEvent( DESL::evnt_t* pEvent )   { RegisterEvent( pEvent, Interval ); }
+    virtual void Free( void )                           {}
+    virtual void Reset( void )                          {}
+};
+
+class TimerProcess : public SimProcess<>
+{
+private:
+    DESL::time_t    Interval;
+
+    virtual PROC::Task Run( void )
+    {
+        for( ;; )
+            co_await Delay( Interval );
+    }
+
+public:
+    TimerProcess( DESL::time_t interval ) : SimProcess<>( 0 )   { Interval = interval; }
+
+    void Begin( void )                                  { Start(); }
+};
+
+
+/////////////////////////////////////////////////////////////////////
+// CLASS:        class ForwardObject, class ForwardProcess
+// PURPOSE:      Objects connected in a ring; each one forwards every
+//               event it receives to the next one after 'interval': 
+//               event-driven and process-oriented (co_await Receive)
+/////////////////////////////////////////////////////////////////////
+class ForwardObject : public SimBase<>
+{
+private:
+    DESL::time_t    Interval;
+
+public:
+    ForwardObject( DESL::time_t interval ) : SimBase<>( 0 )   { Interval = interval; }
+
+    void Begin( void )
+    {
+        DESL::evnt_t* ptr = DESL::AllocateEvent();
+        ptr->Type         = EV_PCKT_ARRIVAL;
+        ptr->Consumer     = this;
+        RegisterEvent( ptr, Interval );
+    }
+
+    virtual void ProcessEvent( DESL::evnt_t* pEvent )
+    {
+        pEvent->Consumer = OutPort[0];
+        RegisterEvent( pEvent, Interval );
+    }
+    virtual void Free( void )                           {}
+    virtual void Reset( void )                          {}
+};
+
+class ForwardProcess : public SimProcess<>
+{
+private:
+    DESL::time_t    Interval;
+
+    virtual PROC::Task Run( void )
+    {
+        for( ;; )
+        {
+            DESL::evnt_t* pEvent = co_await Receive( EV_PCKT_ARRIVAL );
+            pEvent->Consumer = OutPort[0];
+            RegisterEvent( pEvent, Interval );
+        }
+    }
+
+public:
+    ForwardProcess( DESL::time_t interval ) : SimProcess<>( 0 )   { Interval = interval; }
+
+    void Begin( void )
+    {
+        Start();
+
+        DESL::evnt_t* ptr = DESL::AllocateEvent();
+        ptr->Type         = EV_PCKT_ARRIVAL;
+        ptr->Consumer     = this;
+        RegisterEvent( ptr, Interval );
+    }
+};
+
+
+/////////////////////////////////////////////////////////////////////
+// CLASS:        template < int16u PORTS > class HubObject
+// PURPOSE:      Forwards every event it receives to its output ports
+//               in turn after 'interval', as the OLT sends GATEs to
+//               the ONUs; PORTS is the number of ports or 
+//               DYNAMIC_PORTS (the OLT)
+/////////////////////////////////////////////////////////////////////
+template < int16u PORTS > class HubObject : public SimBase< PORTS >
+{
+private:
+    DESL::time_t    Interval;
+    int16u          Next;
+
+public:
+    HubObject( DESL::time_t interval, int16u ports ) : SimBase< PORTS >( 0, ports )
+    {
+        Interval = interval;
+        Next     = 0;
+    }
+
+    virtual void ProcessEvent( DESL::evnt_t* pEvent )
+    {
+        pEvent->Consumer = this->OutPort[ Next ];
+        if( ++Next == this->GetPortCount() )
+            Next = 0;
+        this->RegisterEvent( pEvent, Interval );
+    }
+    virtual void Free( void )                           {}
+    virtual void Reset( void )                          {}
+};
+
+
+/////////////////////////////////////////////////////////////////////
+// CLASS:        template < class OBJ > class BenchObjects
+// PURPOSE:      Creates 'count' objects connected in a ring, each 
+//               with an interval drawn from the uniform distribution,
+//               and dispatches their events; one operation is one 
+//               event dispatched
+/////////////////////////////////////////////////////////////////////
+template < class OBJ > class BenchObjects : public Benchmark
+{
+private:
+    int32s  Count;
+    OBJ**   pObject;
+
+public:
+    BenchObjects( const char* name, int32s count ) : Benchmark( name )
+    {
+        Count   = count;
+        pObject = new OBJ*[ Count ];
+        memset( pObject, 0, Count * sizeof( OBJ* ));
+    }
+
+    virtual ~BenchObjects()         { delete [] pObject; }
+
+    virtual void Setup( void )
+    {
+        for( int32s n = 0; n < Count; n++ )
+            pObject[n] = new OBJ( NextInterval( DIST_UNIFORM ));
+        for( int32s n = 0; n < Count; n++ )
+        {
+            pObject[n]->SetPort( pObject[ ( n + 1 ) % Count ] );
+            pObject[n]->Begin();
+        }
+    }
+
+    virtual int64u Run( int64u ops )
+    {
+        for( int64u n = 0; n < ops; n++ )
+            DESL::DispatchEvent( DESL::GetNextEvent() );
+        return (int64u) DESL::GlobalTime();
+    }
+
+    virtual void TearDown( void )
+    {
+        DESL::GlobalReset();
+        for( int32s n = 0; n < Count; n++ )
+            delete pObject[n];
+    }
+};
+
+
+/////////////////////////////////////////////////////////////////////
+// CLASS:        template < class HUB > class BenchFanout
+// PURPOSE:      A hub with 'count' ports, each connected to a
+//               ForwardObject that returns events to the hub; every
+//               leaf starts one event.  One operation is one event
+//               dispatched.
+/////////////////////////////////////////////////////////////////////
+template < class HUB > class BenchFanout : public Benchmark
+{
+private:
+    int16u          Count;
+    HUB*            pHub;
+    ForwardObject** pLeaf;
+
+public:
+    BenchFanout( const char* name, int16u count ) : Benchmark( name )
+    {
+        Count = count;
+        pHub  = NULL;
+        pLeaf = new ForwardObject*[ Count ];
+        memset( pLeaf, 0, Count * sizeof( ForwardObject* ));
+    }
+
+    virtual ~BenchFanout()          { delete [] pLeaf; }
+
+    virtual void Setup( void )
+    {
+        pHub = new HUB( NextInterval( DIST_UNIFORM ), Count );
+        for( int16u n = 0; n < Count; n++ )
+        {
+            pLeaf[n] = new ForwardObject( NextInterval( DIST_UNIFORM ));
+            pLeaf[n]->SetPort( pHub );
+            pHub->SetPort( pLeaf[n], n );
+        }
+        for( int16u n = 0; n < Count; n++ )
+            pLeaf[n]->Begin();
+    }
+
+    virtual int64u Run( int64u ops )
+    {
+        for( int64u n = 0; n < ops; n++ )
+            DESL::DispatchEvent( DESL::GetNextEvent() );
+        return (int64u) DESL::GlobalTime();
+    }
+
+    virtual void TearDown( void )
+    {
+        DESL::GlobalReset();
+        for( int16u n = 0; n < Count; n++ )
+            delete pLeaf[n];
+        delete pHub;
+    }
+};
+
+
+/////////////////////////////////////////////////////////////////////
+// CLASS:        class BenchGenerator
+// PURPOSE:      PacketGenerator::GetNextPacket() with the packet size
+//               distribution used by PacketSource; G is PACKET_GEN for
+//               a pool of any streams or PacketGeneratorDist with
+//               PacketGeneratorT< S > for streams of type S
+/////////////////////////////////////////////////////////////////////
+#define STATIC_GEN( S ) GEN::PacketGeneratorDist< int32s, MAX_PACKET_SIZE + 1, broadcom_frequency, GEN::PacketGeneratorT< S > >
+
+template < class G = PACKET_GEN > class BenchGenerator : public Benchmark
+{
+private:
+    G           Generator;
+
+public:
+    BenchGenerator( const char* name, typename G::ctor_t pf_strm, int16s pool_size ) :
+        Benchmark( name ),
+        Generator( 0, PACKET_OVERHEAD, MEAN_BURST_SIZE, pf_strm, pool_size, BENCH_LOAD ) {}
+
+    virtual int64u Run( int64u ops )
+    {
+        int64u sum = 0;
+        for( int64u n = 0; n < ops; n++ )
+            sum += Generator.GetNextPacket().Interval;
+        return sum;
+    }
+};
+
+
+/////////////////////////////////////////////////////////////////////
+// CLASS:        class AVLStreamPool, class HeapStreamPool
+// PURPOSE:      Stream pool of PacketGenerator: streams ordered by
+//               their next burst time.  Next() takes the head stream
+//               and puts it back 'interval' later.  AVLStreamPool is
+//               the AVL tree the generator used before, HeapStreamPool
+//               is the indexed heap it uses now.
+/////////////////////////////////////////////////////////////////////
+class AVLStreamPool
+{
+private:
+    class Node : public AVL::AVLNode< GEN::bytestamp_t >
+    {
+    public:
+        Node() : AVL::AVLNode< GEN::bytestamp_t >( 0 ) {}
+        inline void Advance( GEN::bytestamp_t interval )    { NodeKey += interval; }
+        inline GEN::bytestamp_t GetKey( void ) const        { return NodeKey; }
+    };
+
+    AVL::AVLTree< GEN::bytestamp_t > Tree;
+    Node*                            pNode;
+
+public:
+    AVLStreamPool( int32u count, const GEN::bytestamp_t* start )
+    {
+        pNode = new Node[ count ];
+        for( int32u n = 0; n < count; n++ )
+        {
+            pNode[n].Advance( start[n] );
+            Tree.AddNode( &pNode[n] );
+        }
+    }
+
+    virtual ~AVLStreamPool()    { delete [] pNode; }
+
+    inline GEN::bytestamp_t Next( GEN::bytestamp_t interval )
+    {
+        Node* pHead = (Node*) Tree.RemoveHead();
+        pHead->Advance( interval );
+        Tree.AddNode( pHead );
+        return pHead->GetKey();
+    }
+};
+
+class HeapStreamPool
+{
+private:
+    class Node : public HeapNode
+    {
+    public:
+        GEN::bytestamp_t Key;
+        Node()                                              { Key = 0; }
+        inline void Advance( GEN::bytestamp_t interval )    { Key += interval; }
+        inline GEN::bytestamp_t GetKey( void ) const        { return Key; }
+    };
+
+    IndexedHeap< Node, GEN::bytestamp_t >   Heap;
+    Node*                                   pNode;
+
+public:
+    HeapStreamPool( int32u count, const GEN::bytestamp_t* start )
+    {
+        pNode = new Node[ count ];
+        for( int32u n = 0; n < count; n++ )
+        {
+            pNode[n].Advance( start[n] );
+            Heap.AddNode( &pNode[n] );
+        }
+    }
+
+    virtual ~HeapStreamPool()   { delete [] pNode; }
+
+    inline GEN::bytestamp_t Next( GEN::bytestamp_t interval )
+    {
+        Node* pHead = Heap.GetHead();
+        pHead->Advance( interval );
+        Heap.UpdateHead();
+        return pHead->GetKey();
+    }
+};
+
+/////////////////////////////////////////////////////////////////////
+// CLASS:        template < class P > class BenchStreamPool
+// PURPOSE:      P::Next() with Pareto-distributed intervals between
+//               bursts of a stream; the pool of 'count' streams is
+//               created once and keeps running from one timed run to
+//               the next
+/////////////////////////////////////////////////////////////////////
+template < class P > class BenchStreamPool : public Benchmark
+{
+private:
+    P*                  pPool;
+    GEN::bytestamp_t*   pInterval;
+
+public:
+    BenchStreamPool( const char* name, int32s count ) : Benchmark( name )
+    {
+        pInterval = new GEN::bytestamp_t[ BENCH_TABLE_SIZE ];
+        for( int32s n = 0; n < BENCH_TABLE_SIZE; n++ )
+            pInterval[n] = (GEN::bytestamp_t)( _pareto_( 1.4 ) * MEAN_BURST_SIZE * count );
+        pPool = new P( count, pInterval );
+    }
+
+    virtual ~BenchStreamPool()
+    {
+        delete pPool;
+        delete [] pInterval;
+    }
+
+    virtual int64u Run( int64u ops )
+    {
+        int64u sum = 0;
+        for( int64u n = 0; n < ops; n++ )
+            sum += pPool->Next( pInterval[ n & ( BENCH_TABLE_SIZE - 1 ) ] );
+        return sum;
+    }
+};
+
+
+/////////////////////////////////////////////////////////////////////
+// CLASS:        class BenchPacketSize
+// PURPOSE:      GenericDistribByIndex::GetIndex() over the packet
+//               size distribution
+/////////////////////////////////////////////////////////////////////
+class BenchPacketSize : public Benchmark
+{
+private:
+    typedef GenericDistribByIndex< int32s, MAX_PACKET_SIZE + 1, broadcom_frequency > size_dist_t;
+    size_dist_t Distribution;       // cdf is a compile-time constant
+
+public:
+    BenchPacketSize( const char* name ) : Benchmark( name ) {}
+
+    virtual int64u Run( int64u ops )
+    {
+        int64u sum = 0;
+        for( int64u n = 0; n < ops; n++ )
+            sum += size_dist_t::GetIndex();
+        return sum;
+    }
+};
+
+
+/////////////////////////////////////////////////////////////////////
+// CLASS:        class BenchRandom
+// PURPOSE:      Random variates of _rand_MT.h
+/////////////////////////////////////////////////////////////////////
+enum { RND_UNIFORM, RND_EXPON, RND_PARETO };
+
+class BenchRandom : public Benchmark
+{
+private:
+    int32s  Variate;
+
+public:
+    BenchRandom( const char* name, int32s variate ) : Benchmark( name ) { Variate = variate; }
+
+    virtual int64u Run( int64u ops )
+    {
+        DOUBLE sum = 0;
+        switch( Variate )
+        {
+            case RND_UNIFORM:   for( int64u n = 0; n < ops; n++ ) sum += _uniform_real_0_1();   break;
+            case RND_EXPON:     for( int64u n = 0; n < ops; n++ ) sum += _exponent_();          break;
+            case RND_PARETO:    for( int64u n = 0; n < ops; n++ ) sum += _pareto_( 1.4 );       break;
+        }
+        return (int64u) sum;
+    }
+};
+
+
+/////////////////////////////////////////////////////////////////////
+// CLASS:        template < class S > class BenchStats
+// PURPOSE:      S::Sample() with packet delay-like values (seconds)
+/////////////////////////////////////////////////////////////////////
+template < class S > class BenchStats : public Benchmark
+{
+private:
+    S           Statistic;
+    stat_t*     pSample;
+
+public:
+    BenchStats( const char* name, const S& statistic ) : Benchmark( name ), Statistic( statistic )
+    {
+        pSample = new stat_t[ BENCH_TABLE_SIZE ];
+        for( int32s n = 0; n < BENCH_TABLE_SIZE; n++ )
+            pSample[n] = _exponent_() * 0.002;
+    }
+
+    virtual ~BenchStats()           { delete [] pSample; }
+
+    virtual int64u Run( int64u ops )
+    {
+        for( int64u n = 0; n < ops; n++ )
+            Statistic.Sample( pSample[ n & ( BENCH_TABLE_SIZE - 1 ) ] );
+        return (int64u) Statistic.GetCount();
+    }
+};
+
+
+/////////////////////////////////////////////////////////////////////
+// CLASS:        class BenchEPON
+// PURPOSE:      Events per second of scenario 001: all LLIDs at
+//               BENCH_EPON_LOAD, every event passes through Monitor()
+//               as in SimulateLoadPoint().  The network is created
+//               once and keeps running from one timed run to the next.
+/////////////////////////////////////////////////////////////////////
+class BenchEPON : public Benchmark
+{
+private:
+    BOOL    Initialized;
+
+    inline void Simulate( int64u events )
+    {
+        for( int64u n = 0; n < events; n++ )
+        {
+            DESL::evnt_t* pEvent = DESL::GetNextEvent();
+            Monitor( pEvent );
+            DESL::DispatchEvent( pEvent );
+        }
+    }
+
+public:
+    BenchEPON( const char* name ) : Benchmark( name )   { Initialized = FALSE; }
+
+    virtual ~BenchEPON()
+    {
+        if( Initialized )
+            DestroyEPON();
+    }
+
+    virtual void Setup( void )
+    {
+        if( Initialized )
+            return;
+
+        InitializeEPON();
+        DESL::GlobalReset();
+        for( int16s n = 0; n < Topology.NumLLID; n++ )
+            pSRC[n]->SetLoad( BENCH_EPON_LOAD );
+
+        Simulate( BENCH_EPON_WARMUP );
+        Initialized = TRUE;
+    }
+
+    virtual int64u Run( int64u ops )
+    {
+        Simulate( ops );
+        return (int64u) DESL::GlobalTime();
+    }
+};
+
+
+/********************************************************************/
+/********************************************************************/
+int main( int argc, char* argv[] )
+{
+    BOOL        quick  = FALSE;
+    const char* filter = NULL;
+    const char* output = NULL;
+    FILE*       file   = stdout;
+
+    for( int n = 1; n < argc; n++ )
+    {
+        if( strcmp( argv[n], "--quick" ) == 0 )                     quick  = TRUE;
+        else if( strcmp( argv[n], "--filter" ) == 0 && n + 1 < argc ) filter = argv[++n];
+        else if( strcmp( argv[n], "--out" ) == 0 && n + 1 < argc )    output = argv[++n];
+        else
+        {
+            fprintf( stderr, "Usage: %s [--quick] [--filter text] [--out file.json]\n", argv[0] );
+            return 1;
+        }
+    }
+
+#if defined( _MSC_VER )
+    if( output && fopen_s( &file, output, "w" ) != 0 )
+        file = NULL;
+#else
+    if( output )
+        file = fopen( output, "w" );
+#endif
+    if( file == NULL )
+    {
+        fprintf( stderr, "Cannot open %s\n", output );
+        return 1;
+    }
+
+    InitAllocator();
+    START_LOG();
+    RND.seed( BENCH_SEED );
+
+    BenchmarkSuite suite( file, "EPON", quick? BENCH_QUICK_TIME: BENCH_MIN_TIME,
+                                        quick? BENCH_QUICK_REPEATS: BENCH_REPEATS, filter );
+    char name[ 96 ];
+
+    ////////////////////////////////////////////////////////////
+    // Event queue
+    ////////////////////////////////////////////////////////////
+    const int32s pending[] = { 16, 256, 4096, 65536 };
+
+    for( int32s dist = DIST_EXPON; dist <= DIST_BIMODAL; dist++ )
+        for( int32u p = 0; p < sizeof( pending ) / sizeof( pending[0] ); p++ )
+        {
+            _snprintf_s( name, sizeof( name ), sizeof( name ) - 1, "event_queue/hold/%s/%d", DIST_NAME[ dist ], (int) pending[p] );
+            if( suite.IsSelected( name ))
+            {
+                BenchEventHold bench( name, pending[p], dist );
+                suite.Measure( bench );
+            }
+        }
+
+    for( int32u p = 0; p < sizeof( pending ) / sizeof( pending[0] ); p++ )
+    {
+        _snprintf_s( name, sizeof( name ), sizeof( name ) - 1, "event_queue/fill_drain/expon/%d", (int) pending[p] );
+        if( suite.IsSelected( name ))
+        {
+            BenchEventFillDrain bench( name, pending[p], DIST_EXPON );
+            suite.Measure( bench );
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Event-driven and process-oriented (coroutine) objects
+    ////////////////////////////////////////////////////////////
+    const int32s objects[] = { 16, 4096 };
+
+    for( int32u p = 0; p < sizeof( objects ) / sizeof( objects[0] ); p++ )
+    {
+        _snprintf_s( name, sizeof( name ), sizeof( name ) - 1, "objects/timer/event/%d", (int) objects[p] );
+        if( suite.IsSelected( name ))
+        {
+            BenchObjects< TimerObject > bench( name, objects[p] );
+            suite.Measure( bench );
+        }
+
+        _snprintf_s( name, sizeof( name ), sizeof( name ) - 1, "objects/timer/process/%d", (int) objects[p] );
+        if( suite.IsSelected( name ))
+        {
+            BenchObjects< TimerProcess > bench( name, objects[p] );
+            suite.Measure( bench );
+        }
+
+        _snprintf_s( name, sizeof( name ), sizeof( name ) - 1, "objects/forward/event/%d", (int) objects[p] );
+        if( suite.IsSelected( name ))
+        {
+            BenchObjects< ForwardObject > bench( name, objects[p] );
+            suite.Measure( bench );
+        }
+
+        _snprintf_s( name, sizeof( name ), sizeof( name ) - 1, "objects/forward/process/%d", (int) objects[p] );
+        if( suite.IsSelected( name ))
+        {
+            BenchObjects< ForwardProcess > bench( name, objects[p] );
+            suite.Measure( bench );
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Port table with a fixed number of ports (in the object) 
+    // and with DYNAMIC_PORTS (allocated, as in the OLT)
+    ////////////////////////////////////////////////////////////
+    if( suite.IsSelected( "objects/fanout/fixed/16" ))
+    {
+        BenchFanout< HubObject< 16 > > bench( "objects/fanout/fixed/16", 16 );
+        suite.Measure( bench );
+    }
+
+    if( suite.IsSelected( "objects/fanout/dynamic/16" ))
+    {
+        BenchFanout< HubObject< DYNAMIC_PORTS > > bench( "objects/fanout/dynamic/16", 16 );
+        suite.Measure( bench );
+    }
+
+    if( suite.IsSelected( "objects/fanout/fixed/256" ))
+    {
+        BenchFanout< HubObject< 256 > > bench( "objects/fanout/fixed/256", 256 );
+        suite.Measure( bench );
+    }
+
+    if( suite.IsSelected( "objects/fanout/dynamic/256" ))
+    {
+        BenchFanout< HubObject< DYNAMIC_PORTS > > bench( "objects/fanout/dynamic/256", 256 );
+        suite.Measure( bench );
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Traffic generator
+    ////////////////////////////////////////////////////////////
+    struct { const char* Name; GEN::PF_STREAM_CTOR Ctor; int16s Pool; } generators[] =
+    {
+        { "generator/pareto/16",         CreateParetoStream,     16   },
+        { "generator/pareto/128",        CreateParetoStream,     128  },
+        { "generator/pareto/1024",       CreateParetoStream,     1024 },
+        { "generator/pareto/4096",       CreateParetoStream,     4096 },
+        { "generator/expon/128",         CreateExponStream,      128  },
+        { "generator/expon_aggregate",   CreateExponAggregate,   1    },
+        { "generator/cbr/128",           CreateCBRStream,        128  },
+        { "generator/video/128",         CreateVideoStream,      128  },
+        { "generator/fgn",               CreateFGNStream,        1    },
+    };
+
+    for( int32u g = 0; g < sizeof( generators ) / sizeof( generators[0] ); g++ )
+        if( suite.IsSelected( generators[g].Name ))
+        {
+            BenchGenerator<> bench( generators[g].Name, generators[g].Ctor, generators[g].Pool );
+            suite.Measure( bench );
+        }
+
+    // same streams called statically (PacketSourceT< S >)
+    for( int32u g = 0; g < sizeof( generators ) / sizeof( generators[0] ); g++ )
+    {
+        char name[ 64 ];
+        _snprintf_s( name, sizeof( name ), sizeof( name ) - 1, "%s/static", generators[g].Name );
+        if( !suite.IsSelected( name ))
+            continue;
+
+        if( generators[g].Ctor == CreateParetoStream )
+        {
+            BenchGenerator< STATIC_GEN( GEN::StreamPareto ) > bench( name, ConstructStream, generators[g].Pool );
+            suite.Measure( bench );
+        }
+        else if( generators[g].Ctor == CreateExponStream )
+        {
+            BenchGenerator< STATIC_GEN( GEN::StreamExpon ) > bench( name, ConstructStream, generators[g].Pool );
+            suite.Measure( bench );
+        }
+        else if( generators[g].Ctor == CreateCBRStream )
+        {
+            BenchGenerator< STATIC_GEN( GEN::StreamCBR ) > bench( name, ConstructStream, generators[g].Pool );
+            suite.Measure( bench );
+        }
+        else if( generators[g].Ctor == CreateVideoStream )
+        {
+            BenchGenerator< STATIC_GEN( GEN::StreamVideo ) > bench( name, ConstructStream, generators[g].Pool );
+            suite.Measure( bench );
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Stream pool of the traffic generator: AVL tree vs. heap
+    ////////////////////////////////////////////////////////////
+    const int32s pools[] = { 16, 128, 1024, 4096 };
+
+    for( int32u p = 0; p < sizeof( pools ) / sizeof( pools[0] ); p++ )
+    {
+        _snprintf_s( name, sizeof( name ), sizeof( name ) - 1, "stream_pool/avl/%d", (int) pools[p] );
+        if( suite.IsSelected( name ))
+        {
+            BenchStreamPool< AVLStreamPool > bench( name, pools[p] );
+            suite.Measure( bench );
+        }
+
+        _snprintf_s( name, sizeof( name ), sizeof( name ) - 1, "stream_pool/heap/%d", (int) pools[p] );
+        if( suite.IsSelected( name ))
+        {
+            BenchStreamPool< HeapStreamPool > bench( name, pools[p] );
+            suite.Measure( bench );
+        }
+    }
+
+    {
+        BenchPacketSize bench( "random/packet_size" );
+        suite.Measure( bench );
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Random variates
+    ////////////////////////////////////////////////////////////
+    {
+        BenchRandom uniform( "random/uniform", RND_UNIFORM );
+        BenchRandom expon(   "random/exponent", RND_EXPON );
+        BenchRandom pareto(  "random/pareto", RND_PARETO );
+        suite.Measure( uniform );
+        suite.Measure( expon );
+        suite.Measure( pareto );
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Statistics
+    ////////////////////////////////////////////////////////////
+    {
+        BenchStats< Stats >         stats(   "stats/stats",        Stats() );
+        BenchStats< Distrib<100> >  distrib( "stats/distrib_100",  Distrib<100>( 0, 0.0002 ));
+        BenchStats< HDRDistrib<> >  hdr(     "stats/hdr_distrib",  HDRDistrib<>() );
+        BenchStats< BatchMeans<> >  batch(   "stats/batch_means",  BatchMeans<>() );
+        suite.Measure( stats );
+        suite.Measure( distrib );
+        suite.Measure( hdr );
+        suite.Measure( batch );
+    }
+
+    ////////////////////////////////////////////////////////////
+    // End-to-end scenario (must be last: it creates the network)
+    ////////////////////////////////////////////////////////////
+    if( suite.IsSelected( "epon/events" ))
+    {
+        BenchEPON bench( "epon/events" );
+        suite.Measure( bench );
+    }
+
+    suite.Finish();
+
+    STOP_LOG();
+    if( file != stdout )
+        fclose( file );
+    return 0;
+}
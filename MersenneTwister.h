@@ -138,7 +138,7 @@ inline MTRand::uint32 MTRand::randInt()
 	if( left == 0 ) reload();
 	--left;
 		
-	register uint32 s1;
+	uint32 s1;
 	s1 = *pNext++;
 	s1 ^= (s1 >> 11);
 	s1 ^= (s1 <<  7) & 0x9d2c5680U;
@@ -155,8 +155,8 @@ inline MTRand::uint32 MTRand::randInt( const uint32& n )
 inline void MTRand::seed( uint32 oneSeed )
 {
 	// Seed the generator with a simple uint32
-	register uint32 *s;
-	register int i;
+	uint32 *s;
+	int i;
 	for( i = N, s = state;
 	     i--;
 		 *s    = oneSeed & 0xffff0000,
@@ -173,8 +173,8 @@ inline void MTRand::seed( uint32 *const bigSeed )
 	// allows any one of those to be chosen by providing 19937 bits.
 	// Theoretically, the array can contain any values except all zeroes.
 	// Just call seed() if you want to get array from /dev/urandom
-	register uint32 *s = state, *b = bigSeed;
-	register int i = N;
+	uint32 *s = state, *b = bigSeed;
+	int i = N;
 	for( ; i--; *s++ = *b++ ) {}
 	reload();
 }
@@ -190,9 +190,9 @@ inline void MTRand::seed()
 	FILE* urandom = fopen( "/dev/urandom", "rb" );
 	if( urandom )
 	{
-		register uint32 *s = state;
-		register int i = N;
-		register bool success = true;
+		uint32 *s = state;
+		int i = N;
+		bool success = true;
 		for( ; success && i--;
 		     success = fread( s++, sizeof(uint32), 1, urandom ) ) {}
 		fclose(urandom);
@@ -212,13 +212,13 @@ inline void MTRand::reload()
 {
 	// Generate N new values in state
 	// Made clearer and faster by Matthew Bellew (matthew.bellew@home.com)
-	register uint32 *p = state;
-	register int i;
-	for( i = N - M; i--; )
-		*p++ = twist( p[M], p[0], p[1] );
-	for( i = M; --i; )
-		*p++ = twist( p[M-N], p[0], p[1] );
-	*p = twist( p[M-N], p[0], state[0] );
+	uint32 *p = state;
+	int i;
+	for( i = (int) N - (int) M; i--; ++p )
+		*p = twist( p[M], p[0], p[1] );
+	for( i = M; --i; ++p )
+		*p = twist( p[(int) M - (int) N], p[0], p[1] );
+	*p = twist( p[(int) M - (int) N], p[0], state[0] );
 
 	left = N, pNext = state;
 }
@@ -252,9 +252,9 @@ inline MTRand::uint32 MTRand::hash( time_t t, clock_t c )
 
 inline void MTRand::save( uint32* saveArray ) const
 {
-	register uint32 *sa = saveArray;
-	register const uint32 *s = state;
-	register int i = N;
+	uint32 *sa = saveArray;
+	const uint32 *s = state;
+	int i = N;
 	for( ; i--; *sa++ = *s++ ) {}
 	*sa = left;
 }
@@ -262,9 +262,9 @@ inline void MTRand::save( uint32* saveArray ) const
 
 inline void MTRand::load( uint32 *const loadArray )
 {
-	register uint32 *s = state;
-	register uint32 *la = loadArray;
-	register int i = N;
+	uint32 *s = state;
+	uint32 *la = loadArray;
+	int i = N;
 	for( ; i--; *s++ = *la++ ) {}
 	left = *la;
 	pNext = &state[N-left];
@@ -273,8 +273,8 @@ inline void MTRand::load( uint32 *const loadArray )
 
 inline ostream& operator<<( ostream& os, const MTRand& mtrand )
 {
-	register const MTRand::uint32 *s = mtrand.state;
-	register int i = mtrand.N;
+	const MTRand::uint32 *s = mtrand.state;
+	int i = mtrand.N;
 	for( ; i--; os << *s++ << "\t" ) {}
 	return os << mtrand.left;
 }
@@ -282,8 +282,8 @@ inline ostream& operator<<( ostream& os, const MTRand& mtrand )
 
 inline istream& operator>>( istream& is, MTRand& mtrand )
 {
-	register MTRand::uint32 *s = mtrand.state;
-	register int i = mtrand.N;
+	MTRand::uint32 *s = mtrand.state;
+	int i = mtrand.N;
 	for( ; i--; is >> *s++ ) {}
 	is >> mtrand.left;
 	mtrand.pNext = &mtrand.state[mtrand.N-mtrand.left];
@@ -0,0 +1,189 @@
+/**********************************************************
+ * Filename:    _bench.h
+ *
+ * Description: This file contains declaration for
+ *              class Benchmark
+ *              class BenchmarkSuite
+ *              used to time small pieces of code and
+ *              report the results in JSON format
+ *
+ *********************************************************/
+
+#ifndef _BENCH_H_V001_INCLUDED_
+#define _BENCH_H_V001_INCLUDED_
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <chrono>
+#include "_types.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+// class Benchmark
+//
+// A benchmark performs a number of operations in Run() and returns a value
+// computed from their results, so that the compiler cannot remove them.
+// Setup() and TearDown() are called before and after each timed run and are
+// not included in the time.
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+class Benchmark
+{
+private:
+    char    Name[ 96 ];
+
+public:
+    Benchmark( const char* name )
+    {
+        _snprintf_s( Name, sizeof( Name ), sizeof( Name ) - 1, "%s", name );
+    }
+
+    virtual ~Benchmark()                    {}
+
+    inline const char* GetName( void ) const { return Name; }
+
+    virtual void    Setup( void )           {}
+    virtual int64u  Run( int64u ops )       = 0;
+    virtual void    TearDown( void )        {}
+};
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+// class BenchmarkSuite
+//
+// Measure() first doubles the number of operations until a run takes at least
+// MinTime seconds, then repeats the run Repeats times with that number of
+// operations.  The median and the minimum time per operation are reported.
+//
+// JSON output:
+//
+//      {
+//        "suite": "...", "compiler": "...", "date": "...",
+//        "results": [
+//          { "name": "...", "ops": N, "repeats": R,
+//            "ns_per_op": median, "ns_per_op_min": min, "ops_per_sec": 1e9 / median },
+//          ...
+//        ]
+//      }
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+class BenchmarkSuite
+{
+private:
+    FILE*           pFile;
+    const char*     Filter;
+    DOUBLE          MinTime;        // minimum duration of a timed run (seconds)
+    int32s          Repeats;
+    int32s          Results;
+    int64u          Sink;           // combined return values of all runs
+
+    ///////////////////////////////////////////////////////////////////////////
+    static inline DOUBLE Now( void )
+    {
+        return std::chrono::duration< DOUBLE >( std::chrono::steady_clock::now().time_since_epoch() ).count();
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline DOUBLE TimeRun( Benchmark& bench, int64u ops )
+    {
+        bench.Setup();
+        DOUBLE start = Now();
+        Sink += bench.Run( ops );
+        DOUBLE stop  = Now();
+        bench.TearDown();
+        return stop - start;
+    }
+
+public:
+    BenchmarkSuite( FILE* file, const char* suite, DOUBLE min_time, int32s repeats, const char* filter = NULL )
+    {
+        char       date[ 32 ];
+        time_t     now = time( NULL );
+        struct tm  parsed_time;
+
+        pFile   = file;
+        Filter  = filter;
+        MinTime = min_time;
+        Repeats = MAX< int32s >( repeats, 1 );
+        Results = 0;
+        Sink    = 0;
+
+        localtime_s( &parsed_time, &now );
+        strftime( date, sizeof( date ), "%Y-%m-%dT%H:%M:%S", &parsed_time );
+
+#if defined( _MSC_VER )
+        fprintf( pFile, "{\n  \"suite\": \"%s\",\n  \"compiler\": \"MSVC %d\",\n", suite, _MSC_VER );
+#elif defined( __clang__ )
+        fprintf( pFile, "{\n  \"suite\": \"%s\",\n  \"compiler\": \"%s\",\n", suite, __VERSION__ );
+#elif defined( __GNUC__ )
+        fprintf( pFile, "{\n  \"suite\": \"%s\",\n  \"compiler\": \"GCC %s\",\n", suite, __VERSION__ );
+#else
+        fprintf( pFile, "{\n  \"suite\": \"%s\",\n  \"compiler\": \"unknown\",\n", suite );
+#endif
+        fprintf( pFile, "  \"date\": \"%s\",\n  \"results\": [", date );
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Closes the JSON document
+    ///////////////////////////////////////////////////////////////////////////
+    void Finish( void )
+    {
+        fprintf( pFile, "\n  ],\n  \"checksum\": %llu\n}\n", (unsigned long long) Sink );
+        fflush( pFile );
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline BOOL IsSelected( const char* name ) const
+    {
+        return Filter == NULL || strstr( name, Filter ) != NULL;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Times the benchmark and writes its result; the benchmark is skipped
+    // if its name does not contain the filter string
+    ///////////////////////////////////////////////////////////////////////////
+    void Measure( Benchmark& bench )
+    {
+        if( !IsSelected( bench.GetName() ))
+            return;
+
+        int64u ops = 1;
+        while( TimeRun( bench, ops ) < MinTime && ops < ( (int64u) 1 << 40 ))
+            ops *= 2;
+
+        DOUBLE* times = new DOUBLE[ Repeats ];
+        for( int32s r = 0; r < Repeats; r++ )
+        {
+            times[r] = TimeRun( bench, ops );
+
+            /* insertion sort, Repeats is small */
+            for( int32s n = r; n > 0 && times[n] < times[n - 1]; n-- )
+                SWAP( times[n], times[n - 1] );
+        }
+
+        DOUBLE median = times[ Repeats / 2 ] * 1e9 / ops;
+        DOUBLE best   = times[0] * 1e9 / ops;
+        delete [] times;
+
+        fprintf( pFile, "%s\n    { \"name\": \"%s\", \"ops\": %llu, \"repeats\": %d, "
+                        "\"ns_per_op\": %.3f, \"ns_per_op_min\": %.3f, \"ops_per_sec\": %.1f }",
+                 Results++? ",": "", bench.GetName(), (unsigned long long) ops, (int) Repeats,
+                 median, best, median > 0? 1e9 / median: 0.0 );
+        fflush( pFile );
+
+        fprintf( stderr, "%-48s %12.2f ns/op\n", bench.GetName(), median );
+    }
+};
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+
+#endif /* _BENCH_H_V001_INCLUDED_ */
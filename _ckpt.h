@@ -0,0 +1,125 @@
+/**********************************************************
+ * Filename:    _ckpt.h
+ *
+ * Description: This file contains declaration for class Archive
+ *              used to write and read binary checkpoints
+ *
+ *********************************************************/
+
+#ifndef _CKPT_H_V001_INCLUDED_
+#define _CKPT_H_V001_INCLUDED_
+
+#include <stdio.h>
+#include "_types.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+// class Archive
+//
+// A binary stream that is either written or read.  Classes implement a single
+// method Serialize( Archive& ) which is used in both directions, e.g.,
+//
+//      void Serialize( Archive& ar )  { ar & Count & Delay; }
+//
+// writes Count and Delay to a checkpoint, or reads them back from it.  Values
+// are stored in native binary format, so a checkpoint can be restored only by
+// the same build of the simulator.
+//
+// Once an I/O operation fails, all following operations are ignored and
+// IsGood() returns FALSE.
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+const int32u ARCHIVE_MAGIC   = 0x54504B43;  // "CKPT"
+const int32u ARCHIVE_VERSION = 4;
+
+class Archive
+{
+private:
+    FILE*   pFile;
+    BOOL    Writing;
+    BOOL    Failed;
+    BOOL    Owner;      // TRUE if file was opened (and must be closed) by Archive
+
+public:
+    Archive()                                { pFile = NULL; Writing = Failed = Owner = FALSE; }
+    Archive( FILE* file, BOOL writing )      { pFile = file; Writing = writing; Failed = ( file == NULL ); Owner = FALSE; }
+    virtual ~Archive()                       { Close(); }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline BOOL Open( const char* file_name, BOOL writing )
+    {
+        Close();
+#if defined( _MSC_VER )
+        if( fopen_s( &pFile, file_name, writing? "wb": "rb" ) != 0 )
+            pFile = NULL;
+#else
+        pFile   = fopen( file_name, writing? "wb": "rb" );
+#endif
+        Writing = writing;
+        Failed  = ( pFile == NULL );
+        Owner   = TRUE;
+        return !Failed;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+    inline BOOL Close( void )
+    {
+        if( pFile && Owner && fclose( pFile ) != 0 )
+            Failed = TRUE;
+        if( pFile && !Owner && Writing && fflush( pFile ) != 0 )
+            Failed = TRUE;
+
+        pFile = NULL;
+        return !Failed;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline BOOL IsWriting( void ) const     { return Writing; }
+    inline BOOL IsReading( void ) const     { return !Writing; }
+    inline BOOL IsGood( void )    const     { return pFile != NULL && !Failed; }
+    inline void SetFailed( void )           { Failed = TRUE; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void Raw( void* ptr, size_t size )
+    {
+        if( IsGood() && size > 0 )
+        {
+            size_t n = Writing? fwrite( ptr, size, 1, pFile ): fread( ptr, size, 1, pFile );
+            if( n != 1 )  Failed = TRUE;
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Writes or reads a value of a plain (memcpy-able) type
+    ///////////////////////////////////////////////////////////////////////////
+    template < class T > inline Archive& operator& ( T& val )
+    {
+        Raw( &val, sizeof( T ));
+        return *this;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Writes a value, or reads one and verifies that it matches 'val'.
+    // Used for file headers and for the counts that must not change
+    // between the saved and the restored simulation.
+    ///////////////////////////////////////////////////////////////////////////
+    template < class T > inline BOOL Check( T val )
+    {
+        T tmp = val;
+        *this & tmp;
+        if( tmp != val )  Failed = TRUE;
+        return IsGood();
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline BOOL Header( int32u tag )
+    {
+        return Check( ARCHIVE_MAGIC ) && Check( ARCHIVE_VERSION ) && Check( tag );
+    }
+};
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+
+#endif /* _CKPT_H_V001_INCLUDED_ */
@@ -0,0 +1,89 @@
+/**********************************************************
+ * Filename:    _compat.h
+ *
+ * Description: This file contains replacements for the
+ *              Microsoft C runtime functions used by the
+ *              simulator, for builds outside of Windows
+ *
+ *********************************************************/
+
+#ifndef _COMPAT_H_V001_INCLUDED_
+#define _COMPAT_H_V001_INCLUDED_
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined( _WIN32 )
+
+    #include <crtdbg.h>     // _ASSERT()
+    #include <conio.h>      // _getch()
+
+#else
+
+    #include <assert.h>
+
+    /////////////////////////////////////////////////////////////////////
+    // Debug assertion (crtdbg.h)
+    /////////////////////////////////////////////////////////////////////
+    #define _ASSERT( expr )     assert( expr )
+
+    /////////////////////////////////////////////////////////////////////
+    // Formatted output of at most 'count' characters (not counting the
+    // terminating null) into a buffer of 'size' bytes.  Unlike the
+    // Microsoft version, a truncated output returns the full length
+    // instead of -1.
+    /////////////////////////////////////////////////////////////////////
+    #define _snprintf_s( buffer, size, count, ... )                         \
+            snprintf( buffer, (size_t)( count ) + 1 < (size_t)( size )?     \
+                              (size_t)( count ) + 1: (size_t)( size ), __VA_ARGS__ )
+
+    /////////////////////////////////////////////////////////////////////
+    inline int localtime_s( struct tm* result, const time_t* t )
+    {
+        return localtime_r( t, result )? 0: -1;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    inline int ctime_s( char* buffer, size_t size, const time_t* t )
+    {
+        struct tm parsed_time;
+        if( localtime_s( &parsed_time, t ) != 0 || strftime( buffer, size, "%a %b %d %H:%M:%S %Y\n", &parsed_time ) == 0 )
+            return -1;
+        return 0;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    inline int strcat_s( char* dst, size_t size, const char* src )
+    {
+        size_t len = strlen( dst );
+        if( len + strlen( src ) >= size )
+            return -1;
+        memcpy( dst + len, src, strlen( src ) + 1 );
+        return 0;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // Waits for a key (conio.h); the input has to be followed by Enter
+    /////////////////////////////////////////////////////////////////////
+    inline int _getch( void )   { return getchar(); }
+
+#endif
+
+/////////////////////////////////////////////////////////////////////
+// PROFILE_DUMP() writes the profile of an instrumented build; needed
+// before _exit(), which does not write it.  The profile runtime is
+// referenced weakly, so the code is the same with and without
+// instrumentation (the profile must match the code it is used for).
+/////////////////////////////////////////////////////////////////////
+#if defined( __clang__ ) && !defined( _WIN32 )
+    extern "C" int __llvm_profile_write_file( void ) __attribute__(( weak ));
+    #define PROFILE_DUMP()      if( __llvm_profile_write_file ) __llvm_profile_write_file()
+#elif defined( __GNUC__ ) && !defined( _WIN32 )
+    extern "C" void __gcov_dump( void ) __attribute__(( weak ));
+    #define PROFILE_DUMP()      if( __gcov_dump ) __gcov_dump()
+#else
+    #define PROFILE_DUMP()
+#endif
+
+#endif /* _COMPAT_H_V001_INCLUDED_ */
@@ -0,0 +1,100 @@
+/**********************************************************
+ * Filename:    _fft.h
+ *
+ * Description: This file contains declaration for class FFT,
+ *              an in-place radix-2 fast Fourier transform
+ *
+ *********************************************************/
+
+#ifndef _FFT_H_V001_INCLUDED_
+#define _FFT_H_V001_INCLUDED_
+
+#include <math.h>
+#include <complex>
+#include "_types.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+// class FFT
+//
+// Forward discrete Fourier transform of a fixed size N (a power of 2):
+//
+//      X[k] = SUM_n{ x[n] * exp( -2*pi*i * n*k / N ) }
+//
+// The twiddle factors are computed once, in the constructor.  Transform()
+// works in place: bit-reversal permutation followed by log2(N) passes of
+// butterflies over contiguous arrays.
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+class FFT
+{
+public:
+    typedef std::complex< DOUBLE >  complex_t;
+
+private:
+    int32s      Size;
+    complex_t*  pTwiddle;       // exp( -2*pi*i * k/N ), k = 0 .. N/2-1
+
+public:
+    FFT( int32s size )
+    {
+        const DOUBLE TWO_PI = 6.283185307179586476925;
+
+        Size     = size;
+        pTwiddle = new complex_t[ Size / 2 + 1 ];
+        for( int32s k = 0; k < Size / 2; k++ )
+            pTwiddle[k] = complex_t( cos( TWO_PI * k / Size ), -sin( TWO_PI * k / Size ));
+    }
+
+    virtual ~FFT()      { delete [] pTwiddle; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline int32s GetSize( void ) const     { return Size; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    void Transform( complex_t* data ) const
+    {
+        /* bit-reversal permutation */
+        for( int32s i = 1, j = 0; i < Size; i++ )
+        {
+            int32s bit = Size >> 1;
+            for( ; j & bit; bit >>= 1 )
+                j ^= bit;
+            j ^= bit;
+
+            if( i < j )
+                std::swap( data[i], data[j] );
+        }
+
+        /* butterflies */
+        for( int32s len = 2; len <= Size; len <<= 1 )
+        {
+            int32s half   = len >> 1;
+            int32s stride = Size / len;
+
+            for( int32s base = 0; base < Size; base += len )
+            {
+                complex_t* lo = data + base;
+                complex_t* hi = lo + half;
+
+                for( int32s k = 0; k < half; k++ )
+                {
+                    /* written out: complex operator* checks for NaN and is much slower */
+                    const complex_t& w = pTwiddle[ k * stride ];
+                    DOUBLE re = hi[k].real() * w.real() - hi[k].imag() * w.imag();
+                    DOUBLE im = hi[k].real() * w.imag() + hi[k].imag() * w.real();
+
+                    hi[k] = complex_t( lo[k].real() - re, lo[k].imag() - im );
+                    lo[k] = complex_t( lo[k].real() + re, lo[k].imag() + im );
+                }
+            }
+        }
+    }
+};
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+
+#endif /* _FFT_H_V001_INCLUDED_ */
@@ -0,0 +1,251 @@
+/**********************************************************
+ * Filename:    _heap.h
+ *
+ * Description: This file contains declaration for
+ *              class HeapNode
+ *              class IndexedHeap
+ *              class KeyHeap
+ *
+ *********************************************************/
+
+#ifndef _HEAP_H_V001_INCLUDED_
+#define _HEAP_H_V001_INCLUDED_
+
+#include "_types.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+// class IndexedHeap
+//
+// Array-based binary min-heap of nodes.  Each entry keeps a copy of the node's
+// key, so that sifting compares keys without touching the nodes.  Each node
+// knows its position in the array (HeapIndex), so that any node can be removed
+// in O(log n).
+//
+// Nodes with equal keys are ordered last-in first-out, which is the order in
+// which AVLTree returns nodes with equal keys.  UpdateHead() counts as a new
+// insertion of the head node.
+//
+// The typical use is "take the head, advance its key, UpdateHead()", which
+// costs a single sift-down instead of a removal and an insertion.
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+class HeapNode
+{
+public:
+    int32s  HeapIndex;      // position in the heap, -1 if not in a heap
+    HeapNode()              { HeapIndex = -1; }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////
+template < class T, class K > class IndexedHeap
+/* class T must be derived from HeapNode and have the following public method:
+    K  GetKey( void ) const;
+*/
+{
+protected:
+    struct Entry
+    {
+        K       Key;
+        int64u  Order;      // insertion number, breaks ties between equal keys
+        T*      pNode;
+    };
+
+    Entry*  pHeap;
+    int32s  Count;
+    int32s  Capacity;
+    int64u  Inserted;       // insertion counter
+
+    ///////////////////////////////////////////////////////////////////////////
+    static inline BOOL Precedes( const Entry& a, const Entry& b )
+    {
+        return a.Key < b.Key || ( a.Key == b.Key && a.Order > b.Order );
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void Place( int32s n, const Entry& entry )
+    {
+        pHeap[n] = entry;
+        pHeap[n].pNode->HeapIndex = n;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void SiftUp( int32s n, Entry entry )
+    {
+        while( n > 0 )
+        {
+            int32s parent = ( n - 1 ) >> 1;
+            if( !Precedes( entry, pHeap[ parent ] ))
+                break;
+            Place( n, pHeap[ parent ] );
+            n = parent;
+        }
+        Place( n, entry );
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void SiftDown( int32s n, Entry entry )
+    {
+        for( int32s child = 2 * n + 1; child < Count; child = 2 * n + 1 )
+        {
+            if( child + 1 < Count && Precedes( pHeap[ child + 1 ], pHeap[ child ] ))
+                child++;
+            if( !Precedes( pHeap[ child ], entry ))
+                break;
+            Place( n, pHeap[ child ] );
+            n = child;
+        }
+        Place( n, entry );
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    void Grow( void )
+    {
+        Capacity = Capacity? 2 * Capacity: 16;
+        Entry* heap = new Entry[ Capacity ];
+        for( int32s n = 0; n < Count; n++ )
+            heap[n] = pHeap[n];
+        delete [] pHeap;
+        pHeap = heap;
+    }
+
+public:
+    IndexedHeap()               { pHeap = NULL; Count = Capacity = 0; Inserted = 0; }
+    virtual ~IndexedHeap()      { delete [] pHeap; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline int32s   GetCount( void ) const          { return Count; }
+    inline T*       GetHead( void )  const          { return Count? pHeap[0].pNode: NULL; }
+    inline T*       GetNode( int32s n ) const       { return pHeap[n].pNode; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void AddNode( T* pNode )
+    {
+        if( pNode )
+        {
+            if( Count == Capacity )
+                Grow();
+
+            Entry entry = { pNode->GetKey(), ++Inserted, pNode };
+            SiftUp( Count++, entry );
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline BOOL RemoveNode( T* pNode )
+    {
+        int32s n = pNode? pNode->HeapIndex: -1;
+        if( n < 0 || n >= Count || pHeap[n].pNode != pNode )
+            return FALSE;
+
+        pNode->HeapIndex = -1;
+        if( n < --Count )
+        {
+            Entry last = pHeap[ Count ];
+            if( n > 0 && Precedes( last, pHeap[ ( n - 1 ) >> 1 ] ))
+                SiftUp( n, last );
+            else
+                SiftDown( n, last );
+        }
+        return TRUE;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline T* RemoveHead( void )
+    {
+        T* pNode = GetHead();
+        RemoveNode( pNode );
+        return pNode;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Restores the heap after the key of the head node has increased;
+    // equivalent to RemoveHead() followed by AddNode() of the same node
+    ///////////////////////////////////////////////////////////////////////////
+    inline void UpdateHead( void )
+    {
+        Entry entry = { pHeap[0].pNode->GetKey(), ++Inserted, pHeap[0].pNode };
+        SiftDown( 0, entry );
+    }
+};
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+// class KeyHeap
+//
+// Array-based binary min-heap of plain keys (no nodes attached).  Adding the
+// keys returned by GetKey( 0 .. GetCount()-1 ), in this order, to an empty heap
+// rebuilds the same heap.
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+template < class K > class KeyHeap
+{
+private:
+    K*      pHeap;
+    int32s  Count;
+    int32s  Capacity;
+
+public:
+    KeyHeap()                   { pHeap = NULL; Count = Capacity = 0; }
+    virtual ~KeyHeap()          { delete [] pHeap; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void     Clear( void )                   { Count = 0; }
+    inline int32s   GetCount( void ) const          { return Count; }
+    inline K        GetTop( void )   const          { return pHeap[0]; }
+    inline K        GetKey( int32s n ) const        { return pHeap[n]; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void Push( K key )
+    {
+        if( Count == Capacity )
+        {
+            Capacity = Capacity? 2 * Capacity: 16;
+            K* heap = new K[ Capacity ];
+            for( int32s n = 0; n < Count; n++ )
+                heap[n] = pHeap[n];
+            delete [] pHeap;
+            pHeap = heap;
+        }
+
+        int32s n = Count++;
+        while( n > 0 && key < pHeap[ ( n - 1 ) >> 1 ] )
+        {
+            pHeap[n] = pHeap[ ( n - 1 ) >> 1 ];
+            n = ( n - 1 ) >> 1;
+        }
+        pHeap[n] = key;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline K Pop( void )
+    {
+        K      top  = pHeap[0];
+        K      last = pHeap[ --Count ];
+        int32s n    = 0;
+
+        for( int32s child = 1; child < Count; child = 2 * n + 1 )
+        {
+            if( child + 1 < Count && pHeap[ child + 1 ] < pHeap[ child ] )
+                child++;
+            if( !( pHeap[ child ] < last ))
+                break;
+            pHeap[n] = pHeap[ child ];
+            n = child;
+        }
+        pHeap[n] = last;
+        return top;
+    }
+};
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+
+#endif /* _HEAP_H_V001_INCLUDED_ */
@@ -0,0 +1,343 @@
+/**********************************************************
+ * Filename:    _log.h
+ *
+ * Description: This file contains declaration for class AsyncLog,
+ *              a buffered message log written by a background thread
+ *
+ *********************************************************/
+
+#ifndef _LOG_H_V001_INCLUDED_
+#define _LOG_H_V001_INCLUDED_
+
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <sstream>
+#include <ostream>
+#include "_types.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+// class AsyncLog
+//
+// Messages are formatted by the simulation thread into Text() and then copied
+// by Post() into a lock-free single-producer / single-consumer ring buffer.
+// A background thread writes them to the file and screen streams of the
+// message type and flushes the streams only when the buffer runs empty.
+//
+// Admit() must be called before a message is formatted.  It enforces the rate
+// limit of the message type (maximum number of messages per wall-clock second),
+// so that suppressed messages cost neither formatting nor I/O.  The number of
+// suppressed messages is reported once per second.
+//
+// If the ring buffer is full, messages of rate-limited types are dropped;
+// messages of other types wait for the writer thread.
+//
+// The writer thread must not run while the process forks, since a child would
+// inherit the locks it holds.  Suspend() writes all pending messages and ends
+// the thread; after fork() the parent and the child each call Start().
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+const int32u LOG_BUFFER_SIZE    = 1 << 20;                  // ring buffer size, must be power of 2
+const int32u LOG_MAX_MESSAGE    = LOG_BUFFER_SIZE / 4;      // longer messages are truncated
+const int32s LOG_MAX_TYPES      = 8;
+
+class AsyncLog
+{
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Message header in the ring buffer.  Each record is aligned to
+    // the header size.
+    ///////////////////////////////////////////////////////////////////////////
+    struct Record
+    {
+        int32u  Length;
+        int32u  Type;
+    };
+
+    struct MsgType
+    {
+        std::ostream*   File;
+        std::ostream*   Screen;
+        const char*     Prefix;         // used for the messages of the logger itself
+        int32u          RateLimit;      // messages per second (0 = unlimited)
+
+        int64s          Second;         // current rate-limiting interval
+        int32u          InSecond;       // messages admitted in the current interval
+        int64u          Skipped;        // messages suppressed in the current interval
+
+        int64u          Posted;
+        int64u          Suppressed;
+        int64u          Dropped;
+    };
+
+    MsgType                 Types[ LOG_MAX_TYPES ];
+    std::ostringstream      Format;
+    std::string             Line;               // used by the writer thread
+
+    char                    Buffer[ LOG_BUFFER_SIZE ];
+    std::atomic< int64u >   Head;               // written by the simulation thread
+    std::atomic< int64u >   Tail;               // written by the writer thread
+    std::atomic< int32u >   FlushRequest;
+    std::atomic< int32u >   FlushDone;
+    std::atomic< BOOL >     Stopping;
+    std::thread*            pWriter;
+
+    ///////////////////////////////////////////////////////////////////////////
+    static inline int64s CurrentSecond( void )
+    {
+        return std::chrono::duration_cast< std::chrono::seconds >( std::chrono::steady_clock::now().time_since_epoch() ).count();
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    static inline int32u RecordSize( int32u length )
+    {
+        return sizeof( Record ) + (( length + sizeof( Record ) - 1 ) & ~( sizeof( Record ) - 1 ));
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void CopyIn( int64u pos, const void* src, int32u len )
+    {
+        int32u offset = (int32u)( pos & ( LOG_BUFFER_SIZE - 1 ));
+        int32u first  = MIN< int32u >( len, LOG_BUFFER_SIZE - offset );
+        memcpy( Buffer + offset, src, first );
+        memcpy( Buffer, (const char*)src + first, len - first );
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void CopyOut( int64u pos, void* dst, int32u len ) const
+    {
+        int32u offset = (int32u)( pos & ( LOG_BUFFER_SIZE - 1 ));
+        int32u first  = MIN< int32u >( len, LOG_BUFFER_SIZE - offset );
+        memcpy( dst, Buffer + offset, first );
+        memcpy( (char*)dst + first, Buffer, len - first );
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void Output( int32u type, const char* text, int32u len )
+    {
+        if( Types[ type ].File )    Types[ type ].File  ->write( text, len );
+        if( Types[ type ].Screen )  Types[ type ].Screen->write( text, len );
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void FlushStreams( void )
+    {
+        for( int32s n = 0; n < LOG_MAX_TYPES; n++ )
+        {
+            if( Types[ n ].File )   Types[ n ].File  ->flush();
+            if( Types[ n ].Screen ) Types[ n ].Screen->flush();
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Writer thread: writes all pending messages, then flushes the streams
+    // and sleeps until new messages arrive
+    ///////////////////////////////////////////////////////////////////////////
+    void Run( void )
+    {
+        int64u tail = Tail.load( std::memory_order_relaxed );
+
+        for( ;; )
+        {
+            int32u request = FlushRequest.load( std::memory_order_acquire );
+            BOOL   stop    = Stopping.load( std::memory_order_acquire );
+            int64u head    = Head.load( std::memory_order_acquire );
+
+            if( tail == head )
+            {
+                FlushStreams();
+                FlushDone.store( request, std::memory_order_release );
+                if( stop )
+                    return;
+                std::this_thread::sleep_for( std::chrono::milliseconds( 1 ));
+                continue;
+            }
+
+            while( tail != head )
+            {
+                Record rec;
+                CopyOut( tail, &rec, sizeof( Record ));
+                Line.resize( rec.Length );
+                CopyOut( tail + sizeof( Record ), &Line[0], rec.Length );
+                Output( rec.Type, Line.data(), rec.Length );
+                tail += RecordSize( rec.Length );
+            }
+            Tail.store( tail, std::memory_order_release );
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void Write( int32u type, const char* text, int32u len )
+    {
+        if( len > LOG_MAX_MESSAGE )
+            len = LOG_MAX_MESSAGE;
+
+        MsgType& mt = Types[ type ];
+
+        if( pWriter == NULL )
+        {
+            Output( type, text, len );
+            FlushStreams();
+            mt.Posted++;
+            return;
+        }
+
+        int64u head = Head.load( std::memory_order_relaxed );
+        int32u size = RecordSize( len );
+
+        while( head + size - Tail.load( std::memory_order_acquire ) > LOG_BUFFER_SIZE )
+        {
+            if( mt.RateLimit )
+            {
+                mt.Dropped++;
+                return;
+            }
+            std::this_thread::yield();
+        }
+
+        Record rec = { len, type };
+        CopyIn( head, &rec, sizeof( Record ));
+        CopyIn( head + sizeof( Record ), text, len );
+        Head.store( head + size, std::memory_order_release );
+        mt.Posted++;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void ReportSkipped( int32u type )
+    {
+        MsgType& mt = Types[ type ];
+        if( mt.Skipped )
+        {
+            Format << mt.Prefix << mt.Skipped << " messages suppressed by rate limit\n";
+            Post( type );
+            mt.Skipped = 0;
+        }
+    }
+
+public:
+    AsyncLog() : Head( 0 ), Tail( 0 ), FlushRequest( 0 ), FlushDone( 0 ), Stopping( FALSE ), pWriter( NULL )
+    {
+        memset( Types, 0, sizeof( Types ));
+        Format.precision( 12 );
+    }
+
+    virtual ~AsyncLog()     { Stop(); }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Sets output streams (NULL = no output) and rate limit of a message type
+    ///////////////////////////////////////////////////////////////////////////
+    inline void SetOutput( int32u type, std::ostream* file, std::ostream* screen, const char* prefix, int32u rate_limit )
+    {
+        Types[ type ].File      = file;
+        Types[ type ].Screen    = screen;
+        Types[ type ].Prefix    = prefix;
+        Types[ type ].RateLimit = rate_limit;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void Start( void )
+    {
+        if( pWriter == NULL )
+        {
+            Stopping.store( FALSE );
+            pWriter = new std::thread( &AsyncLog::Run, this );
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void Stop( void )
+    {
+        for( int32s n = 0; n < LOG_MAX_TYPES; n++ )
+            ReportSkipped( n );
+
+        Suspend();
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Writes all posted messages and ends the writer thread (before fork()).
+    // Until Start() is called again, messages are written synchronously.
+    ///////////////////////////////////////////////////////////////////////////
+    inline void Suspend( void )
+    {
+        if( pWriter )
+        {
+            Stopping.store( TRUE, std::memory_order_release );
+            pWriter->join();
+            delete pWriter;
+            pWriter = NULL;
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Waits until all posted messages are written and the streams are flushed
+    ///////////////////////////////////////////////////////////////////////////
+    inline void Flush( void )
+    {
+        if( pWriter == NULL )
+        {
+            FlushStreams();
+            return;
+        }
+
+        int32u request = FlushRequest.fetch_add( 1, std::memory_order_acq_rel ) + 1;
+        while( (int32s)( FlushDone.load( std::memory_order_acquire ) - request ) < 0 )
+            std::this_thread::yield();
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Returns TRUE if a message of given type may be posted now
+    ///////////////////////////////////////////////////////////////////////////
+    inline BOOL Admit( int32u type )
+    {
+        MsgType& mt = Types[ type ];
+
+        if( mt.RateLimit == 0 )
+            return TRUE;
+
+        int64s now = CurrentSecond();
+        if( now != mt.Second )
+        {
+            ReportSkipped( type );
+            mt.Second   = now;
+            mt.InSecond = 0;
+        }
+
+        if( mt.InSecond < mt.RateLimit )
+        {
+            mt.InSecond++;
+            return TRUE;
+        }
+
+        mt.Skipped++;
+        mt.Suppressed++;
+        return FALSE;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline std::ostream& Text( void )   { return Format; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Posts the message formatted in Text()
+    ///////////////////////////////////////////////////////////////////////////
+    inline void Post( int32u type )
+    {
+        const std::string& text = Format.str();
+        Write( type, text.data(), (int32u) text.size() );
+        Format.str( std::string() );
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline int64u GetPosted( int32u type )      const { return Types[ type ].Posted;     }
+    inline int64u GetSuppressed( int32u type )  const { return Types[ type ].Suppressed; }
+    inline int64u GetDropped( int32u type )     const { return Types[ type ].Dropped;    }
+};
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+
+#endif /* _LOG_H_V001_INCLUDED_ */
@@ -0,0 +1,143 @@
+/**********************************************************
+ * Filename:    _mmap.h
+ *
+ * Description: This file contains declaration for class MappedFile,
+ *              a read-only memory-mapped file
+ *
+ *********************************************************/
+
+#ifndef _MMAP_H_V001_INCLUDED_
+#define _MMAP_H_V001_INCLUDED_
+
+#include <stddef.h>
+#include "_types.h"
+
+#if defined( _WIN32 )
+    // windows.h declares its own BOOL (int), which conflicts with _types.h
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #define BOOL WIN32_BOOL
+    #include <windows.h>
+    #undef  BOOL
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+// class MappedFile
+//
+// Maps a whole file read-only into memory.  Pages are read by the OS on first
+// access; Prefetch() asks the OS to start reading a range ahead of time.  On
+// Windows, Prefetch() does nothing and the OS relies on its own read-ahead.
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+class MappedFile
+{
+private:
+    const char* pData;
+    size_t      Size;
+
+#if defined( _WIN32 )
+    HANDLE      hFile;
+    HANDLE      hMapping;
+#endif
+
+public:
+    MappedFile()
+    {
+        pData = NULL;
+        Size  = 0;
+#if defined( _WIN32 )
+        hFile = hMapping = NULL;
+#endif
+    }
+
+    virtual ~MappedFile()       { Close(); }
+
+    ///////////////////////////////////////////////////////////////////////////
+    BOOL Open( const char* file_name )
+    {
+        Close();
+
+#if defined( _WIN32 )
+        LARGE_INTEGER size;
+        hFile = CreateFileA( file_name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+        if( hFile == INVALID_HANDLE_VALUE || !GetFileSizeEx( hFile, &size ) || size.QuadPart == 0 )
+        {
+            Close();
+            return FALSE;
+        }
+
+        hMapping = CreateFileMappingA( hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+        pData    = hMapping? (const char*) MapViewOfFile( hMapping, FILE_MAP_READ, 0, 0, 0 ): NULL;
+        Size     = (size_t) size.QuadPart;
+#else
+        struct stat st;
+        int fd = open( file_name, O_RDONLY );
+        if( fd < 0 )
+            return FALSE;
+
+        if( fstat( fd, &st ) == 0 && st.st_size > 0 )
+        {
+            void* ptr = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+            if( ptr != MAP_FAILED )
+            {
+                pData = (const char*) ptr;
+                Size  = st.st_size;
+                madvise( ptr, Size, MADV_SEQUENTIAL );
+            }
+        }
+        close( fd );    // the mapping stays valid
+#endif
+
+        if( pData == NULL )
+            Close();
+        return pData != NULL;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    void Close( void )
+    {
+#if defined( _WIN32 )
+        if( pData )                                     UnmapViewOfFile( pData );
+        if( hMapping )                                  CloseHandle( hMapping );
+        if( hFile && hFile != INVALID_HANDLE_VALUE )    CloseHandle( hFile );
+        hFile = hMapping = NULL;
+#else
+        if( pData )                                     munmap( (void*) pData, Size );
+#endif
+        pData = NULL;
+        Size  = 0;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Asks the OS to read given range of the file in the background
+    ///////////////////////////////////////////////////////////////////////////
+    inline void Prefetch( const void* ptr, size_t size ) const
+    {
+#if !defined( _WIN32 )
+        static const size_t page_mask = (size_t) sysconf( _SC_PAGESIZE ) - 1;
+
+        const char* begin = (const char*)((size_t) ptr & ~page_mask );
+        const char* end   = MIN< const char* >( (const char*) ptr + size, pData + Size );
+        if( begin < end )
+            madvise( (void*) begin, end - begin, MADV_WILLNEED );
+#endif
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline BOOL         IsOpen( void )  const { return pData != NULL; }
+    inline const char*  GetData( void ) const { return pData; }
+    inline size_t       GetSize( void ) const { return Size;  }
+};
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+
+#endif /* _MMAP_H_V001_INCLUDED_ */
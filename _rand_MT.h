@@ -58,6 +58,22 @@ inline rnd_int_t  _uniform_int_ (rnd_int_t low,  rnd_int_t hi)  { return RND.ran
 inline rnd_real_t _exponent_(void)                       { return -log( _uniform_real_X0_1() );            }
 inline rnd_real_t _pareto_(rnd_real_t shape)             { return  pow( _uniform_real_X0_1(), -1.0/shape); }
 
+/* two independent standard normal values (Marsaglia polar method) */
+inline void _normal_pair_( rnd_real_t& z1, rnd_real_t& z2 )
+{
+    rnd_real_t u, v, s;
+    do
+    {
+        u = 2.0 * _uniform_real_0_X1() - 1.0;
+        v = 2.0 * _uniform_real_0_X1() - 1.0;
+        s = u * u + v * v;
+    } while( s >= 1.0 || s == 0.0 );
+
+    s  = sqrt( -2.0 * log( s ) / s );
+    z1 = u * s;
+    z2 = v * s;
+}
+
 
 
 
@@ -74,12 +90,32 @@ inline rnd_real_t _pareto_(rnd_real_t shape)             { return  pow( _uniform
 //               N - number of elements in the distribution.
 //
 //               PF_FREQUENCY - a pointer to callback function that returns 
-//                   probability or frequency of an element with index i
+//                   probability or frequency of an element with index i.
+//                   The function must be constexpr: the cummulative 
+//                   distribution is computed at compile time.
 /////////////////////////////////////////////////////////////////////
 template< class T, int32s N, T (*PF_FREQUENCY)(int32s) > class GenericDistribByIndex
 {
 private:
-    static T cdf[ N ];  // cummulative distribution
+    /////////////////////////////////////////////////////////////////
+    // Cummulative distribution, built by the constexpr constructor
+    /////////////////////////////////////////////////////////////////
+    struct CDF
+    {
+        T Value[ N ];
+
+        constexpr CDF() : Value()
+        {
+            Value[0] = PF_FREQUENCY( 0 );
+
+            for( int32s ndx = 1; ndx < N; ndx ++ )
+                Value[ndx] = Value[ndx-1] + PF_FREQUENCY( ndx );
+        }
+
+        constexpr const T& operator[] ( int32s ndx ) const  { return Value[ ndx ]; }
+    };
+
+    static constexpr CDF cdf = CDF();   // read-only, no run-time construction
 
 public:
 
@@ -87,15 +123,9 @@ public:
     // FUNCTION:    GenericDistribByIndex()
     // DESCRIPTION: constructor
     // ARGUMENTS:   
-    // NOTES:       
+    // NOTES:       the distribution is a compile-time constant 
     /////////////////////////////////////////////////////////////////
-    GenericDistribByIndex()
-    {
-        cdf[0] = PF_FREQUENCY( 0 );
-
-        for( int32s ndx = 1; ndx < N; ndx ++ )
-            cdf[ndx] = cdf[ndx-1] + PF_FREQUENCY( ndx );
-    }
+    GenericDistribByIndex() {}
 
     /////////////////////////////////////////////////////////////////
     // FUNCTION:    int32s GetIndex( void )
@@ -124,13 +154,6 @@ public:
     }
 };
 
-/////////////////////////////////////////////////////////////////////
-// Declaration for static array VAL_T cdf[ N ]
-/////////////////////////////////////////////////////////////////////
-template< class T, int32s N, T (*PF_FREQUENCY)(int32s) > 
-T GenericDistribByIndex< T, N, PF_FREQUENCY >::cdf[N] = {0};
-
-
 
 /////////////////////////////////////////////////////////////////////
 // CLASS:        class GenericDistribution
@@ -170,7 +193,7 @@ public:
     // DESCRIPTION: returns next random value
     // NOTES:       
     /////////////////////////////////////////////////////////////////
-    static inline E GetElement( void ) { return Elements[ GenericDistribByIndex<T, N, PF_FREQUENCY>.GetIndex() ]; }
+    inline E GetElement( void ) const { return Elements[ GenericDistribByIndex<T, N, PF_FREQUENCY>::GetIndex() ]; }
 };
 
 
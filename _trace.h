@@ -0,0 +1,302 @@
+/**********************************************************
+ * Filename:    _trace.h
+ *
+ * Description: This file contains declaration for class TraceWriter
+ *              used to write packet- and cycle-level traces in a
+ *              columnar binary format
+ *
+ *********************************************************/
+
+#ifndef _TRACE_H_V001_INCLUDED_
+#define _TRACE_H_V001_INCLUDED_
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "_types.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+// class TraceWriter
+//
+// Each trace record consists of fixed-width fields:
+//
+//      Time    int64s  time of the event (ns)
+//      Delay   int64s  packet delay, or other time interval (ns)
+//      Size    int32s  packet size, or grant length (bytes)
+//      LLID    int16u  logical link
+//      Type    int8u   event type
+//
+// Records are collected in chunks of up to TRACE_CHUNK_RECORDS records.  In the
+// file, each chunk stores its fields column by column, so that a reader can
+// load a single column without touching the others.
+//
+// File layout (all values in native byte order):
+//
+//      file header:    int32u  TRACE_MAGIC
+//                      int32u  TRACE_VERSION
+//                      int32u  number of columns
+//                      int32u  maximum number of records per chunk
+//                      column descriptors, each:
+//                          char    name[16]
+//                          int32u  width (bytes)
+//                          int32u  kind (TRACE_SIGNED, TRACE_UNSIGNED)
+//      chunk:          int32u  TRACE_CHUNK_MAGIC
+//                      int32u  number of records N
+//                      column 0: N values, column 1: N values, ...
+//
+// A full chunk is handed to a writer thread, which runs while the trace is open
+// and writes the chunk in a single write, while the simulation fills the other
+// chunk buffer.
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+const int32u TRACE_MAGIC            = 0x45435254;   // "TRCE"
+const int32u TRACE_CHUNK_MAGIC      = 0x4B4E4843;   // "CHNK"
+const int32u TRACE_VERSION          = 1;
+const int32u TRACE_CHUNK_RECORDS    = 1 << 16;
+
+const int32u TRACE_SIGNED           = 0;
+const int32u TRACE_UNSIGNED         = 1;
+
+class TraceWriter
+{
+private:
+    struct Column
+    {
+        char    Name[16];
+        int32u  Width;
+        int32u  Kind;
+    };
+
+    enum { COL_TIME, COL_DELAY, COL_SIZE, COL_LLID, COL_TYPE, COLUMNS };
+
+    static const Column* Columns( void )
+    {
+        static const Column columns[ COLUMNS ] =
+        {
+            { "Time",   sizeof( int64s ), TRACE_SIGNED   },
+            { "Delay",  sizeof( int64s ), TRACE_SIGNED   },
+            { "Size",   sizeof( int32s ), TRACE_SIGNED   },
+            { "LLID",   sizeof( int16u ), TRACE_UNSIGNED },
+            { "Type",   sizeof( int8u  ), TRACE_UNSIGNED },
+        };
+        return columns;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Chunk buffer: chunk header followed by the columns, each sized
+    // for TRACE_CHUNK_RECORDS values
+    ///////////////////////////////////////////////////////////////////////////
+    struct Chunk
+    {
+        char*   Data;
+        int32u  Count;
+
+        inline int64s* Time( void )  { return (int64s*)( Data + 2 * sizeof( int32u )); }
+        inline int64s* Delay( void ) { return Time()  + TRACE_CHUNK_RECORDS; }
+        inline int32s* Size( void )  { return (int32s*)( Delay() + TRACE_CHUNK_RECORDS ); }
+        inline int16u* LLID( void )  { return (int16u*)( Size()  + TRACE_CHUNK_RECORDS ); }
+        inline int8u*  Type( void )  { return (int8u*) ( LLID()  + TRACE_CHUNK_RECORDS ); }
+    };
+
+    static const size_t CHUNK_BYTES = 2 * sizeof( int32u ) + TRACE_CHUNK_RECORDS *
+                                      ( 2 * sizeof( int64s ) + sizeof( int32s ) + sizeof( int16u ) + sizeof( int8u ));
+
+    FILE*                   pFile;
+    Chunk                   Buffers[2];
+    Chunk*                  pActive;
+    Chunk*                  pFull;          // chunk handed to the writer thread
+    BOOL                    Stopping;
+    std::mutex              Lock;           // guards pFull and Stopping
+    std::condition_variable Signal;
+    std::thread*            pWriter;
+    std::atomic< BOOL >     Failed;         // also set by the writer thread
+    int64u                  Records;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Packs the columns of a partially filled chunk and writes it
+    ///////////////////////////////////////////////////////////////////////////
+    void WriteChunk( Chunk* chunk )
+    {
+        int32u count = chunk->Count;
+        char*  dst   = chunk->Data + 2 * sizeof( int32u );
+        char*  src   = dst;
+
+        ((int32u*) chunk->Data )[0] = TRACE_CHUNK_MAGIC;
+        ((int32u*) chunk->Data )[1] = count;
+
+        if( count < TRACE_CHUNK_RECORDS )
+        {
+            for( int32s col = 0; col < COLUMNS; col++ )
+            {
+                memmove( dst, src, count * Columns()[ col ].Width );
+                dst += count * Columns()[ col ].Width;
+                src += TRACE_CHUNK_RECORDS * Columns()[ col ].Width;
+            }
+        }
+        else
+            dst = chunk->Data + CHUNK_BYTES;
+
+        size_t size = dst - chunk->Data;
+        if( fwrite( chunk->Data, 1, size, pFile ) != size )
+            Failed = TRUE;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Writer thread: writes each chunk handed over by SwitchChunk() and
+    // returns the buffer by clearing pFull
+    ///////////////////////////////////////////////////////////////////////////
+    void Run( void )
+    {
+        std::unique_lock< std::mutex > lock( Lock );
+
+        for( ;; )
+        {
+            Signal.wait( lock, [this]{ return pFull != NULL || Stopping; } );
+            if( pFull == NULL )
+                return;
+
+            lock.unlock();
+            WriteChunk( pFull );
+            lock.lock();
+
+            pFull = NULL;
+            Signal.notify_all();
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Waits until the writer thread has written the previous chunk
+    ///////////////////////////////////////////////////////////////////////////
+    inline void WaitWriter( std::unique_lock< std::mutex >& lock )
+    {
+        Signal.wait( lock, [this]{ return pFull == NULL; } );
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Hands the active chunk to the writer thread and switches buffers
+    ///////////////////////////////////////////////////////////////////////////
+    void SwitchChunk( void )
+    {
+        {
+            std::unique_lock< std::mutex > lock( Lock );
+            WaitWriter( lock );
+            pFull = pActive;
+        }
+        Signal.notify_all();
+
+        pActive = ( pActive == &Buffers[0] )? &Buffers[1]: &Buffers[0];
+        pActive->Count = 0;
+    }
+
+public:
+    TraceWriter()
+    {
+        pFile    = NULL;
+        pWriter  = NULL;
+        pFull    = NULL;
+        Stopping = FALSE;
+        pActive  = &Buffers[0];
+        Failed   = FALSE;
+        Records  = 0;
+        Buffers[0].Data  = Buffers[1].Data  = NULL;
+        Buffers[0].Count = Buffers[1].Count = 0;
+    }
+
+    virtual ~TraceWriter()      { Close(); }
+
+    ///////////////////////////////////////////////////////////////////////////
+    BOOL Open( const char* file_name )
+    {
+        Close();
+
+#if defined( _MSC_VER )
+        if( fopen_s( &pFile, file_name, "wb" ) != 0 )
+            pFile = NULL;
+#else
+        pFile = fopen( file_name, "wb" );
+#endif
+        if( pFile == NULL )
+            return FALSE;
+
+        // chunks are written in a single call, stdio buffering would only add a copy
+        setvbuf( pFile, NULL, _IONBF, 0 );
+
+        Buffers[0].Data  = new char[ CHUNK_BYTES ];
+        Buffers[1].Data  = new char[ CHUNK_BYTES ];
+        pActive          = &Buffers[0];
+        pActive->Count   = 0;
+        Failed           = FALSE;
+        Records          = 0;
+
+        int32u header[4] = { TRACE_MAGIC, TRACE_VERSION, COLUMNS, TRACE_CHUNK_RECORDS };
+        if( fwrite( header, sizeof( header ), 1, pFile ) != 1 ||
+            fwrite( Columns(), sizeof( Column ), COLUMNS, pFile ) != COLUMNS )
+            Failed = TRUE;
+
+        pFull    = NULL;
+        Stopping = FALSE;
+        pWriter  = new std::thread( &TraceWriter::Run, this );
+        return !Failed;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    BOOL Close( void )
+    {
+        if( pFile == NULL )
+            return !Failed;
+
+        {
+            std::unique_lock< std::mutex > lock( Lock );
+            WaitWriter( lock );
+            Stopping = TRUE;
+        }
+        Signal.notify_all();
+        pWriter->join();
+        delete pWriter;
+        pWriter = NULL;
+
+        if( pActive->Count > 0 )
+            WriteChunk( pActive );
+
+        if( fclose( pFile ) != 0 )
+            Failed = TRUE;
+
+        delete [] Buffers[0].Data;
+        delete [] Buffers[1].Data;
+        Buffers[0].Data = Buffers[1].Data = NULL;
+        pFile = NULL;
+        return !Failed;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline BOOL   IsOpen( void )        const { return pFile != NULL; }
+    inline BOOL   IsGood( void )        const { return !Failed; }
+    inline int64u GetRecords( void )    const { return Records; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void Record( int64s time, int64s delay, int32s size, int16u llid, int8u type )
+    {
+        int32u n = pActive->Count++;
+
+        pActive->Time()[n]  = time;
+        pActive->Delay()[n] = delay;
+        pActive->Size()[n]  = size;
+        pActive->LLID()[n]  = llid;
+        pActive->Type()[n]  = type;
+        Records++;
+
+        if( pActive->Count == TRACE_CHUNK_RECORDS )
+            SwitchChunk();
+    }
+};
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+
+#endif /* _TRACE_H_V001_INCLUDED_ */
@@ -34,6 +34,12 @@
 #ifndef _TYPES_H_V001_INCLUDED_
 #define _TYPES_H_V001_INCLUDED_
 
+#include "_compat.h"
+
+#if !defined( _MSC_VER )
+    #include <stdint.h>
+#endif
+
 #ifndef NULL
 //#define NULL ((void*) 0L)
 #define NULL 0
@@ -57,7 +63,7 @@
     typedef unsigned __int64    int64u;
     typedef signed   __int64    int64s;
 
-#else  
+#elif defined( _MSC_VER )
 
 /* use generic types */
 
@@ -76,6 +82,22 @@
 	typedef unsigned __int64    int64u;
     typedef signed   __int64    int64s;
 
+#else
+
+/* use exact-width types of other compilers (long is 64 bits on LP64 platforms) */
+
+    typedef uint8_t             int8u;
+    typedef int8_t              int8s;
+
+    typedef uint16_t            int16u;
+    typedef int16_t             int16s;
+
+    typedef uint32_t            int32u;
+    typedef int32_t             int32s;
+
+    typedef uint64_t            int64u;
+    typedef int64_t             int64s;
+
 #endif
 
 typedef int8s               BOOL;
@@ -88,7 +110,7 @@ typedef double              DOUBLE;
 
 
 
-template < class T > inline T round( DOUBLE val )    { return (T)( val + 0.5 ); }
+template < class T > constexpr T round( DOUBLE val ) { return (T)( val + 0.5 ); }
 template < class T > inline T MAX( T x, T y )        { return x > y? x : y;     }
 template < class T > inline T MIN( T x, T y )        { return x < y? x : y;     }
 
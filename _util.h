@@ -11,8 +11,14 @@
 #ifndef _UTIL_H_V001_INCLUDED_
 #define _UTIL_H_V001_INCLUDED_
 
+#include <stdio.h>
 #include <stdlib.h>
-#include <new.h>
+
+#if defined( _MSC_VER )
+    #include <new.h>
+#else
+    #include <new>
+#endif
 
 ///////////////////////////////////////////////////////////
 // METHOD:       insufficient_memory_handle( size_t )
@@ -20,6 +26,8 @@
 // ARGUMENTS:
 // RETURN VALUE:
 ///////////////////////////////////////////////////////////
+#if defined( _MSC_VER )
+
 int insufficient_memory_handle( size_t )
 {
    perror("Memory allocation failed. Terminating application...");
@@ -28,6 +36,18 @@ int insufficient_memory_handle( size_t )
 
 inline void InitAllocator(void) { _set_new_handler( insufficient_memory_handle ); }
 
+#else
+
+inline void insufficient_memory_handle( void )
+{
+   perror("Memory allocation failed. Terminating application...");
+   exit( 100 );
+}
+
+inline void InitAllocator(void) { std::set_new_handler( insufficient_memory_handle ); }
+
+#endif
+
 
 
 #endif // _UTIL_H_V001_INCLUDED_
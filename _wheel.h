@@ -0,0 +1,245 @@
+/**********************************************************
+ * Filename:    _wheel.h
+ *
+ * Description: This file contains declaration for
+ *              class TimingWheel
+ *
+ *********************************************************/
+
+#ifndef _WHEEL_H_V001_INCLUDED_
+#define _WHEEL_H_V001_INCLUDED_
+
+#include <string.h>
+#include "_types.h"
+
+#if defined( _MSC_VER )
+    #include <intrin.h>
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+// class TimingWheel
+//
+// Hierarchical timing wheel: LEVELS levels of 2^BITS slots each.  An element
+// with time t is stored at the lowest level L at which t and the cursor agree
+// in all digits (BITS bits each) above digit L, in the slot given by digit L
+// of t.  Level 0 slots hold elements with exactly the same time.  When level 0
+// becomes empty, the cursor moves to the next non-empty slot of a higher level
+// and the slot is cascaded into the lower levels.
+//
+// Elements later than the horizon (t and the cursor differ in a digit above
+// LEVELS) are not accepted by Insert().  All elements must be at or after
+// the cursor.  Elements with equal time are removed in reverse order of
+// insertion (last in, first out).
+//
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+template < class T, class KEY, int32s BITS = 8, int32s LEVELS = 3 > class TimingWheel
+/* class T must have the following public methods:
+	T*	  GetNext( void );
+    void  SetNext( T*   );
+    KEY   GetTime( void );
+*/
+{
+    static_assert( BITS >= 6 && LEVELS >= 1 && BITS * LEVELS < 63, "invalid timing wheel size" );
+
+    enum { SLOTS = 1 << BITS, MASK = SLOTS - 1, WORDS = SLOTS / 64 };
+
+private:
+    T*      Slot[ LEVELS ][ SLOTS ];        // lists of elements, last inserted first
+    int64u  Bitmap[ LEVELS ][ WORDS ];      // non-empty slots
+    KEY     Cursor;
+    int32u  Count;
+
+    ///////////////////////////////////////////////////////////////////////////
+    static inline int32s LowestBit( int64u bits )
+    {
+#if defined( _MSC_VER )
+        unsigned long ndx;
+        _BitScanForward64( &ndx, bits );
+        return (int32s) ndx;
+#else
+        return __builtin_ctzll( bits );
+#endif
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    static inline int32s Digit( KEY time, int32s level )
+    {
+        return (int32s)( time >> ( BITS * level )) & MASK;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Returns the first non-empty slot at or after 'from', or -1
+    ///////////////////////////////////////////////////////////////////////////
+    inline int32s FindSlot( int32s level, int32s from ) const
+    {
+        if( from >= SLOTS )
+            return -1;
+
+        int32s w    = from >> 6;
+        int64u bits = Bitmap[ level ][ w ] & ( ~(int64u) 0 << ( from & 63 ));
+
+        while( bits == 0 )
+        {
+            if( ++w == WORDS )
+                return -1;
+            bits = Bitmap[ level ][ w ];
+        }
+        return ( w << 6 ) + LowestBit( bits );
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void Push( T* ptr, int32s level, int32s slot )
+    {
+        ptr->SetNext( Slot[ level ][ slot ] );
+        Slot[ level ][ slot ] = ptr;
+        Bitmap[ level ][ slot >> 6 ] |= (int64u) 1 << ( slot & 63 );
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline T* Pop( int32s level, int32s slot )
+    {
+        T* ptr = Slot[ level ][ slot ];
+        if( ( Slot[ level ][ slot ] = ptr->GetNext()) == NULL )
+            Bitmap[ level ][ slot >> 6 ] &= ~( (int64u) 1 << ( slot & 63 ));
+        return ptr;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Moves all elements of a slot to the lower levels.  The list is reversed
+    // first, so that elements with equal time keep their order.
+    ///////////////////////////////////////////////////////////////////////////
+    void Cascade( int32s level, int32s slot )
+    {
+        T* list = NULL;
+        while( Slot[ level ][ slot ] )
+        {
+            T* ptr = Pop( level, slot );
+            ptr->SetNext( list );
+            list = ptr;
+        }
+
+        while( list )
+        {
+            T* ptr = list;
+            list = ptr->GetNext();
+            Place( ptr );
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void Place( T* ptr )
+    {
+        KEY    diff  = ptr->GetTime() ^ Cursor;
+        int32s level = 0;
+
+        while( diff >> ( BITS * ( level + 1 )))
+            level++;
+
+        Push( ptr, level, Digit( ptr->GetTime(), level ));
+    }
+
+public:
+    TimingWheel()                           { Clear( 0 ); }
+    virtual ~TimingWheel()                  {}
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Forgets all elements and sets the cursor
+    ///////////////////////////////////////////////////////////////////////////
+    inline void Clear( KEY cursor )
+    {
+        memset( Slot,   0, sizeof( Slot ));
+        memset( Bitmap, 0, sizeof( Bitmap ));
+        Cursor = cursor;
+        Count  = 0;
+    }
+
+    inline int32u   GetCount( void )  const { return Count;  }
+    inline KEY      GetCursor( void ) const { return Cursor; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Inserts the element if its time is within the horizon of the wheel
+    ///////////////////////////////////////////////////////////////////////////
+    inline BOOL Insert( T* ptr )
+    {
+        _ASSERT( ptr->GetTime() >= Cursor );
+
+        if( ( ptr->GetTime() ^ Cursor ) >> ( BITS * LEVELS ))
+            return FALSE;
+
+        Place( ptr );
+        Count++;
+        return TRUE;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Returns the earliest element if its time is not after 'limit', or NULL.
+    // The cursor is advanced (and slots are cascaded) up to 'limit' at most.
+    ///////////////////////////////////////////////////////////////////////////
+    inline T* GetHead( KEY limit )
+    {
+        while( Count )
+        {
+            int32s slot = FindSlot( 0, Digit( Cursor, 0 ));
+            if( slot >= 0 )
+                return Slot[0][ slot ]->GetTime() <= limit? Slot[0][ slot ]: NULL;
+
+            int32s level;
+            for( level = 1; level < LEVELS; level++ )
+                if( ( slot = FindSlot( level, Digit( Cursor, level ) + 1 )) >= 0 )
+                    break;
+
+            _ASSERT( level < LEVELS );
+
+            KEY start = ( Cursor >> ( BITS * ( level + 1 )) << ( BITS * ( level + 1 )))
+                      | ( (KEY) slot << ( BITS * level ));
+            if( start > limit )
+                return NULL;
+
+            Cursor = start;
+            Cascade( level, slot );
+        }
+        return NULL;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Removes the element returned by GetHead()
+    ///////////////////////////////////////////////////////////////////////////
+    inline T* RemoveHead( T* head )
+    {
+        Count--;
+        return Pop( 0, Digit( head->GetTime(), 0 ));
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Removes any element (in no particular order), or returns NULL
+    ///////////////////////////////////////////////////////////////////////////
+    inline T* RemoveAny( void )
+    {
+        for( int32s level = 0; level < LEVELS && Count; level++ )
+        {
+            int32s slot = FindSlot( level, 0 );
+            if( slot >= 0 )
+            {
+                Count--;
+                return Pop( level, slot );
+            }
+        }
+        return NULL;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Access to the lists of elements (for enumeration)
+    ///////////////////////////////////////////////////////////////////////////
+    inline T* GetSlot( int32s level, int32s slot ) const    { return Slot[ level ][ slot ]; }
+    inline int32s GetLevels( void ) const                   { return LEVELS; }
+    inline int32s GetSlots( void ) const                    { return SLOTS;  }
+};
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
+
+#endif /* _WHEEL_H_V001_INCLUDED_ */
@@ -5,21 +5,29 @@
  *              following classes:
  *              class AVLNode
  *              class AVLTree
- * 
+ *
  * Author:      Glen Kramer (kramer@cs.ucdavis.edu)
  *              University of California @ Davis
  *
- * AVL tree structure is discovered by Adelson-Velsky and Landis   
- *      G.M. Adelson-Velskii and E.M. Landis. 
- *      An algorithm for the organization of information. 
+ * AVL tree structure is discovered by Adelson-Velsky and Landis
+ *      G.M. Adelson-Velskii and E.M. Landis.
+ *      An algorithm for the organization of information.
  *      Soviet Math. Dokl., 3:1259--1262, 1962
  *
  * Date:        June 2001
+ *
+ * Insertion and removal are iterative: every node has a link
+ * to its parent, and the balance is repaired from the changed
+ * node upwards only as long as the height of the subtree
+ * changes.  The tree keeps a pointer to its leftmost node,
+ * so GetHead() is O(1) and RemoveHead() does not walk down
+ * the left spine.
  *********************************************************/
 
 #ifndef _AVL_AVLTREE_H_V001_INCLUDED_
 #define _AVL_AVLTREE_H_V001_INCLUDED_
 
+#include <stdint.h>
 #include "_types.h"
 
 namespace AVL_tree_namespace {
@@ -27,19 +35,20 @@ namespace AVL_tree_namespace {
 template < class avlkey_t > class AVLNode;
 template < class avlkey_t > class AVLTree;
 
-#pragma inline_depth( 128 )
-#pragma inline_recursion( on )
-
 
 
 /*******************************************************************
 ** CLASS:        class AVLNode
 ** PURPOSE:      Represents a node in an AVL tree
+** NOTES:        The parent link and the balance share one word:
+**               nodes are at least 4-byte aligned, so the two low
+**               bits of the parent's address hold the balance + 1.
+**               The node takes no more space than with separate
+**               balance and height fields.
 ********************************************************************/
 template < class avlkey_t > class AVLNode
 {
     typedef AVLNode< avlkey_t >*  pnode_t;
-    typedef int16s                height_t;
 
     friend class AVLTree< avlkey_t >;
 
@@ -47,240 +56,356 @@ template < class avlkey_t > class AVLNode
 private:
 /*******************************************************************/
 
-    int8s       Balance;    /* Node balance: height of right subtree 
-                               minus height of left subtree */
+    enum { BALANCE_MASK = 3 };
 
-    height_t    Height;     /* maximum distance to any leave */
+    /***************************************************************/
+    inline pnode_t GetParent( void ) const  { return (pnode_t)( Parent & ~(uintptr_t) BALANCE_MASK ); }
+    inline int8s   GetBalance( void ) const { return (int8s)( Parent & BALANCE_MASK ) - 1; }
 
-    /***************************************************************/ 
-    inline height_t GetHeight( void )    { return Height; }
+    inline void SetParent( pnode_t p )      { Parent = (uintptr_t) p | ( Parent & BALANCE_MASK ); }
+    inline void SetBalance( int8s bal )     { Parent = ( Parent & ~(uintptr_t) BALANCE_MASK ) | (uintptr_t)( bal + 1 ); }
     /***************************************************************/
-    inline pnode_t Initialize(void)
+    inline pnode_t Initialize( pnode_t parent )
     {
         LChild  = NULL;
-        RChild  = NULL; 
-        Balance = 0;
-        Height  = 0;
+        RChild  = NULL;
+        Parent  = (uintptr_t) parent | 1;   /* balance 0 */
         return this;
     }
 
-    /***************************************************************
-    ** METHOD:       void UpdateHeight( void )
-    ** PURPOSE:      Recalcilates height and balance of given node
-    ** RETURN VALUE: 
-    ****************************************************************/
-    inline void UpdateHeight( void )
-    {
-        height_t LHeight = LChild? LChild->Height : (height_t) -1;
-        height_t RHeight = RChild? RChild->Height : (height_t) -1;
+/*******************************************************************/
+protected:
+/*******************************************************************/
 
-        Height  = MAX<height_t>( LHeight, RHeight ) + 1;
-        Balance = (int8s)(RHeight - LHeight);
-    }
+    uintptr_t   Parent;     /* parent node | ( balance + 1 ), balance is
+                               height of right subtree minus height of
+                               left subtree; free for use by a derived
+                               class while the node is not in a tree */
+    pnode_t     LChild;     /* Left  child */
+    pnode_t     RChild;     /* Right child */
+    avlkey_t    NodeKey;    /*             */
+
+/*******************************************************************/
+public:
+/*******************************************************************/
+    AVLNode( avlkey_t key_val )     { Initialize( NULL ); NodeKey = key_val; }
+    /* virtual */ ~AVLNode()        {}
+
+};
+
+
+
+
+
+/*******************************************************************
+** CLASS:        class AVLTree
+** PURPOSE:
+********************************************************************/
+template < class avlkey_t > class AVLTree
+{
+    typedef AVLNode< avlkey_t >* pnode_t;
+
+/*******************************************************************/
+private:
+/*******************************************************************/
 
     /***************************************************************
-    ** METHOD:       pnode_t PromoteRight( void ) 
-    ** PURPOSE:      Makes right child the parent (ratation left)
-    ** RETURN VALUE: new root of the subtree
+    ** METHOD:       void Replace( pnode_t pOld, pnode_t pNew,
+    **                             pnode_t pParent )
+    ** PURPOSE:      Links pNew to pParent in place of pOld (pParent
+    **               is NULL if pOld is the root)
+    ** RETURN VALUE:
     ****************************************************************/
-    inline pnode_t PromoteRight( void ) 
+    inline void Replace( pnode_t pOld, pnode_t pNew, pnode_t pParent )
     {
-        pnode_t  pNode = RChild;
-        RChild = pNode->LChild;
-        pNode->LChild  = this;
-
-        this ->UpdateHeight();
-        pNode->UpdateHeight();
+        if( pNew )  pNew->SetParent( pParent );
 
-        return pNode;
+        if( !pParent )                      pRoot = pNew;
+        else if( pParent->LChild == pOld )  pParent->LChild = pNew;
+        else                                pParent->RChild = pNew;
     }
 
     /***************************************************************
-    ** METHOD:       pnode_t PromoteLeft( void ) 
-    ** PURPOSE:      Makes left child the parent (ratation right)
+    ** METHOD:       pnode_t PromoteRight( pnode_t pNode )
+    ** PURPOSE:      Makes right child the parent (rotation left).
+    **               Single rotation of a node with balance +2.
     ** RETURN VALUE: new root of the subtree
     ****************************************************************/
-    inline pnode_t PromoteLeft( void ) 
+    inline pnode_t PromoteRight( pnode_t pNode )
     {
-        pnode_t pNode  = LChild;
-        LChild = pNode->RChild;
-        pNode->RChild  = this;
+        pnode_t pRight = pNode->RChild;
+        pnode_t pInner = pRight->LChild;
 
-        this ->UpdateHeight();
-        pNode->UpdateHeight();
+        Replace( pNode, pRight, pNode->GetParent() );
 
-        return pNode;
+        pNode->RChild = pInner;
+        if( pInner ) pInner->SetParent( pNode );
+        pRight->LChild = pNode;
+        pNode->SetParent( pRight );
+
+        if( pRight->GetBalance() == 0 )   /* only after removal */
+        {
+            pNode ->SetBalance(  1 );
+            pRight->SetBalance( -1 );
+        }
+        else
+        {
+            pNode ->SetBalance( 0 );
+            pRight->SetBalance( 0 );
+        }
+        return pRight;
     }
 
     /***************************************************************
-    ** METHOD:       pnode_t RepairBalance( void )
-    ** PURPOSE:      Updates node's height and performs balancing, 
-    **               if necessary
+    ** METHOD:       pnode_t PromoteLeft( pnode_t pNode )
+    ** PURPOSE:      Makes left child the parent (rotation right).
+    **               Single rotation of a node with balance -2.
     ** RETURN VALUE: new root of the subtree
     ****************************************************************/
-    inline pnode_t RepairBalance( void )
+    inline pnode_t PromoteLeft( pnode_t pNode )
     {
-        UpdateHeight();
+        pnode_t pLeft  = pNode->LChild;
+        pnode_t pInner = pLeft->RChild;
+
+        Replace( pNode, pLeft, pNode->GetParent() );
 
-        if( Balance < -1 )
+        pNode->LChild = pInner;
+        if( pInner ) pInner->SetParent( pNode );
+        pLeft->RChild = pNode;
+        pNode->SetParent( pLeft );
+
+        if( pLeft->GetBalance() == 0 )    /* only after removal */
         {
-            /* if imbalance is due to internal branch, do double promotion */
-            if( LChild->Balance > 0 )   LChild = LChild->PromoteRight();
-            return PromoteLeft();
+            pNode->SetBalance( -1 );
+            pLeft->SetBalance(  1 );
         }
-
-        if( Balance > 1 )       
+        else
         {
-            /* if imbalance is due to internal branch, do double promotion */
-            if( RChild->Balance < 0 )   RChild = RChild->PromoteLeft();
-            return PromoteRight();
+            pNode->SetBalance( 0 );
+            pLeft->SetBalance( 0 );
         }
-
-        return this;
+        return pLeft;
     }
 
     /***************************************************************
-    ** METHOD:       pnode_t InsertNode( pnode_t pNode )
-    ** PURPOSE:      Inserts node into a subtree rooted at the current node
-    ** ARGUMENTS:    pNode  - node to insert
+    ** METHOD:       pnode_t PromoteInner( pnode_t pNode,
+    **                                     pnode_t pChild )
+    ** PURPOSE:      Double rotation: makes the inner grandchild (the
+    **               grandchild on the side opposite to pChild) the
+    **               parent of pNode and pChild
     ** RETURN VALUE: new root of the subtree
     ****************************************************************/
-    inline pnode_t InsertNode( pnode_t pNode )
+    inline pnode_t PromoteInner( pnode_t pNode, pnode_t pChild )
     {
-        if( pNode->NodeKey > NodeKey )
-            RChild = RChild? RChild->InsertNode( pNode ): pNode->Initialize();
+        BOOL    right  = ( pChild == pNode->RChild );
+        pnode_t pInner = right? pChild->LChild: pChild->RChild;
+        pnode_t pA     = pInner->LChild;
+        pnode_t pB     = pInner->RChild;
+        int8s   bal    = pInner->GetBalance();
 
-        else //if( pNode->NodeKey <= NodeKey )
-            LChild = LChild? LChild->InsertNode( pNode ): pNode->Initialize();
+        Replace( pNode, pInner, pNode->GetParent() );
 
-        return RepairBalance();
+        pnode_t pLeft  = right? pNode:  pChild;
+        pnode_t pRight = right? pChild: pNode;
+
+        pLeft ->RChild = pA;  if( pA ) pA->SetParent( pLeft );
+        pRight->LChild = pB;  if( pB ) pB->SetParent( pRight );
+
+        pInner->LChild = pLeft;   pLeft ->SetParent( pInner );
+        pInner->RChild = pRight;  pRight->SetParent( pInner );
+
+        pLeft ->SetBalance( bal > 0? -1: 0 );
+        pRight->SetBalance( bal < 0?  1: 0 );
+        pInner->SetBalance( 0 );
+        return pInner;
     }
 
     /***************************************************************
-    ** METHOD:       pnode_t RemoveNode( pnode_t pNode, BOOL* result )
-    ** PURPOSE:      Removes node from a subtree rooted at the current node
-    **
-    ** ARGUMENTS:    pNode  - node to remove (never NULL)
-    **               result - placeholder for the boolean indicating 
-    **                        whether given node was found in the tree 
-    **                        and removed or not
-    **
+    ** METHOD:       pnode_t Rotate( pnode_t pNode, int8s bal )
+    ** PURPOSE:      Restores balance of a node whose balance would
+    **               be 'bal' (+2 or -2)
     ** RETURN VALUE: new root of the subtree
     ****************************************************************/
-    inline pnode_t RemoveNode( pnode_t pNode, BOOL* result )
+    inline pnode_t Rotate( pnode_t pNode, int8s bal )
     {
-        if( pNode == this )
+        if( bal > 0 )
         {
-            if( !LChild )   return RChild;
-            if( !RChild )   return LChild;
-
-            /* swap pNode with the right end of its left sub-AVLTree */
-            pnode_t ptr, left_subroot;
-
-            left_subroot = LChild->RemoveRightEnd( &ptr );
-            ptr->LChild  = left_subroot;
-            ptr->RChild  = RChild;
-
-            *result = TRUE;
-            return ptr->RepairBalance();
+            /* if imbalance is due to internal branch, do double promotion */
+            pnode_t pChild = pNode->RChild;
+            return pChild->GetBalance() < 0? PromoteInner( pNode, pChild ): PromoteRight( pNode );
         }
-
-        if( pNode->NodeKey > NodeKey && RChild )
+        else
         {
-            RChild = RChild->RemoveNode( pNode, result );
-            return RepairBalance();
+            /* if imbalance is due to internal branch, do double promotion */
+            pnode_t pChild = pNode->LChild;
+            return pChild->GetBalance() > 0? PromoteInner( pNode, pChild ): PromoteLeft( pNode );
         }
+    }
 
-        if( pNode->NodeKey <= NodeKey && LChild )
+    /***************************************************************
+    ** METHOD:       void RepairInsert( pnode_t pNode )
+    ** PURPOSE:      Updates balance of the ancestors of a new leaf
+    **               while the height of their subtrees grows; one
+    **               rotation at most
+    ** RETURN VALUE:
+    ****************************************************************/
+    inline void RepairInsert( pnode_t pNode )
+    {
+        for( pnode_t pParent = pNode->GetParent(); pParent; pNode = pParent, pParent = pNode->GetParent() )
         {
-            LChild = LChild->RemoveNode( pNode, result );
-            return RepairBalance();
+            int8s bal = pParent->GetBalance() + ( pNode == pParent->LChild? -1: 1 );
+
+            if( bal == 0 )
+            {
+                pParent->SetBalance( 0 );
+                return;
+            }
+            if( bal == 1 || bal == -1 )
+            {
+                pParent->SetBalance( bal );
+                continue;
+            }
+            Rotate( pParent, bal );
+            return;
         }
     }
 
     /***************************************************************
-    ** METHOD:       pnode_t RemoveLeftEnd( pnode_t* ppNode )
-    ** PURPOSE:      Removes the leftmost (smallest) node from a 
-    **               subtree rooted at the current node
-    **
-    ** ARGUMENTS:    pNode - placeholder for the address of the removed node
-    **
-    ** RETURN VALUE: new root of the subtree
+    ** METHOD:       void RepairRemove( pnode_t pParent, BOOL left )
+    ** PURPOSE:      Updates balance of pParent, whose left (right)
+    **               subtree became lower, and of its ancestors while
+    **               the height of their subtrees decreases
+    ** RETURN VALUE:
     ****************************************************************/
-    inline pnode_t RemoveLeftEnd( pnode_t* ppNode )
+    inline void RepairRemove( pnode_t pParent, BOOL left )
     {
-        if( !LChild )  /* end of recursion */
+        while( pParent )
         {
-            *ppNode = this;
-            return RChild;
+            int8s   bal = pParent->GetBalance() + ( left? 1: -1 );
+            pnode_t pNode;
+
+            if( bal == 1 || bal == -1 )
+            {
+                pParent->SetBalance( bal );
+                return;
+            }
+            if( bal == 0 )
+            {
+                pParent->SetBalance( 0 );
+                pNode = pParent;
+            }
+            else
+            {
+                pnode_t pChild = bal > 0? pParent->RChild: pParent->LChild;
+                BOOL    same   = ( pChild->GetBalance() == 0 );
+
+                pNode = Rotate( pParent, bal );
+                if( same )
+                    return;     /* height of the subtree did not change */
+            }
+
+            pParent = pNode->GetParent();
+            left    = pParent && pParent->LChild == pNode;
         }
-        LChild = LChild->RemoveLeftEnd( ppNode );
-        return RepairBalance();
     }
 
     /***************************************************************
-    ** METHOD:       pnode_t RemoveRightEnd( pnode_t* ppNode )
-    ** PURPOSE:      Removes the rightmost (largest) node from a 
-    **               subtree rooted at the current node
-    **
-    ** ARGUMENTS:    pNode - placeholder for the address of the removed node
-    **
-    ** RETURN VALUE: new root of the subtree
+    ** METHOD:       void Unlink( pnode_t pNode )
+    ** PURPOSE:      Removes the node from the tree
+    ** RETURN VALUE:
     ****************************************************************/
-    inline pnode_t RemoveRightEnd( pnode_t* ppNode )
+    inline void Unlink( pnode_t pNode )
     {
-        if( !RChild )  /* end of recursion */
+        pnode_t pParent = pNode->GetParent();
+
+        if( pNode == pHead )
         {
-            *ppNode = this;
-            return LChild;
+            /* the head has no left child: the next node is the left end
+               of its right subtree, or its parent */
+            pHead = pNode->RChild? LeftEnd( pNode->RChild ): pParent;
         }
-        RChild = RChild->RemoveRightEnd( ppNode );
-        return RepairBalance();
-    }
 
+        if( !pNode->LChild || !pNode->RChild )
+        {
+            pnode_t pChild = pNode->LChild? pNode->LChild: pNode->RChild;
+            BOOL    left   = pParent && pParent->LChild == pNode;
 
-/*******************************************************************/
-protected:
-/*******************************************************************/
+            Replace( pNode, pChild, pParent );
+            RepairRemove( pParent, left );
+            return;
+        }
 
-    pnode_t     LChild;     /* Left  child */
-    pnode_t     RChild;     /* Right child */
-    avlkey_t    NodeKey;    /*             */
+        /* swap pNode with the right end of its left subtree */
+        pnode_t ptr = RightEnd( pNode->LChild );
+        pnode_t pRepair;
+        BOOL    left;
 
-/*******************************************************************/
-public:
-/*******************************************************************/
-    AVLNode( avlkey_t key_val )     { Initialize(); NodeKey = key_val; }
-    /* virtual */ ~AVLNode()        {}
+        if( ptr == pNode->LChild )
+        {
+            pRepair = ptr;
+            left    = TRUE;
+        }
+        else
+        {
+            pRepair = ptr->GetParent();
+            left    = FALSE;
 
-};    
+            pRepair->RChild = ptr->LChild;
+            if( ptr->LChild ) ptr->LChild->SetParent( pRepair );
 
+            ptr->LChild = pNode->LChild;
+            ptr->LChild->SetParent( ptr );
+        }
 
+        ptr->RChild = pNode->RChild;
+        ptr->RChild->SetParent( ptr );
+        ptr->SetBalance( pNode->GetBalance() );
+        Replace( pNode, ptr, pParent );
 
+        RepairRemove( pRepair, left );
+    }
 
+    /***************************************************************/
+    static inline pnode_t LeftEnd( pnode_t pNode )
+    {
+        while( pNode->LChild ) pNode = pNode->LChild;
+        return pNode;
+    }
+    /***************************************************************/
+    static inline pnode_t RightEnd( pnode_t pNode )
+    {
+        while( pNode->RChild ) pNode = pNode->RChild;
+        return pNode;
+    }
+    /***************************************************************/
+    static inline pnode_t Successor( pnode_t pNode )
+    {
+        if( pNode->RChild )
+            return LeftEnd( pNode->RChild );
 
-/*******************************************************************
-** CLASS:        class AVLTree
-** PURPOSE:      
-********************************************************************/
-template < class avlkey_t > class AVLTree
-{
-    typedef AVLNode< avlkey_t >* pnode_t;
+        pnode_t pParent = pNode->GetParent();
+        while( pParent && pParent->RChild == pNode )
+        {
+            pNode   = pParent;
+            pParent = pNode->GetParent();
+        }
+        return pParent;
+    }
 
 /*******************************************************************/
 protected:
 /*******************************************************************/
     pnode_t pRoot;  /* root node of the tree       */
+    pnode_t pHead;  /* leftmost (smallest) node    */
     int32u  Count;  /* number of nodes in the tree */
 
 /*******************************************************************/
 public:
 /*******************************************************************/
 
-    AVLTree()   
-    { 
-        pRoot = NULL; 
-        Count = 0;
+    AVLTree()
+    {
+        Clear();
     }
 
     virtual ~AVLTree()  {}
@@ -288,38 +413,104 @@ public:
     /***************************************************************/
     inline int32u GetCount(void) const   { return Count; }
 
-    /***************************************************************/
+    /***************************************************************
+    ** METHOD:       void Clear( void )
+    ** PURPOSE:      Forgets all nodes (the nodes are not modified)
+    ****************************************************************/
+    inline void Clear( void )
+    {
+        pRoot = NULL;
+        pHead = NULL;
+        Count = 0;
+    }
+
+    /***************************************************************
+    ** METHOD:       void AddNode( pnode_t pNode )
+    ** PURPOSE:      Inserts the node.  A node is inserted before
+    **               (to the left of) the nodes with equal keys.
+    ****************************************************************/
     inline void AddNode( pnode_t pNode )
     {
-		if( pNode )
-		{
-			pRoot = ( pRoot )? pRoot->InsertNode( pNode ): pNode->Initialize();
-			Count++;
-		}
+        if( !pNode )
+            return;
+
+        Count++;
+        if( !pRoot )
+        {
+            pRoot = pHead = pNode->Initialize( NULL );
+            return;
+        }
+
+        pnode_t pParent = pRoot;
+        for( ;; )
+        {
+            pnode_t* ppChild = pNode->NodeKey > pParent->NodeKey? &pParent->RChild: &pParent->LChild;
+            if( *ppChild == NULL )
+            {
+                *ppChild = pNode->Initialize( pParent );
+                break;
+            }
+            pParent = *ppChild;
+        }
+
+        if( pNode->NodeKey <= pHead->NodeKey )
+            pHead = pNode;
+
+        RepairInsert( pNode );
+    }
+    /***************************************************************
+    ** METHOD:       BOOL RemoveNode( pnode_t pNode )
+    ** PURPOSE:      Removes the node if it is in the tree
+    ** RETURN VALUE: TRUE if the node was found and removed
+    ****************************************************************/
+    inline BOOL RemoveNode( pnode_t pNode )
+    {
+        if( !pRoot || !pNode )
+            return FALSE;
+
+        /* find the leftmost node with key not less than pNode's key */
+        pnode_t ptr = NULL;
+        for( pnode_t p = pRoot; p; )
+        {
+            if( pNode->NodeKey > p->NodeKey )   p = p->RChild;
+            else                                { ptr = p; p = p->LChild; }
+        }
+
+        /* nodes with equal keys are adjacent in order */
+        for( ; ptr && !( pNode->NodeKey < ptr->NodeKey ); ptr = Successor( ptr ))
+            if( ptr == pNode )
+            {
+                Unlink( pNode );
+                Count--;
+                return TRUE;
+            }
+        return FALSE;
     }
     /***************************************************************/
-    inline BOOL RemoveNode( pnode_t pNode )
+    inline pnode_t GetHead( void ) const
     {
-        BOOL result = FALSE;
-        if( pRoot && pNode ) pRoot = pRoot->RemoveNode( pNode, &result );
-        if( result ) Count--;
-        return result;
+        return pHead;
     }
     /***************************************************************/
     inline pnode_t RemoveHead( void )
     {
-        pnode_t pNode = NULL;
-        if( pRoot ) pRoot = pRoot->RemoveLeftEnd( &pNode );
-        if( pNode ) Count--;
+        pnode_t pNode = pHead;
+        if( pNode )
+        {
+            Unlink( pNode );
+            Count--;
+        }
         return pNode;
     }
     /***************************************************************/
     inline pnode_t RemoveTail( void )
     {
-        //NODE_t* pNode = NULL;
-        pnode_t pNode = NULL;
-        if( pRoot ) pRoot = pRoot->RemoveRightEnd( &pNode );
-        if( pNode ) Count--;
+        pnode_t pNode = pRoot? RightEnd( pRoot ): NULL;
+        if( pNode )
+        {
+            Unlink( pNode );
+            Count--;
+        }
         return pNode;
     }
 };
@@ -332,4 +523,4 @@ public:
 namespace AVL     = AVL_tree_namespace;
 namespace AVLTREE = AVL_tree_namespace;
 
-#endif   /* _AVL_AVLTREE_H_V001_INCLUDED_ */
\ No newline at end of file
+#endif   /* _AVL_AVLTREE_H_V001_INCLUDED_ */
@@ -25,7 +25,7 @@ const int16s PDF_MAX_PCT_SIZE   = 1518;
 const int16s PDF_COUNT          = PDF_MAX_PCT_SIZE + 1;
 
 
-const float dwnstrm_size_pdf[ PDF_COUNT ] = {
+constexpr float dwnstrm_size_pdf[ PDF_COUNT ] = {
 
     0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 
     0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 
@@ -181,7 +181,7 @@ const float dwnstrm_size_pdf[ PDF_COUNT ] = {
     0.002839F, 0.000001F, 0.000000F, 0.000000F, 0.001230F, 0.000000F, 0.000000F, 0.000000F, 0.121604F
 };  
 
-const float upstrm_size_pdf[ PDF_COUNT ] = {
+constexpr float upstrm_size_pdf[ PDF_COUNT ] = {
 
     0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 
 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 0.000000F, 
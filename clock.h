@@ -79,6 +79,9 @@ public:
     }
 
     virtual~ CClock()         {}
+
+    /////////////////////////////////////////////////////////////////
+    virtual void Serialize( Archive& ar )  { ar & timeOffset & clockDrift; }
     
     /////////////////////////////////////////////////////////////////
     // METHOD:       inline DESL::time_t LocalTime( void ) const
@@ -152,6 +155,9 @@ public:
     }
     virtual~ CClockSync()         {}
 
+    /////////////////////////////////////////////////////////////////
+    virtual void Serialize( Archive& ar )  { ar & timeOffset; }
+
     inline DESL::time_t LocalTime( void ) const      { return DESL::GlobalTime() + timeOffset; }
     inline void         LocalTime( DESL::time_t tm ) { timeOffset = tm - DESL::GlobalTime();   }
 };
@@ -0,0 +1,132 @@
+###########################################################
+# Builds the LTO+PGO optimized simulator (target 'pgo'):
+#
+#   1. use/        instrumented build (EPON_PGO=GENERATE)
+#   2. train/      runs scenario 001 (one sweep of all loads with
+#                  TRAIN_PACKETS packets per load) and the quick
+#                  benchmark suite with the instrumented build;
+#                  the profile is written to profile/
+#   3. use/        LTO+PGO build (EPON_PGO=USE).  GCC finds the
+#                  profile of an object file by the object's path,
+#                  so both builds must be in the same directory.
+#   4. baseline/   LTO build without profile
+#   5. compares events per second of the end-to-end benchmark
+#      (EPON_bench epon/events) of baseline/ and use/, best of
+#      BENCH_RUNS runs each
+#
+# Usage:
+#   cmake -DSOURCE_DIR=<src> -DBINARY_DIR=<dir> -DCXX_COMPILER=<c++>
+#         -DCXX_COMPILER_ID=<id> [-DGENERATOR=<generator>]
+#         [-DOBJECT_QUEUE=ON] -P pgo.cmake
+###########################################################
+cmake_minimum_required( VERSION 3.13 )
+
+set( PROFILE_DIR    ${BINARY_DIR}/profile )
+set( TRAIN_DIR      ${BINARY_DIR}/train )
+set( BENCH_RUNS     3 )
+set( TRAIN_PACKETS  100000 )    # packets per load point in training (default run: PACKET_LIMIT)
+
+if( GENERATOR )
+    set( GENERATOR_ARGS -G "${GENERATOR}" )
+endif()
+
+###########################################################
+function( build_variant name )
+    message( STATUS "PGO: building ${name}" )
+    execute_process( COMMAND ${CMAKE_COMMAND} -S ${SOURCE_DIR} -B ${BINARY_DIR}/${name} ${GENERATOR_ARGS}
+                             -DCMAKE_BUILD_TYPE=Release -DCMAKE_CXX_COMPILER=${CXX_COMPILER} -DEPON_LTO=ON
+                             -DEPON_OBJECT_QUEUE=${OBJECT_QUEUE} ${ARGN}
+                     OUTPUT_QUIET RESULT_VARIABLE result )
+    if( result )
+        message( FATAL_ERROR "PGO: cannot configure ${name}" )
+    endif()
+
+    execute_process( COMMAND ${CMAKE_COMMAND} --build ${BINARY_DIR}/${name} --config Release --parallel
+                     RESULT_VARIABLE result )
+    if( result )
+        message( FATAL_ERROR "PGO: cannot build ${name}" )
+    endif()
+endfunction()
+
+###########################################################
+function( run name dir )
+    message( STATUS "PGO: running ${name}" )
+    execute_process( COMMAND ${ARGN} WORKING_DIRECTORY ${dir}
+                     OUTPUT_FILE ${dir}/${name}.log ERROR_FILE ${dir}/${name}.log RESULT_VARIABLE result )
+    if( result )
+        message( FATAL_ERROR "PGO: ${name} failed, see ${dir}/${name}.log" )
+    endif()
+endfunction()
+
+###########################################################
+# Returns events per second measured by EPON_bench of build
+# 'name' in 'var' (best of BENCH_RUNS runs)
+###########################################################
+function( events_per_sec var name )
+    set( best 0 )
+    foreach( n RANGE 1 ${BENCH_RUNS} )
+        run( ${name}_bench ${BINARY_DIR} ${BINARY_DIR}/${name}/EPON_bench --filter epon/events --out ${BINARY_DIR}/${name}.json )
+        file( READ ${BINARY_DIR}/${name}.json json )
+        string( REGEX MATCH "\"ops_per_sec\": ([0-9]+)" match "${json}" )
+        if( CMAKE_MATCH_1 GREATER best )
+            set( best ${CMAKE_MATCH_1} )
+        endif()
+    endforeach()
+    set( ${var} ${best} PARENT_SCOPE )
+endfunction()
+
+
+###########################################################
+# 1. Instrumented build
+###########################################################
+file( REMOVE_RECURSE ${PROFILE_DIR} ${TRAIN_DIR} )
+file( MAKE_DIRECTORY ${PROFILE_DIR} ${TRAIN_DIR} )
+
+build_variant( use -DEPON_PGO=GENERATE -DEPON_PGO_DIR=${PROFILE_DIR} )
+
+###########################################################
+# 2. Training
+###########################################################
+run( EPON       ${TRAIN_DIR} ${BINARY_DIR}/use/EPON pgo_train --packets ${TRAIN_PACKETS} )
+run( EPON_bench ${TRAIN_DIR} ${BINARY_DIR}/use/EPON_bench --quick --out ${TRAIN_DIR}/bench.json )
+
+if( CXX_COMPILER_ID MATCHES "Clang" )
+    get_filename_component( compiler_dir ${CXX_COMPILER} DIRECTORY )
+    find_program( LLVM_PROFDATA NAMES llvm-profdata HINTS ${compiler_dir} )
+    if( NOT LLVM_PROFDATA )
+        message( FATAL_ERROR "PGO: llvm-profdata not found" )
+    endif()
+
+    file( GLOB raw_profiles ${PROFILE_DIR}/*.profraw )
+    execute_process( COMMAND ${LLVM_PROFDATA} merge -output=${PROFILE_DIR}/default.profdata ${raw_profiles}
+                     RESULT_VARIABLE result )
+    if( result )
+        message( FATAL_ERROR "PGO: cannot merge profiles" )
+    endif()
+endif()
+
+###########################################################
+# 3. Optimized build (same directory), 4. Baseline
+###########################################################
+build_variant( use      -DEPON_PGO=USE -DEPON_PGO_DIR=${PROFILE_DIR} )
+build_variant( baseline -DEPON_PGO=OFF )
+
+###########################################################
+# 5. Report
+###########################################################
+events_per_sec( baseline_rate baseline )
+events_per_sec( pgo_rate      use )
+
+if( baseline_rate AND pgo_rate )
+    math( EXPR gain_x10 "( ${pgo_rate} - ${baseline_rate} ) * 1000 / ${baseline_rate}" )
+    math( EXPR gain_int  "${gain_x10} / 10" )
+    math( EXPR gain_frac "${gain_x10} % 10" )
+    string( REPLACE "-" "" gain_frac ${gain_frac} )
+    if( gain_x10 LESS 0 AND gain_int EQUAL 0 )
+        set( gain_int "-0" )
+    endif()
+    message( STATUS "PGO: events per second, LTO:     ${baseline_rate}" )
+    message( STATUS "PGO: events per second, LTO+PGO: ${pgo_rate} (${gain_int}.${gain_frac}%)" )
+endif()
+
+message( STATUS "PGO: optimized simulator is ${BINARY_DIR}/use/EPON" )
@@ -32,11 +32,29 @@ const int32s  PON_MAX_LINK_DISTANCE     = 20000;    //  20   km
 
 ///////////////////////////////////////////////////////////
 //  Configuration Constants 
+//      Defaults of the topology; see Topology below
 ///////////////////////////////////////////////////////////
 const int16s   NUM_LLID                 = 16 ;       // one LLID per ONU 
 const int32s   BUFFER_SIZE              = 1024*1024; // ONU buffer size = 1 Mbyte
 //const int32s   BUFFER_SIZE              = 1024 * 1024 * 10; // ONU buffer size = 10 Mbyte
+const int32s   DOWNSTREAM_BUFFER_SIZE   = 16*1024*1024; // OLT downstream buffer size = 16 Mbyte
 const int16s   MAX_SLOT                 = 15500;
+const int16s   MAX_NUM_LLID             = ONU_BASE_ID - 1;   // LLID must fit below the ID bits
+
+///////////////////////////////////////////////////////////
+//  Topology
+//      Initialized to the constants above; the command-line
+//      options --llid N, --buffer BYTES, and --slot BYTES 
+//      change them at run time.
+///////////////////////////////////////////////////////////
+struct Topology_t
+{
+    int16s     NumLLID;                              // number of LLIDs (ONUs)
+    int32s     BufferSize;                           // ONU buffer size (bytes)
+    int32s     MaxSlot;                              // maximum slot granted by OLT (bytes)
+};
+
+Topology_t Topology = { NUM_LLID, BUFFER_SIZE, MAX_SLOT };
 
 ///////////////////////////////////////////////////////////
 //  Traffic Profile Parameters 
@@ -44,17 +62,43 @@ const int16s   MAX_SLOT                 = 15500;
 const int16s  BURST_POOL_SIZE           = 128;       // number of On/Off sources 
 const int16s  MEAN_BURST_SIZE           = 3200; 
 const int16s  BURST_PERIOD              = 1;
+const BOOL    SRD_AGGREGATE             = FALSE;     // SRD: generate the pool as one superposed stream
+const float   FGN_HURST                 = 0.8F;      // FGN: Hurst parameter
+const float   FGN_VARIANCE              = 12.0F;     // FGN: variance coefficient (bytes)
+const int32s  FGN_BLOCK                 = 1 << 16;   // FGN: intervals synthesized at once (power of 2)
+const float   PARETO_SHAPE              = 1.4F;      // LRD: shape of the Pareto On/Off periods
+const int32s  VIDEO_BURST_PERIOD        = 10000;     // VST: period between frames
+const float   VIDEO_SHAPE               = 1.4F;      // VST: shape of the frame size distribution
 
 ///////////////////////////////////////////////////////////
 //  Traffic Type
 //      LRD - Long-Range Dependent (Bursty, Self-similar)
 //      SRD - Short-Range Dependent (Bursty, not Self-similar)
+//      FGN - Fractional Gaussian Noise (Self-similar)
 //      CBR - Constant Bit Rate
 ///////////////////////////////////////////////////////////
 
 #define TRAFFIC_TYPE   LRD
+//#define TRAFFIC_TYPE   FGN
 //#define TRAFFIC_TYPE   CBR
 //#define TRAFFIC_TYPE   VST
+//#define TRAFFIC_TYPE   TRC
+
+#define TRAFFIC_TRACE_FILE  "upstream.pktr"     // packet trace replayed by TRC traffic
+
+///////////////////////////////////////////////////////////
+//  Traffic Cache
+//      If TRAFFIC_CACHE is TRUE, the packets generated by each
+//      PacketSource are stored in TRAFFIC_CACHE_DIR, and later
+//      runs with the same traffic parameters and TRAFFIC_SEED
+//      read them back instead of generating them again.
+//      Change TRAFFIC_CACHE_VERSION to invalidate old caches
+//      after a change to the traffic generator.
+///////////////////////////////////////////////////////////
+const BOOL    TRAFFIC_CACHE             = FALSE;
+const char    TRAFFIC_CACHE_DIR[]       = ".";
+const int32u  TRAFFIC_SEED              = 1;
+const int32u  TRAFFIC_CACHE_VERSION     = 1;
 
 
 
@@ -62,14 +106,23 @@ const int16s  BURST_PERIOD              = 1;
 #define SRD 2
 #define CBR 3
 #define VST 4
+#define TRC 5
+#define FGN 6
+
 
+///////////////////////////////////////////////////////////
+// SRC_CLASS: PacketSourceT< S > holds its streams of type S 
+// by value and calls them statically; PacketSource accepts 
+// a pool of streams of mixed types.
+///////////////////////////////////////////////////////////
 
 #if TRAFFIC_TYPE == LRD
     #define TRAFFIC_DESCRIPTOR     "Bursty (Self-similar)"
-    #define SRC_CTOR( n ) PacketSource( UNI_BYTE_TIME,          \
+    #define SRC_CLASS              PacketSourceT< GEN::StreamPareto >
+    #define SRC_CTOR( n ) SRC_CLASS(    UNI_BYTE_TIME,          \
                                         PACKET_OVERHEAD,        \
                                         MEAN_BURST_SIZE,        \
-                                        CreateParetoStream,     \
+                                        ConstructStream,        \
                                         BURST_POOL_SIZE,        \
                                         LLID_LOAD,              \
                                         0,                      \
@@ -77,41 +130,73 @@ const int16s  BURST_PERIOD              = 1;
 
 #elif TRAFFIC_TYPE == SRD 
     #define TRAFFIC_DESCRIPTOR     "Bursty (non-Self-similar)"
-    #define SRC_CTOR( n ) PacketSource( UNI_BYTE_TIME,          \
+    #define SRC_CLASS              PacketSourceT< std::conditional< SRD_AGGREGATE != FALSE, GEN::StreamExponAggregate, GEN::StreamExpon >::type >
+    #define SRC_CTOR( n ) SRC_CLASS(    UNI_BYTE_TIME,          \
                                         PACKET_OVERHEAD,        \
                                         MEAN_BURST_SIZE,        \
-                                        CreateExponStream,      \
-                                        BURST_POOL_SIZE,        \
+                                        ConstructStream,        \
+                                        SRD_AGGREGATE? 1: BURST_POOL_SIZE,                      \
+                                        LLID_LOAD,              \
+                                        0,                      \
+                                        n )
+
+#elif TRAFFIC_TYPE == FGN
+    #define TRAFFIC_DESCRIPTOR     "Fractional Gaussian Noise (Self-similar)"
+    #define SRC_CLASS              PacketSourceT< GEN::StreamFGN >
+    #define SRC_CTOR( n ) SRC_CLASS(    UNI_BYTE_TIME,          \
+                                        PACKET_OVERHEAD,        \
+                                        MEAN_BURST_SIZE,        \
+                                        ConstructStream,        \
+                                        1,                      \
                                         LLID_LOAD,              \
                                         0,                      \
                                         n )
 
 #elif TRAFFIC_TYPE == CBR
     #define TRAFFIC_DESCRIPTOR      "Constant Bit Rate"
-    #define SRC_CTOR( n ) PacketSource( UNI_BYTE_TIME,          \
+    #define SRC_CLASS              PacketSourceT< GEN::StreamCBR >
+    #define SRC_CTOR( n ) SRC_CLASS(    UNI_BYTE_TIME,          \
                                         PACKET_OVERHEAD,        \
                                         MEAN_BURST_SIZE,        \
-                                        CreateCBRStream,        \
+                                        ConstructStream,        \
                                         BURST_POOL_SIZE,        \
                                         LLID_LOAD,              \
                                         0,                      \
                                         n )
 #elif TRAFFIC_TYPE == VST 
     #define TRAFFIC_DESCRIPTOR     "Video Stream"
-    #define SRC_CTOR( n ) PacketSource( UNI_BYTE_TIME,          \
+    #define SRC_CLASS              PacketSourceT< GEN::StreamVideo >
+    #define SRC_CTOR( n ) SRC_CLASS(    UNI_BYTE_TIME,          \
                                         PACKET_OVERHEAD,        \
                                         MEAN_BURST_SIZE,        \
-                                        CreateVideoStream,      \
+                                        ConstructStream,        \
                                         BURST_POOL_SIZE,        \
                                         LLID_LOAD,              \
                                         0,                      \
                                         n )
 
+#elif TRAFFIC_TYPE == TRC 
+    #define TRAFFIC_DESCRIPTOR     "Packet Trace " TRAFFIC_TRACE_FILE
+    #define SRC_CLASS              TraceSource
+    #define SRC_CTOR( n ) TraceSource(  UNI_BYTE_TIME,          \
+                                        PACKET_OVERHEAD,        \
+                                        TRAFFIC_TRACE_FILE,     \
+                                        _SRC_ID( n ),           \
+                                        Topology.NumLLID,       \
+                                        TRUE,                   \
+                                        LLID_LOAD,              \
+                                        0,                      \
+                                        n )
+
 #else
 
     #error TRAFFIC_TYPE should be defined.
 #endif
 
+#if !defined( SRC_CLASS )
+    #define SRC_CLASS              PacketSource
+#endif
+
 
 ///////////////////////////////////////////////////////////
 //  Derived Constants 
@@ -143,8 +228,9 @@ void OutputParameters( void )
     MSG_CONF( "Guard Band Time (ns),"       << GUARD_BAND_TIME );
 
     MSG_CONF( "-------------------------------------------" );
-    MSG_CONF( "Number of LLIDs,"            << NUM_LLID );
-    MSG_CONF( "ONU Buffer Size (bytes),"    << BUFFER_SIZE );
+    MSG_CONF( "Number of LLIDs,"            << Topology.NumLLID );
+    MSG_CONF( "ONU Buffer Size (bytes),"    << Topology.BufferSize );
+    MSG_CONF( "Maximum Slot (bytes),"       << Topology.MaxSlot );
     MSG_CONF( "Minimum Link Distance (m),"  << PON_MIN_LINK_DISTANCE );
     MSG_CONF( "Maximum Link Distance (m),"  << PON_MAX_LINK_DISTANCE );
 
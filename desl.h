@@ -5,6 +5,7 @@
 //              following classes:
 //              class DESL_environment<T>
 //              class CBase (nested)
+//              class CObjRef (nested)
 //              class CEvent (nested)
 //              class CEventQueue (nested)
 //
@@ -36,12 +37,29 @@
 #ifndef _DESL_H_V003_INCLUDED_
 #define _DESL_H_V003_INCLUDED_
 
-#include <crtdbg.h>     // needed for _ASSERT() macro 
+#include <limits>
+#include <algorithm>
+#include "_compat.h"     // needed for _ASSERT() macro 
 
 #include "_stack.h"
+#include "_wheel.h"
 #include "_list.h"
+#include "_ckpt.h"
 #include "avltree.h"
 
+/////////////////////////////////////////////////////////////////////////
+// Timing wheel of the event queue: DESL_WHEEL_LEVELS levels of 
+// 2^DESL_WHEEL_BITS slots.  Events less than about 
+// 2^(DESL_WHEEL_BITS * DESL_WHEEL_LEVELS) time units ahead of the 
+// queue's cursor are kept in the wheel, later events in the AVL tree.
+/////////////////////////////////////////////////////////////////////////
+#ifndef DESL_WHEEL_BITS
+    #define DESL_WHEEL_BITS     8
+#endif
+#ifndef DESL_WHEEL_LEVELS
+    #define DESL_WHEEL_LEVELS   3
+#endif
+
 /////////////////////////////////////////////////////////////////////////
 // CLASS:        template < class TIME_T, class DATA_T > 
 //               class DESL_environment 
@@ -66,9 +84,12 @@ public:
 /////////////////////////////////////////////////////////////////////////
 #define ACTIVATION_TIME  NodeKey
 
-    extern class CEvent;
-    extern class CEventQueue;
-    extern class CBase;
+    class CEvent;
+    class CEventPool;
+    class CEventQueue;
+    class CObjectQueue;
+    class CBase;
+    class CObjRef;
 
     friend class CBase;
 
@@ -78,15 +99,44 @@ public:
     typedef class CBase   base_t;     // base class for all DESL classes 
     typedef class CEvent  evnt_t;     // CEvent class  
 
+    /////////////////////////////////////////////////////////////////////
+    // CLASS:        class CObjRef
+    // PURPOSE:      Reference to an object derived from CBase, stored 
+    //               as a 32-bit handle (index in the table of objects) 
+    //               instead of a pointer.  Handle 0 is the NULL object.
+    //               Assignment from and conversion to base_t* make it 
+    //               usable in place of a pointer.
+    /////////////////////////////////////////////////////////////////////
+    class CObjRef
+    {
+    private:
+        int32u  Handle;
+
+    public:
+        inline CObjRef& operator= ( base_t* ptr )   { Handle = ptr? ptr->Handle: 0; return *this; }
+        inline operator base_t* ( void ) const      { return DESL_TABLE[ Handle ]; }
+        inline base_t*  operator-> ( void ) const   { return DESL_TABLE[ Handle ]; }
+        inline int32u   GetHandle( void ) const     { return Handle; }
+    };
+
     /////////////////////////////////////////////////////////////////////
     // CLASS:        class CEvent : public AVLNode
     // PURPOSE:      Represents an Event that can be stored in and 
     //               retrieved from the Event queue (CEventQueue) 
+    // NOTES:        Events are aligned to a cache line (EVENT_ALIGN); 
+    //               an Event with data_t of up to 24 bytes occupies 
+    //               exactly one line: AVL node (32 bytes), data_t, 
+    //               and two 4-byte object handles.
     /////////////////////////////////////////////////////////////////////
-    class CEvent : private AVL::AVLNode< time_t >, public data_t
+    enum { EVENT_ALIGN = 64 };
+
+    class alignas( EVENT_ALIGN ) CEvent : private AVL::AVLNode< time_t >, public data_t
     {
+        friend class CEventPool;
         friend class CEventQueue;
+        friend class CObjectQueue;
         friend class Stack< evnt_t >;
+        friend class TimingWheel< evnt_t, time_t, DESL_WHEEL_BITS, DESL_WHEEL_LEVELS >;
     /////////////////////////////////////////////////////////////////////
     private:
     /////////////////////////////////////////////////////////////////////
@@ -127,12 +177,226 @@ public:
         inline BOOL    IsActive( void ) const { return GetNext() == this  
                                                     && GetPrev() == this; }
 
-        //inline time_t GetTime( void ) const { return ACTIVATION_TIME; }
+        /////////////////////////////////////////////////////////////////
+        // A held event is kept by its consumer after dispatching (see 
+        // HoldEvent): it is neither active nor in the event queue
+        /////////////////////////////////////////////////////////////////
+        inline void    Hold( void )           { AVL::AVLNode<time_t>::LChild = NULL; }
+        inline BOOL    IsHeld( void ) const   { return GetNext() == this  
+                                                    && GetPrev() == NULL; }
+
+        inline time_t  GetTime( void ) const  { return AVL::AVLNode<time_t>::ACTIVATION_TIME; }
+
+        // registration number (CObjectQueue), kept in the word used by 
+        // the AVL tree for the parent link
+        inline void      SetOrder( uintptr_t n )  { AVL::AVLNode<time_t>::Parent = n; }
+        inline uintptr_t GetOrder( void ) const   { return AVL::AVLNode<time_t>::Parent; }
     /////////////////////////////////////////////////////////////////////
     public:
     /////////////////////////////////////////////////////////////////////
-        base_t*        Producer;   // pointer to producer of the event
-        base_t*        Consumer;   // pointer to consumer of the event
+        CObjRef        Producer;   // producer of the event
+        CObjRef        Consumer;   // consumer of the event
+    };
+
+
+
+
+    /////////////////////////////////////////////////////////////////////
+    // CLASS:        class CEventPool
+    // PURPOSE:      Allocates Events in blocks and keeps the pool of 
+    //               free Events.  Base of the Event queues.
+    /////////////////////////////////////////////////////////////////////
+    class CEventPool
+    {
+    /////////////////////////////////////////////////////////////////////
+    private:
+    /////////////////////////////////////////////////////////////////////
+        evnt_t**         eqBlocks;         // blocks of EVENT_BLOCK events
+        int32u           eqBlockCount;     // (all events ever allocated)
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       void AllocateBlock( void )
+        // PURPOSE:      Allocates EVENT_BLOCK events in one contiguous 
+        //               block and pushes them to the pool of free 
+        //               events
+        // ARGUMENTS:
+        // RETURN VALUE:
+        /////////////////////////////////////////////////////////////////
+        enum { EVENT_BLOCK = 64 };
+
+        void AllocateBlock( void )
+        {
+            evnt_t** blocks = new evnt_t*[ eqBlockCount + 1 ];
+            if( eqBlockCount )
+                memcpy( blocks, eqBlocks, eqBlockCount * sizeof( evnt_t* ));
+            delete [] eqBlocks;
+
+            eqBlocks = blocks;
+            eqBlocks[ eqBlockCount ] = new evnt_t[ EVENT_BLOCK ];
+
+            for( int32u n = EVENT_BLOCK; n > 0; n-- )
+                eqEventPool.Push( &eqBlocks[ eqBlockCount ][ n - 1 ] );
+            eqBlockCount++;
+        }
+
+    /////////////////////////////////////////////////////////////////////
+    protected:
+    /////////////////////////////////////////////////////////////////////
+        Stack< evnt_t >  eqEventPool;      // pool of free events 
+
+        CEventPool()
+        {
+            eqBlocks      = NULL;
+            eqBlockCount  = 0;
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       void DeleteBlocks( void )
+        // PURPOSE:      Deletes all Events.  All Events must be in the 
+        //               free pool.  This is the only place where Events 
+        //               may be deleted (memory deallocated)
+        // ARGUMENTS:
+        // RETURN VALUE:
+        /////////////////////////////////////////////////////////////////
+        void DeleteBlocks( void )
+        {
+            eqEventPool.Clear();
+
+            for( int32u n = 0; n < eqBlockCount; n++ )
+                delete [] eqBlocks[n];
+            delete [] eqBlocks;
+
+            eqBlocks     = NULL;
+            eqBlockCount = 0;
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       void SerializeEvent( Archive& ar, evnt_t* pEvent )
+        // PURPOSE:      Writes or reads one event.  Producer and 
+        //               Consumer are stored as object handles, which 
+        //               GlobalSerialize() verifies for every object.
+        // ARGUMENTS:
+        // RETURN VALUE:
+        /////////////////////////////////////////////////////////////////
+        void SerializeEvent( Archive& ar, evnt_t* pEvent )
+        {
+            int32u producer = pEvent->Producer.GetHandle();
+            int32u consumer = pEvent->Consumer.GetHandle();
+
+            ar & pEvent->ACTIVATION_TIME & producer & consumer;
+            ar.Raw( static_cast< data_t* >( pEvent ), sizeof( data_t ));
+
+            if( ar.IsReading() )
+            {
+                if( producer >= DESL_TABLE_SIZE || consumer >= DESL_TABLE_SIZE )
+                {
+                    ar.SetFailed();
+                    producer = consumer = 0;
+                }
+                pEvent->Producer = DESL_TABLE[ producer ];
+                pEvent->Consumer = DESL_TABLE[ consumer ];
+            }
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       evnt_t** LoadEvents( Archive& ar, int32u count )
+        // PURPOSE:      Reads 'count' events into a temporary array
+        // ARGUMENTS:
+        // RETURN VALUE: array of events (to be deleted by the caller)
+        /////////////////////////////////////////////////////////////////
+        evnt_t** LoadEvents( Archive& ar, int32u count )
+        {
+            evnt_t** events = new evnt_t*[ count + 1 ];
+
+            for( int32u n = 0; n < count; n++ )
+            {
+                events[n] = AllocateEvent();
+                SerializeEvent( ar, events[n] );
+            }
+            return events;
+        }
+
+    /////////////////////////////////////////////////////////////////////
+    public:
+    /////////////////////////////////////////////////////////////////////
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       evnt_t* AllocateEvent(void)
+        // PURPOSE:      Get a pointer to a free Event.  If free Event 
+        //               pool is empty, allocate a new block of Events
+        //               from the heap first.  This is the only place 
+        //               where Events may be created (memory allocated)
+        // ARGUMENTS:
+        // RETURN VALUE: pointer to a free Event (CEvent*)
+        /////////////////////////////////////////////////////////////////
+        inline evnt_t* AllocateEvent(void)
+        {  
+            if( eqEventPool.GetCount() == 0 )
+                AllocateBlock();
+
+            evnt_t* pEvent = eqEventPool.Pop(); 
+
+            _ASSERT( pEvent != NULL ); 
+            pEvent->Activate();
+            return pEvent;
+        }
+    
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       void CancelEvent( evnt_t* pEvent )
+        // PURPOSE:      Will invalidate the Event by setting its 
+        //               consumer to NULL.  This Event will not be 
+        //               removed from the Event queue. 
+        // ARGUMENTS:    pEvent - Event to be canceled
+        // RETURN VALUE: 
+        /////////////////////////////////////////////////////////////////
+        inline void CancelEvent( evnt_t* pEvent )   
+        { 
+            if( pEvent ) pEvent->Consumer = NULL; 
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       void DestroyEvent( evnt_t* pEvent )
+        // PURPOSE:      Returns Event to the pool of free Events. It is 
+        //               assumed that the Event was previously removed 
+        //               from the Event queue, and from the eqEventPool 
+        //               and eqTopEvents stacks
+        // ARGUMENTS:    
+        // RETURN VALUE: pointer to the next Event (CEvent*)
+        /////////////////////////////////////////////////////////////////
+        inline void DestroyEvent( evnt_t* pEvent )  
+        { 
+            if( pEvent && pEvent->IsActive())
+                eqEventPool.Push( pEvent ); 
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       void HoldEvent( evnt_t* pEvent )
+        // PURPOSE:      Keeps an active Event out of the pool of free 
+        //               Events: a consumer may hold the Event it is 
+        //               given in ProcessEvent(), so that DispatchEvent 
+        //               does not destroy it, and use it again later.
+        //               A held Event must be released before it is 
+        //               registered or destroyed.
+        // ARGUMENTS:    pEvent - Event to be held
+        // RETURN VALUE: 
+        /////////////////////////////////////////////////////////////////
+        inline void HoldEvent( evnt_t* pEvent )  
+        { 
+            if( pEvent && pEvent->IsActive())
+                pEvent->Hold(); 
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       void ReleaseEvent( evnt_t* pEvent )
+        // PURPOSE:      Makes a held Event active again
+        // ARGUMENTS:    pEvent - held Event
+        // RETURN VALUE: 
+        /////////////////////////////////////////////////////////////////
+        inline void ReleaseEvent( evnt_t* pEvent )  
+        { 
+            if( pEvent && pEvent->IsHeld())
+                pEvent->Activate(); 
+        }
+
     };
 
 
@@ -142,16 +406,17 @@ public:
     // CLASS:        class CEventQueue : private AVLTree
     // PURPOSE:      
     /////////////////////////////////////////////////////////////////////
-    class CEventQueue : private AVL::AVLTree< time_t >
+    class CEventQueue : public CEventPool, private AVL::AVLTree< time_t >
     {
     /////////////////////////////////////////////////////////////////////
     private:
     /////////////////////////////////////////////////////////////////////
         time_t           eqCurrentTime;    // system time 
-        Stack< evnt_t >  eqEventPool;      // pool of free events 
         Stack< evnt_t >  eqTopEvents;      // immediate events (all having
                                            // the timestamp same as 
                                            // current system time)
+        TimingWheel< evnt_t, time_t, DESL_WHEEL_BITS, DESL_WHEEL_LEVELS > 
+                         eqWheel;          // near-future events
 
         /////////////////////////////////////////////////////////////////
         // METHOD:       void ClearEventChain( evnt_t* pEvent )
@@ -165,32 +430,76 @@ public:
         {
             if( pEvent->LChild ) ClearEventChain( (evnt_t*)pEvent->LChild );
             if( pEvent->RChild ) ClearEventChain( (evnt_t*)pEvent->RChild );
-            eqEventPool.Push( pEvent );
+            CEventPool::eqEventPool.Push( pEvent );
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       void SaveEventChain( Archive& ar, evnt_t* pEvent )
+        // PURPOSE:      Recursively traverses the AVL tree in order 
+        //               and writes the events to the archive
+        // ARGUMENTS:
+        // RETURN VALUE:
+        /////////////////////////////////////////////////////////////////
+        void SaveEventChain( Archive& ar, evnt_t* pEvent )
+        {
+            if( pEvent->LChild ) SaveEventChain( ar, (evnt_t*)pEvent->LChild );
+            CEventPool::SerializeEvent( ar, pEvent );
+            if( pEvent->RChild ) SaveEventChain( ar, (evnt_t*)pEvent->RChild );
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       evnt_t* RemoveNextEvent( time_t limit )
+        // PURPOSE:      Removes the earliest Event from the timing wheel 
+        //               or from the AVL tree, if its timestamp is not 
+        //               after 'limit'.  Of Events with equal timestamps, 
+        //               those in the wheel were registered later (the 
+        //               wheel's horizon only moves forward), so they 
+        //               are taken first.
+        // ARGUMENTS:    limit  - latest timestamp to be returned
+        // RETURN VALUE: pointer to the Event or NULL
+        /////////////////////////////////////////////////////////////////
+        inline evnt_t* RemoveNextEvent( time_t limit )
+        {
+            evnt_t* pTree = (evnt_t*) AVL::AVLTree<time_t>::GetHead();
+            if( pTree && pTree->ACTIVATION_TIME <= limit )
+                limit = pTree->ACTIVATION_TIME;
+            else
+                pTree = NULL;
+
+            evnt_t* pEvent = eqWheel.GetHead( limit );
+            if( pEvent )
+                return eqWheel.RemoveHead( pEvent );
+
+            return pTree? (evnt_t*) AVL::AVLTree<time_t>::RemoveHead(): NULL;
         }
 
     /////////////////////////////////////////////////////////////////////
     public:
     /////////////////////////////////////////////////////////////////////
-        CEventQueue()                 { eqCurrentTime = 0; }
+        CEventQueue()                 
+        { 
+            eqCurrentTime = 0; 
+        }
         /*virtual*/ ~CEventQueue()    { DeleteEvents();    }
 
         /////////////////////////////////////////////////////////////////
         // METHOD:       int32u GetCount( void )
         // PURPOSE:      
         // ARGUMENTS:
-        // RETURN VALUE: Number of all events waiting in the AVL tree and 
-        //               in eqTopEvents stack.
+        // RETURN VALUE: Number of all events waiting in the AVL tree, 
+        //               in the timing wheel, and in eqTopEvents stack.
         /////////////////////////////////////////////////////////////////
         inline int32u GetCount( void ) const
         { 
-            return AVL::AVLTree<time_t>::Count + eqTopEvents.GetCount(); 
+            return AVL::AVLTree<time_t>::Count + eqWheel.GetCount() + eqTopEvents.GetCount(); 
         }
 
         /////////////////////////////////////////////////////////////////
         // METHOD:       void Reset( void )
-        // PURPOSE:      Moves all events from AVL tree and from the stack 
-        //               of immediate events (eqTopEvents) to the pool of 
-        //               free events (eqEventPool).
+        // PURPOSE:      Moves all events from AVL tree, from the timing 
+        //               wheel, and from the stack of immediate events 
+        //               (eqTopEvents) to the pool of free events 
+        //               (CEventPool::eqEventPool).
         //               Also reset system time.
         // ARGUMENTS:
         // RETURN VALUE:
@@ -202,11 +511,16 @@ public:
             {
                 // move Events from AVL tree to free Event pool 
                 ClearEventChain( (evnt_t*)AVL::AVLTree<time_t>::pRoot );
-                AVL::AVLTree<time_t>::pRoot = NULL;
+                AVL::AVLTree<time_t>::Clear();
             }
 
+            // move Events from the timing wheel to free Event pool 
+            while( evnt_t* pEvent = eqWheel.RemoveAny())
+                CEventPool::eqEventPool.Push( pEvent );
+            eqWheel.Clear( 0 );
+
             // push TopEvents on top of EventPool */
-            eqEventPool.Combine( &eqTopEvents );       
+            CEventPool::eqEventPool.Combine( &eqTopEvents );       
         }
 
         /////////////////////////////////////////////////////////////////
@@ -220,26 +534,7 @@ public:
         void DeleteEvents( void )
         {
             Reset();
-            while( eqEventPool.GetCount() > 0 )  delete eqEventPool.Pop();
-        }
-    
-        /////////////////////////////////////////////////////////////////
-        // METHOD:       evnt_t* AllocateEvent(void)
-        // PURPOSE:      Get a pointer to a free Event.  If free Event 
-        //               pool is not empty, get Event from there, 
-        //               otherwise allocate new Event from the heap. 
-        //               This is the only place where Events may be
-        //               created (memory allocated)
-        // ARGUMENTS:
-        // RETURN VALUE: pointer to a free Event (CEvent*)
-        /////////////////////////////////////////////////////////////////
-        inline evnt_t* AllocateEvent(void)
-        {  
-            evnt_t* pEvent = eqEventPool.GetCount()? eqEventPool.Pop(): new evnt_t; 
-
-            _ASSERT( pEvent != NULL ); 
-            pEvent->Activate();
-            return pEvent;
+            CEventPool::DeleteBlocks();
         }
     
         /////////////////////////////////////////////////////////////////
@@ -248,8 +543,9 @@ public:
         // PURPOSE:      Assign timestamp to Event and register the Event 
         //               in the Event queue. If Event's timestamp is the 
         //               same as current system time, push it onto 
-        //               eqTopEvents stack, otherwise insert it into AVL 
-        //               tree.
+        //               eqTopEvents stack, otherwise insert it into the 
+        //               timing wheel, or into AVL tree if it is beyond 
+        //               the wheel's horizon.
         // ARGUMENTS:    pEvent     - pointer to the Event
         //               interval   - interval from the current time 
         //                            till Event's occurence
@@ -264,22 +560,22 @@ public:
 
                 pEvent->ACTIVATION_TIME = eqCurrentTime + interval;
 
-                if( interval == 0 ) eqTopEvents.Push( pEvent );
-                else                AVL::AVLTree<time_t>::AddNode( pEvent );
+                if( interval == 0 )                 eqTopEvents.Push( pEvent );
+                else if( !eqWheel.Insert( pEvent )) AVL::AVLTree<time_t>::AddNode( pEvent );
             }
         }
 
         /////////////////////////////////////////////////////////////////
         // METHOD:       evnt_t* GetNextEvent( void )
         // PURPOSE:      Gets next Event from the eqTopEvents if it is 
-        //               not empty, or from AVL tree otherwise.  Then  
-        //               updates system time.
+        //               not empty, or from the timing wheel or AVL tree 
+        //               otherwise.  Then updates system time.
         // ARGUMENTS:    
         // RETURN VALUE: pointer to the next Event (CEvent*)
         /////////////////////////////////////////////////////////////////
         inline evnt_t* GetNextEvent( void )  
         { 
-            evnt_t* pEvent = eqTopEvents.GetCount() ? eqTopEvents.Pop() : (evnt_t*) AVL::AVLTree<time_t>::RemoveHead();//RemoveHead();
+            evnt_t* pEvent = eqTopEvents.GetCount() ? eqTopEvents.Pop() : RemoveNextEvent( std::numeric_limits< time_t >::max());
         
             if( pEvent ) 
             {
@@ -298,31 +594,468 @@ public:
         inline time_t GetCurrentTime( void ) const { return eqCurrentTime; }
 
         /////////////////////////////////////////////////////////////////
-        // METHOD:       void CancelEvent( evnt_t* pEvent )
-        // PURPOSE:      Will invalidate the Event by setting its 
-        //               consumer to NULL.  This Event will not be 
-        //               removed from the AVL tree. 
-        // ARGUMENTS:    pEvent - Event to be canceled
+        // METHOD:       void Serialize( Archive& ar )
+        // PURPOSE:      Writes or reads system time and all pending 
+        //               events.  The immediate events are stored from 
+        //               top to bottom, then the timing wheel slot by 
+        //               slot (each slot in the order of dispatching), 
+        //               and then the AVL tree in order.  All are 
+        //               restored in reverse, so that events with equal 
+        //               timestamps are dispatched in the same order as 
+        //               in the saved simulation.
+        //               Every restored event is announced to its 
+        //               consumer through CBase::EventRestored().
+        // ARGUMENTS:    
         // RETURN VALUE: 
         /////////////////////////////////////////////////////////////////
-        inline void CancelEvent( evnt_t* pEvent )   
+        void Serialize( Archive& ar )
+        {
+            int32u   top_count  = eqTopEvents.GetCount();
+            int32u   tree_count = AVL::AVLTree<time_t>::Count + eqWheel.GetCount();
+            time_t   cur_time   = eqCurrentTime;
+
+            ar & cur_time & top_count & tree_count;
+
+            if( ar.IsWriting() )
+            {
+                for( evnt_t* ptr = eqTopEvents.GetTop(); ptr; ptr = ptr->GetNext() )
+                    CEventPool::SerializeEvent( ar, ptr );
+
+                for( int32s level = 0; level < eqWheel.GetLevels(); level++ )
+                    for( int32s slot = 0; slot < eqWheel.GetSlots(); slot++ )
+                        for( evnt_t* ptr = eqWheel.GetSlot( level, slot ); ptr; ptr = ptr->GetNext() )
+                            CEventPool::SerializeEvent( ar, ptr );
+
+                if( AVL::AVLTree<time_t>::pRoot )
+                    SaveEventChain( ar, (evnt_t*)AVL::AVLTree<time_t>::pRoot );
+                return;
+            }
+
+            if( !ar.IsGood() )
+                return;
+
+            Reset();
+            eqCurrentTime = cur_time;
+            eqWheel.Clear( cur_time );
+
+            evnt_t** top  = CEventPool::LoadEvents( ar, top_count );
+            evnt_t** tree = CEventPool::LoadEvents( ar, tree_count );
+            int32u   n;
+
+            for( n = top_count; n > 0; n-- )   eqTopEvents.Push( top[ n - 1 ] );
+            for( n = tree_count; n > 0; n-- )
+                if( !eqWheel.Insert( tree[ n - 1 ] )) AVL::AVLTree<time_t>::AddNode( tree[ n - 1 ] );
+
+            for( n = 0; n < top_count; n++ )
+                if( top[n]->Consumer ) top[n]->Consumer->EventRestored( top[n] );
+
+            for( n = 0; n < tree_count; n++ )
+                if( tree[n]->Consumer ) tree[n]->Consumer->EventRestored( tree[n] );
+
+            delete [] top;
+            delete [] tree;
+        }
+    };
+
+
+
+
+    /////////////////////////////////////////////////////////////////////
+    // CLASS:        class CObjectQueue
+    // PURPOSE:      Event queue with the same interface and the same 
+    //               order of Events as CEventQueue, selected by 
+    //               defining DESL_OBJECT_QUEUE.  Each object (Event 
+    //               consumer) has its own list of pending Events 
+    //               sorted by time, and a tournament tree over the 
+    //               objects selects the object with the earliest 
+    //               Event.  Taking the next Event costs O(log N) in 
+    //               the number of objects N, independent of the 
+    //               number of pending Events.
+    // NOTES:        Objects are identified by handle (CObjRef), which 
+    //               indexes the lists and the leaves of the tree.  An 
+    //               Event stays in the list of the consumer it had 
+    //               when registered, even if it is canceled.
+    //               Events with equal timestamps are ordered by 
+    //               registration number (last registered first), 
+    //               which is kept in the event (SetOrder()).
+    //               Immediate Events are kept in a stack as in 
+    //               CEventQueue.
+    /////////////////////////////////////////////////////////////////////
+    class CObjectQueue : public CEventPool
+    {
+    /////////////////////////////////////////////////////////////////////
+    private:
+    /////////////////////////////////////////////////////////////////////
+        struct Entry                        // node of the tournament tree
+        {
+            time_t      Time;               // earliest Event of the subtree
+            uintptr_t   Order;              //  (registration number)
+            int32u      Leaf;               // object of the Event
+        };
+
+        time_t           oqCurrentTime;     // system time 
+        Stack< evnt_t >  oqTopEvents;       // immediate events 
+        evnt_t**         oqHead;            // earliest Event of each object
+        evnt_t**         oqTail;            // latest Event of each object
+        Entry*           oqTree;            // tournament tree, root at 1, 
+        int32u           oqLeaves;          // leaves at oqLeaves + handle
+        int32u           oqCount;           // Events in the lists
+        uintptr_t        oqOrder;           // registration counter
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       BOOL Before( const Entry& a, const Entry& b )
+        // PURPOSE:      Compares Events: earlier timestamp first, then 
+        //               later registration first.  Registration numbers 
+        //               are compared modulo the word size.
+        // ARGUMENTS:
+        // RETURN VALUE: TRUE if 'a' is dispatched before 'b'
+        /////////////////////////////////////////////////////////////////
+        static inline BOOL Before( const Entry& a, const Entry& b )
+        {
+            return a.Time < b.Time || ( a.Time == b.Time && (intptr_t)( a.Order - b.Order ) > 0 );
+        }
+
+        static inline BOOL Before( evnt_t* a, evnt_t* b )
+        {
+            return a->ACTIVATION_TIME < b->ACTIVATION_TIME || 
+                 ( a->ACTIVATION_TIME == b->ACTIVATION_TIME && (intptr_t)( a->GetOrder() - b->GetOrder()) > 0 );
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       void SetLeaf( int32u leaf )
+        // PURPOSE:      Sets the leaf of the tournament tree to the 
+        //               earliest Event of the object (or to the end of 
+        //               time, if there is none)
+        // ARGUMENTS:
+        // RETURN VALUE:
+        /////////////////////////////////////////////////////////////////
+        inline void SetLeaf( int32u leaf )
+        {
+            Entry&  entry  = oqTree[ oqLeaves + leaf ];
+            evnt_t* pEvent = oqHead[ leaf ];
+
+            entry.Time  = pEvent? pEvent->ACTIVATION_TIME: std::numeric_limits< time_t >::max();
+            entry.Order = pEvent? pEvent->GetOrder(): 0;
+            entry.Leaf  = leaf;
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       void UpdateLeaf( int32u leaf )
+        // PURPOSE:      Sets the leaf and replays the matches on its 
+        //               path to the root, until a match has the same 
+        //               winner as before
+        // ARGUMENTS:
+        // RETURN VALUE:
+        /////////////////////////////////////////////////////////////////
+        inline void UpdateLeaf( int32u leaf )
+        {
+            SetLeaf( leaf );
+
+            for( int32u node = ( oqLeaves + leaf ) >> 1; node; node >>= 1 )
+            {
+                const Entry& left  = oqTree[ 2 * node ];
+                const Entry& right = oqTree[ 2 * node + 1 ];
+                const Entry& win   = Before( right, left )? right: left;
+
+                if( win.Leaf == oqTree[ node ].Leaf && win.Time == oqTree[ node ].Time && win.Order == oqTree[ node ].Order )
+                    break;
+                oqTree[ node ] = win;
+            }
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       void Resize( int32u leaves )
+        // PURPOSE:      Makes room for 'leaves' objects (a power of 2) 
+        //               and rebuilds the tournament tree
+        // ARGUMENTS:
+        // RETURN VALUE:
+        /////////////////////////////////////////////////////////////////
+        void Resize( int32u leaves )
+        {
+            evnt_t** head = new evnt_t*[ leaves ];
+            evnt_t** tail = new evnt_t*[ leaves ];
+
+            memset( head, 0, leaves * sizeof( evnt_t* ));
+            memset( tail, 0, leaves * sizeof( evnt_t* ));
+            if( oqLeaves )
+            {
+                memcpy( head, oqHead, oqLeaves * sizeof( evnt_t* ));
+                memcpy( tail, oqTail, oqLeaves * sizeof( evnt_t* ));
+            }
+
+            delete [] oqHead;
+            delete [] oqTail;
+            delete [] oqTree;
+
+            oqHead   = head;
+            oqTail   = tail;
+            oqTree   = new Entry[ 2 * leaves ];
+            oqLeaves = leaves;
+
+            for( int32u leaf = 0; leaf < oqLeaves; leaf++ )
+                SetLeaf( leaf );
+
+            for( int32u node = oqLeaves - 1; node > 0; node-- )
+                oqTree[ node ] = Before( oqTree[ 2 * node + 1 ], oqTree[ 2 * node ] )? oqTree[ 2 * node + 1 ]: oqTree[ 2 * node ];
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       void InsertEvent( evnt_t* pEvent )
+        // PURPOSE:      Inserts the Event into the list of its consumer. 
+        //               The list is searched from the latest Event, 
+        //               as most Events are later than all pending 
+        //               Events of the same object.
+        // ARGUMENTS:
+        // RETURN VALUE:
+        /////////////////////////////////////////////////////////////////
+        inline void InsertEvent( evnt_t* pEvent )
+        {
+            int32u leaf = pEvent->Consumer.GetHandle();
+
+            if( leaf >= oqLeaves )
+            {
+                int32u leaves = MAX< int32u >( oqLeaves, 64 );
+                while( leaves <= leaf ) leaves *= 2;
+                Resize( leaves );
+            }
+
+            pEvent->SetOrder( ++oqOrder );
+
+            evnt_t* pPrev = oqTail[ leaf ];
+            while( pPrev && !Before( pPrev, pEvent ))
+                pPrev = pPrev->GetPrev();
+
+            evnt_t* pNext = pPrev? pPrev->GetNext(): oqHead[ leaf ];
+
+            pEvent->SetPrev( pPrev );
+            pEvent->SetNext( pNext );
+
+            if( pNext ) pNext->SetPrev( pEvent );   else oqTail[ leaf ] = pEvent;
+            if( pPrev ) pPrev->SetNext( pEvent );
+            else
+            {
+                oqHead[ leaf ] = pEvent;
+                UpdateLeaf( leaf );
+            }
+            oqCount++;
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       evnt_t* RemoveNextEvent( time_t limit )
+        // PURPOSE:      Removes the earliest Event of all objects, if 
+        //               its timestamp is not after 'limit'
+        // ARGUMENTS:    limit  - latest timestamp to be returned
+        // RETURN VALUE: pointer to the Event or NULL
+        /////////////////////////////////////////////////////////////////
+        inline evnt_t* RemoveNextEvent( time_t limit )
+        {
+            if( oqCount == 0 || oqTree[1].Time > limit )
+                return NULL;
+
+            int32u  leaf   = oqTree[1].Leaf;
+            evnt_t* pEvent = oqHead[ leaf ];
+            evnt_t* pNext  = pEvent->GetNext();
+
+            oqHead[ leaf ] = pNext;
+            if( pNext ) pNext->SetPrev( NULL );   else oqTail[ leaf ] = NULL;
+
+            UpdateLeaf( leaf );
+            oqCount--;
+            return pEvent;
+        }
+
+    /////////////////////////////////////////////////////////////////////
+    public:
+    /////////////////////////////////////////////////////////////////////
+        CObjectQueue()
+        {
+            oqCurrentTime = 0;
+            oqHead        = NULL;
+            oqTail        = NULL;
+            oqTree        = NULL;
+            oqLeaves      = 0;
+            oqCount       = 0;
+            oqOrder       = 0;
+        }
+        /*virtual*/ ~CObjectQueue()   { DeleteEvents();    }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       int32u GetCount( void )
+        // PURPOSE:      
+        // ARGUMENTS:
+        // RETURN VALUE: Number of all events waiting in the lists of 
+        //               objects and in oqTopEvents stack.
+        /////////////////////////////////////////////////////////////////
+        inline int32u GetCount( void ) const
         { 
-            if( pEvent ) pEvent->Consumer = NULL; 
+            return oqCount + oqTopEvents.GetCount(); 
         }
 
         /////////////////////////////////////////////////////////////////
-        // METHOD:       void DestroyEvent( evnt_t* pEvent )
-        // PURPOSE:      Returns Event to the pool of free Events. It is 
-        //               assumed that the Event was previously removed 
-        //               from the Event queue, and from the eqEventPool 
-        //               and eqTopEvents stacks
+        // METHOD:       void Reset( void )
+        // PURPOSE:      Moves all events to the pool of free events and 
+        //               resets system time.
+        // ARGUMENTS:
+        // RETURN VALUE:
+        /////////////////////////////////////////////////////////////////
+        void Reset( void )
+        {
+            oqCurrentTime = 0;
+            oqOrder       = 0;
+
+            for( int32u leaf = 0; leaf < oqLeaves && oqCount; leaf++ )
+            {
+                while( evnt_t* pEvent = oqHead[ leaf ] )
+                {
+                    oqHead[ leaf ] = pEvent->GetNext();
+                    CEventPool::eqEventPool.Push( pEvent );
+                    oqCount--;
+                }
+                oqTail[ leaf ] = NULL;
+                UpdateLeaf( leaf );
+            }
+
+            // push TopEvents on top of EventPool */
+            CEventPool::eqEventPool.Combine( &oqTopEvents );       
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       void DeleteEvents( void )
+        // PURPOSE:      After moving all Events to the free pool, delete 
+        //               them and the tournament tree.
+        // ARGUMENTS:
+        // RETURN VALUE:
+        /////////////////////////////////////////////////////////////////
+        void DeleteEvents( void )
+        {
+            Reset();
+            CEventPool::DeleteBlocks();
+
+            delete [] oqHead;
+            delete [] oqTail;
+            delete [] oqTree;
+
+            oqHead   = NULL;
+            oqTail   = NULL;
+            oqTree   = NULL;
+            oqLeaves = 0;
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       void RegisterEvent( evnt_t* pEvent, 
+        //                                   time_t interval )
+        // PURPOSE:      Assign timestamp to Event and register the Event 
+        //               in the Event queue. If Event's timestamp is the 
+        //               same as current system time, push it onto 
+        //               oqTopEvents stack, otherwise insert it into the 
+        //               list of its consumer.
+        // ARGUMENTS:    pEvent     - pointer to the Event
+        //               interval   - interval from the current time 
+        //                            till Event's occurence
+        // RETURN VALUE: 
+        /////////////////////////////////////////////////////////////////
+        inline void RegisterEvent( evnt_t* pEvent, time_t interval )  
+        { 
+            if( pEvent && pEvent->IsActive())
+            {
+                if( interval < 0 )
+                    interval = 0;     /* no going back in time... */
+
+                pEvent->ACTIVATION_TIME = oqCurrentTime + interval;
+
+                if( interval == 0 ) oqTopEvents.Push( pEvent );
+                else                InsertEvent( pEvent );
+            }
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       evnt_t* GetNextEvent( void )
+        // PURPOSE:      Gets next Event from the oqTopEvents if it is 
+        //               not empty, or the earliest Event of all objects 
+        //               otherwise.  Then updates system time.
         // ARGUMENTS:    
         // RETURN VALUE: pointer to the next Event (CEvent*)
         /////////////////////////////////////////////////////////////////
-        inline void DestroyEvent( evnt_t* pEvent )  
+        inline evnt_t* GetNextEvent( void )  
         { 
-            if( pEvent && pEvent->IsActive())
-                eqEventPool.Push( pEvent ); 
+            evnt_t* pEvent = oqTopEvents.GetCount() ? oqTopEvents.Pop() : RemoveNextEvent( std::numeric_limits< time_t >::max());
+        
+            if( pEvent ) 
+            {
+                oqCurrentTime = pEvent->ACTIVATION_TIME;  // update global time
+                pEvent->Activate();
+            }
+            return pEvent;
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       time_t GetCurrentTime( void )
+        // PURPOSE:      
+        // ARGUMENTS:    
+        // RETURN VALUE: 
+        /////////////////////////////////////////////////////////////////
+        inline time_t GetCurrentTime( void ) const { return oqCurrentTime; }
+
+        /////////////////////////////////////////////////////////////////
+        // METHOD:       void Serialize( Archive& ar )
+        // PURPOSE:      Writes or reads system time and all pending 
+        //               events in the same format as CEventQueue: the 
+        //               immediate events from top to bottom, then all 
+        //               other events in the order of dispatching.  All 
+        //               are restored in reverse.
+        // ARGUMENTS:    
+        // RETURN VALUE: 
+        /////////////////////////////////////////////////////////////////
+        void Serialize( Archive& ar )
+        {
+            int32u   top_count  = oqTopEvents.GetCount();
+            int32u   tree_count = oqCount;
+            time_t   cur_time   = oqCurrentTime;
+            int32u   n;
+
+            ar & cur_time & top_count & tree_count;
+
+            if( ar.IsWriting() )
+            {
+                for( evnt_t* ptr = oqTopEvents.GetTop(); ptr; ptr = ptr->GetNext() )
+                    CEventPool::SerializeEvent( ar, ptr );
+
+                evnt_t** events = new evnt_t*[ tree_count + 1 ];
+                evnt_t** last   = events;
+
+                for( int32u leaf = 0; leaf < oqLeaves; leaf++ )
+                    for( evnt_t* ptr = oqHead[ leaf ]; ptr; ptr = ptr->GetNext() )
+                        *last++ = ptr;
+
+                std::sort( events, last, []( evnt_t* a, evnt_t* b ) { return Before( a, b ); } );
+
+                for( n = 0; n < tree_count; n++ )
+                    CEventPool::SerializeEvent( ar, events[n] );
+
+                delete [] events;
+                return;
+            }
+
+            if( !ar.IsGood() )
+                return;
+
+            Reset();
+            oqCurrentTime = cur_time;
+
+            evnt_t** top  = CEventPool::LoadEvents( ar, top_count );
+            evnt_t** tree = CEventPool::LoadEvents( ar, tree_count );
+
+            for( n = top_count; n > 0; n-- )   oqTopEvents.Push( top[ n - 1 ] );
+            for( n = tree_count; n > 0; n-- )  InsertEvent( tree[ n - 1 ] );
+
+            for( n = 0; n < top_count; n++ )
+                if( top[n]->Consumer ) top[n]->Consumer->EventRestored( top[n] );
+
+            for( n = 0; n < tree_count; n++ )
+                if( tree[n]->Consumer ) tree[n]->Consumer->EventRestored( tree[n] );
+
+            delete [] top;
+            delete [] tree;
         }
     };
 
@@ -338,11 +1071,13 @@ public:
     {
         friend class PDList< CBase >;
         friend class DESL_QUALIFIER;
+        friend class CObjRef;
     /////////////////////////////////////////////////////////////////////
     private:
     /////////////////////////////////////////////////////////////////////
         base_t* pPrev;   // pointer to a previous base object
         base_t* pNext;   // pointer to a next base object
+        int32u  Handle;  // index in the table of objects (CObjRef)
 
     /////////////////////////////////////////////////////////////////////
     protected:
@@ -363,11 +1098,13 @@ public:
             ID = id;
             pPrev = pNext = NULL; 
             DESL_OBJ.Append( this );  // regiser new object
+            Handle = AddToTable( this );
         }
         /////////////////////////////////////////////////////////////////
         virtual~ CBase()         
         { 
             DESL_OBJ.Remove( this );  // unregiser object
+            RemoveFromTable( Handle );
         }
         /////////////////////////////////////////////////////////////////
 
@@ -376,6 +1113,12 @@ public:
         virtual void  ProcessEvent( evnt_t* )  = 0; // { return FALSE;    }
         virtual void  Free( void )             = 0; // { /* do nothing */ }
         virtual void  Reset( void )            = 0; // { /* do nothing */ }
+
+        // The following functions are used to checkpoint the simulation.  
+        // Serialize() writes or reads the object state, EventRestored() 
+        // is called for each event restored with this object as consumer 
+        virtual void  Serialize( Archive& )    {}
+        virtual void  EventRestored( evnt_t* ) {}
     };
 
 
@@ -386,9 +1129,71 @@ private:
     /////////////////////////////////////////////////////////////////////
     // Declare private static members
     /////////////////////////////////////////////////////////////////////
-    static CEventQueue      DESL_EQ;   // Event queue   
+#if defined( DESL_OBJECT_QUEUE )
+    typedef CObjectQueue    queue_t;
+#else
+    typedef CEventQueue     queue_t;
+#endif
+    static queue_t          DESL_EQ;   // Event queue   
     static PDList< CBase >  DESL_OBJ;  // Doubly-linked list of all objects 
                                        // derived from CBase  
+    static base_t*          DESL_NULL_TABLE[1];
+    static base_t**         DESL_TABLE;          // table of objects by handle, 
+    static int32u           DESL_TABLE_SIZE;     // entry 0 is always NULL
+    static int32u           DESL_TABLE_FREE;     // no free entry below this one
+
+    /////////////////////////////////////////////////////////////////////
+    // METHOD:       int32u AddToTable( base_t* ptr )
+    // PURPOSE:      Puts the object into the first free entry of the 
+    //               table of objects; the table grows by doubling
+    // ARGUMENTS:    
+    // RETURN VALUE: handle of the object
+    /////////////////////////////////////////////////////////////////////
+    static int32u AddToTable( base_t* ptr )
+    {
+        int32u handle = MAX< int32u >( DESL_TABLE_FREE, 1 );
+        while( handle < DESL_TABLE_SIZE && DESL_TABLE[ handle ] )
+            handle++;
+
+        if( handle >= DESL_TABLE_SIZE )
+        {
+            int32u   size  = MAX< int32u >( DESL_TABLE_SIZE * 2, 64 );
+            base_t** table = new base_t*[ size ];
+
+            memset( table, 0, size * sizeof( base_t* ));
+            memcpy( table, DESL_TABLE, DESL_TABLE_SIZE * sizeof( base_t* ));
+            if( DESL_TABLE != DESL_NULL_TABLE )
+                delete [] DESL_TABLE;
+
+            DESL_TABLE      = table;
+            DESL_TABLE_SIZE = size;
+        }
+
+        DESL_TABLE[ handle ] = ptr;
+        DESL_TABLE_FREE      = handle + 1;
+        return handle;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // METHOD:       void RemoveFromTable( int32u handle )
+    // PURPOSE:      Frees the entry of the table of objects; the table 
+    //               is deleted together with the last object
+    // ARGUMENTS:    
+    // RETURN VALUE: 
+    /////////////////////////////////////////////////////////////////////
+    static void RemoveFromTable( int32u handle )
+    {
+        DESL_TABLE[ handle ] = NULL;
+        DESL_TABLE_FREE      = MIN< int32u >( DESL_TABLE_FREE, handle );
+
+        if( DESL_OBJ.GetCount() == 0 && DESL_TABLE != DESL_NULL_TABLE )
+        {
+            delete [] DESL_TABLE;
+            DESL_TABLE      = DESL_NULL_TABLE;
+            DESL_TABLE_SIZE = 1;
+            DESL_TABLE_FREE = 1;
+        }
+    }
 
     /////////////////////////////////////////////////////////////////////
     // METHOD:       void ExecuteAllObjects( void (base_t::*pfun)(void) )
@@ -424,6 +1229,30 @@ public:
     /////////////////////////////////////////////////////////////////////
     static inline int32s GetObjCount( void ) { return DESL_OBJ.GetCount(); }
 
+    /////////////////////////////////////////////////////////////////////
+    // METHOD:       BOOL GlobalSerialize( Archive& ar )
+    // PURPOSE:      Writes or reads the state of all registered objects 
+    //               and of the Event queue.  When reading, the same 
+    //               objects must already be created in the same order, 
+    //               so that they have the same handles.
+    // ARGUMENTS:    
+    // RETURN VALUE: TRUE on success
+    /////////////////////////////////////////////////////////////////////
+    static BOOL GlobalSerialize( Archive& ar )
+    {
+        ar.Check( GetObjCount() );
+
+        for( base_t* ptr = DESL_OBJ.GetHead(); ptr && ar.IsGood(); ptr = ptr->GetNext() )
+        {
+            ar.Check( ptr->ID );
+            ar.Check( ptr->Handle );
+            ptr->Serialize( ar );
+        }
+
+        DESL_EQ.Serialize( ar );
+        return ar.IsGood();
+    }
+
     /////////////////////////////////////////////////////////////////////
     // METHOD:       void GlobalReset( void )
     // PURPOSE:      Resets the Event queue and all registered objects
@@ -457,6 +1286,8 @@ public:
     static inline evnt_t* AllocateEvent( void )     { return DESL_EQ.AllocateEvent();  }
     static inline void    DestroyEvent( evnt_t* p ) { DESL_EQ.DestroyEvent( p );       }
     static inline void    CancelEvent( evnt_t* p )  { DESL_EQ.CancelEvent( p );        }
+    static inline void    HoldEvent( evnt_t* p )    { DESL_EQ.HoldEvent( p );          }
+    static inline void    ReleaseEvent( evnt_t* p ) { DESL_EQ.ReleaseEvent( p );       }
     static inline evnt_t* GetNextEvent( void )      { return DESL_EQ.GetNextEvent();   }
 
     /////////////////////////////////////////////////////////////////////
@@ -464,7 +1295,7 @@ public:
     // PURPOSE:      Dispatches the event to event's consumer 
     //               An event is considered consumed by the consumer
     //               if the consumer either Registers the event again, 
-    //               or destroys it.
+    //               holds it (HoldEvent), or destroys it.
     //               if Event was not consumed by the consumer, 
     //               in will be destroyed by the DispatchEvent function
     /////////////////////////////////////////////////////////////////////
@@ -505,7 +1336,11 @@ public:
 /////////////////////////////////////////////////////////////////////////
 
 template<class TIME_T,class DATA_T> PDList<typename DESL_QUALIFIER::CBase> DESL_QUALIFIER::DESL_OBJ;
-template<class TIME_T,class DATA_T> typename DESL_QUALIFIER::CEventQueue   DESL_QUALIFIER::DESL_EQ;
+template<class TIME_T,class DATA_T> typename DESL_QUALIFIER::queue_t       DESL_QUALIFIER::DESL_EQ;
+template<class TIME_T,class DATA_T> typename DESL_QUALIFIER::base_t*       DESL_QUALIFIER::DESL_NULL_TABLE[1] = { NULL };
+template<class TIME_T,class DATA_T> typename DESL_QUALIFIER::base_t**      DESL_QUALIFIER::DESL_TABLE = DESL_QUALIFIER::DESL_NULL_TABLE;
+template<class TIME_T,class DATA_T> int32u                                 DESL_QUALIFIER::DESL_TABLE_SIZE = 1;
+template<class TIME_T,class DATA_T> int32u                                 DESL_QUALIFIER::DESL_TABLE_FREE = 1;
 /////////////////////////////////////////////////////////////////////////
 
 #endif   // _DESL_H_V003_INCLUDED_ 
\ No newline at end of file
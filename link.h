@@ -5,6 +5,7 @@
  *              class LossLessLink
  *              class LossyLink
  *              class BiDirLink
+ *              class Splitter
  *              class JitterLink
  *
  * Author: Glen Kramer (kramer@cs.ucdavis.edu)
@@ -44,6 +45,9 @@ public:
     ///////////////////////////////////////////////////////////////////////////
     inline void          SetDelay( DESL::time_t dly )     { Delay = dly;  }
     inline DESL::time_t  GetDelay( void ) const           { return Delay; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    virtual void Serialize( Archive& ar )  { SimBase<>::Serialize( ar ); ar & Delay; }
 };
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -66,6 +70,9 @@ public:
     {
         if( _uniform_real_0_1() > LossProb ) LossLessLink::ProcessEvent( pEvent );
     } 
+
+    ///////////////////////////////////////////////////////////////////////////
+    virtual void Serialize( Archive& ar )  { LossLessLink::Serialize( ar ); ar & LossProb; }
 };
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -99,6 +106,63 @@ public:
     ///////////////////////////////////////////////////////////////////////////
     inline void          SetDelay( DESL::time_t dly )  { Delay = dly;  }
     inline DESL::time_t  GetDelay( void ) const        { return Delay; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    virtual void Serialize( Archive& ar )  { SimBase< 2 >::Serialize( ar ); ar & Delay; }
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+//
+// Passive splitter of the downstream channel.  A frame sent by the OLT reaches 
+// every ONU, at the time it leaves the OLT plus the delay of that ONU's fiber 
+// (port).  All ONUs but the one of the frame's LLID discard it, so the splitter 
+// does not copy the frame: the single EV_PCKT_BROADCAST event is redirected to 
+// the port of Pckt.LLID only.
+//
+////////////////////////////////////////////////////////////////////////////////////
+
+class Splitter : public SimBase< DYNAMIC_PORTS >
+{
+private:
+    DESL::time_t* Delay;                    // delay to the ONU of each port
+
+public:
+
+    Splitter( DESL::obid_t id, int16u ports ) : SimBase< DYNAMIC_PORTS >( id, ports )  
+    {
+        Delay = new DESL::time_t[ ports ];
+        memset( Delay, 0, ports * sizeof( DESL::time_t ));
+    } 
+
+    virtual ~Splitter()             { delete [] Delay; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    virtual void  Free( void )      {}
+    virtual void  Reset( void )     {}
+    
+    ///////////////////////////////////////////////////////////////////////////
+    virtual void ProcessEvent( DESL::evnt_t* pEvent ) 
+    {
+        _ASSERT( pEvent->Pckt.LLID < GetPortCount() );
+
+        /* deliver the frame to its LLID only */
+        pEvent->Consumer = OutPort[ pEvent->Pckt.LLID ];
+        RegisterEvent( pEvent, Delay[ pEvent->Pckt.LLID ] );
+    }    
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void          SetDelay( int16u port, DESL::time_t dly )  { _ASSERT( port < GetPortCount() ); Delay[ port ] = dly;  }
+    inline DESL::time_t  GetDelay( int16u port ) const              { _ASSERT( port < GetPortCount() ); return Delay[ port ]; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    virtual void Serialize( Archive& ar )  
+    { 
+        SimBase< DYNAMIC_PORTS >::Serialize( ar ); 
+        ar.Raw( Delay, GetPortCount() * sizeof( DESL::time_t )); 
+    }
 };
 
 
@@ -137,6 +201,9 @@ public:
         pEvent->Consumer = OutPort[0];              // redirect the event    
         RegisterEvent( pEvent, Delay + Jitter() );  // register with 'Delay' 
     } 
+
+    ///////////////////////////////////////////////////////////////////////////
+    virtual void Serialize( Archive& ar )  { SimBase<>::Serialize( ar ); ar & Delay & LastEvent; }
     
     ///////////////////////////////////////////////////////////////////////////
 };
@@ -19,11 +19,17 @@
 **               with one or more output port/interface, i.e.,  
 **               switches, splitters, etc. 
 **
-** PARAMETERS:   PORTS - number of output ports/interfaces
+** PARAMETERS:   PORTS - number of output ports/interfaces, or 
+**                       DYNAMIC_PORTS if the number of ports is 
+**                       known only at run time
 **
-** NOTES:      
+** NOTES:        Elements with a fixed number of ports keep the port 
+**               table in the object; the number of ports is a 
+**               compile-time constant.
 ********************************************************************/
 
+const int16u DYNAMIC_PORTS = 0;
+
 template < int16u PORTS = 1 > class MultiPort 
 {
 
@@ -35,8 +41,10 @@ protected:
 /*******************************************************************/
 public:
 /*******************************************************************/
-    MultiPort()
+    MultiPort( int16u ports = PORTS )
     {
+        (void) ports;
+        _ASSERT( ports == PORTS );
         memset( OutPort, 0, PORTS * sizeof( DESL::base_t* ));
     }
 
@@ -56,6 +64,50 @@ public:
     }
 };
 
+/*******************************************************************
+** CLASS:        class MultiPort< DYNAMIC_PORTS >
+** PURPOSE:      Network element with the number of ports given 
+**               to the constructor
+**
+** NOTES:        The port table is allocated in one block.
+********************************************************************/
+template <> class MultiPort< DYNAMIC_PORTS > 
+{
+
+/*******************************************************************/
+protected:
+/*******************************************************************/
+    DESL::base_t** OutPort;
+    int16u         Ports;
+
+/*******************************************************************/
+public:
+/*******************************************************************/
+    MultiPort( int16u ports )
+    {
+        Ports   = ports;
+        OutPort = new DESL::base_t*[ Ports ];
+        memset( OutPort, 0, Ports * sizeof( DESL::base_t* ));
+    }
+
+    ~MultiPort()                                    { delete [] OutPort; }
+
+    /****************************************************************/
+    inline int16u GetPortCount( void ) const       { return Ports; }
+    /****************************************************************/
+    inline void SetPort( DESL::base_t* dst_node, int16u src_port = 0 ) 
+    { 
+        _ASSERT( src_port < Ports );
+        OutPort[ src_port ] = dst_node;
+    }
+    /****************************************************************/
+    inline DESL::base_t* GetPort( int16u src_port = 0 ) const 
+    { 
+        _ASSERT( src_port < Ports );
+        return OutPort[ src_port ];
+    }
+};
+
 
 
 #endif /* _MPORT_H_INCLUDED_ */
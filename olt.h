@@ -3,28 +3,73 @@
 #define __OLT_H_INCLUDED__ 
 
 ////////////////////////////////////////////////////////////////////////////////
+// Monitor of the GATEs of fast-forwarded idle cycles: OLT port, time when the 
+// GATE would arrive at the ONU, grant start and length
+////////////////////////////////////////////////////////////////////////////////
+typedef void (*pf_monitor_gate)( int16u port, DESL::time_t time, DESL::time_t start, int32s length );
+
+////////////////////////////////////////////////////////////////////////////////
+// Current polling cycle of an OLT port whose idle cycles are fast-forwarded
+////////////////////////////////////////////////////////////////////////////////
+class IdleCycle : public HeapNode
+{
+public:
+    ONU*          pOnu;                  // ONU of the port (NULL = no fast-forward)
+    int16u        Port;
+    BOOL          Idle;                  // OLT follows the cycles of the ONU
+    BOOL          Monitored;             // GATE of the cycle has arrived at the ONU
+    BOOL          Wakeup;                // packet arrived after the REPORT of the cycle was sent
+    int32s        Delay;                 // one-way delay between the OLT and the ONU
+    DESL::time_t  Timestamp;             // GATE of the cycle
+    DESL::time_t  StartTime;
+    int32s        Length;
+
+    IdleCycle()   { pOnu = NULL; Port = 0; Idle = Monitored = Wakeup = FALSE; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Times of the cycle at the OLT (ONU local times plus Delay)
+    ///////////////////////////////////////////////////////////////////////////
+    inline DESL::time_t GetGateArrival( void )   const { return Timestamp + Delay; }
+    inline DESL::time_t GetReportSent( void )    const { return StartTime + Delay + _PON_TIME( Length - _OVERHEAD( MPCP_PACKET_SIZE )); }
+    inline DESL::time_t GetReportArrival( void ) const { return StartTime + _PON_TIME( Length ) + 2 * Delay; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Time of the next step of the cycle
+    ///////////////////////////////////////////////////////////////////////////
+    inline DESL::time_t GetKey( void ) const     { return Monitored? GetReportArrival(): GetGateArrival(); }
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
-class OLT : public SimBase< NUM_LLID >
+////////////////////////////////////////////////////////////////////////////////
+class OLT : public SimBase< DYNAMIC_PORTS >
 {
 
 private:
     DESL::time_t  ScheduleEnd;           // future time up to which the schedule exists
     DESL::time_t  LastPacketArrival;     // arrival time of the last packet
     int32s        MaxSlot;               // Maximum slot size
+    IdleCycle*    pIdle;                 // fast-forwarded idle cycles of each port
+    IndexedHeap< IdleCycle, DESL::time_t > 
+                  IdleHeap;              // ports in idle cycles, by the time of the next step
+    pf_monitor_gate pMonitorGATE;        // monitor of the skipped GATEs (NULL = none)
+
+    DESL::base_t* pSplitter;             // downstream splitter (broadcast frames)
+    DESL::time_t  DownstreamEnd;         // time when the last downstream frame leaves the OLT
+    int32s        DownstreamBuffer;      // downstream buffer size (bytes)
 
 
     ////////////////////////////////////////////////////////////////////////////////
-    // FUNCTION:    void CheckPacketCollision( GEN::pckt_size_t pckt_size )
+    // FUNCTION:    void CheckPacketCollision( DESL::time_t time, GEN::pckt_size_t pckt_size )
     // DESCRIPTION: 
-    // NOTES:
+    // NOTES:       time is the arrival time of the packet
     ////////////////////////////////////////////////////////////////////////////////
-    inline void CheckPacketCollision( GEN::pckt_size_t pckt_size )
+    inline void CheckPacketCollision( DESL::time_t time, GEN::pckt_size_t pckt_size )
     {
-        if( LastPacketArrival + _PON_PCKT_TIME( pckt_size ) > LocalTime() )
+        if( LastPacketArrival + _PON_PCKT_TIME( pckt_size ) > time )
             MSG_WARN( "OLT detected collided packets" );
 
-        LastPacketArrival = LocalTime();
+        LastPacketArrival = time;
     }    
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -34,7 +79,7 @@ private:
     ////////////////////////////////////////////////////////////////////////////////
     inline void ReceiveDataPacket( DESL::evnt_t* pEvent )
     {
-        CheckPacketCollision( pEvent->Pckt.PcktSize );
+        CheckPacketCollision( LocalTime(), pEvent->Pckt.PcktSize );
 
         /////////////////////////////////////////////////////////
         // Keep track of the bytes received by each LLID
@@ -46,43 +91,67 @@ private:
     }
 
     ////////////////////////////////////////////////////////////////////////////////
-    // FUNCTION:    void ReceiveREPORTPacket( DESL::evnt_t* pEvent )
-    // DESCRIPTION: 
-    // NOTES:
+    // FUNCTION:    void SendDownstreamPacket( DESL::evnt_t* pEvent )
+    // DESCRIPTION: Queues a packet from a downstream source for broadcast to its 
+    //              LLID, or drops it if the downstream buffer is full
+    // NOTES:       The downstream channel sends frames back-to-back in FIFO order, 
+    //              so the departure time of a frame is known when it arrives and 
+    //              the buffer holds the bytes not yet sent by DownstreamEnd.  The 
+    //              frame is registered once, at its departure, with the splitter.
+    //              GATEs are not sent on this channel (see SetSplitter).
     ////////////////////////////////////////////////////////////////////////////////
-    inline void ReceiveREPORTPacket( DESL::evnt_t* pEvent )
+    inline void SendDownstreamPacket( DESL::evnt_t* pEvent )
     {
-        CheckPacketCollision( MPCP_PACKET_SIZE );
+        DESL::time_t start = MAX( LocalTime(), DownstreamEnd );
 
-        //////////////////////////////////////////////////////////
-        // measure RTT
-        //////////////////////////////////////////////////////////
-        DESL::time_t rtt    = LocalTime() - pEvent->RPRT.Timestamp;
+        if( _PON_BYTE( start - LocalTime() ) + pEvent->Pckt.PcktSize > DownstreamBuffer )
+        {
+            pEvent->Type     = EV_PCKT_DROP;
+            pEvent->Consumer = NULL;
+            RegisterEvent( pEvent );              // register an immediate event
+            return;
+        }
 
-        DESL::evnt_t* ptr   = DESL::AllocateEvent();
-        ptr->Type           = EV_MPCP_GATE;
-        ptr->Consumer       = pEvent->Producer;
-        ptr->GATE.Timestamp = LocalTime() + _PON_PCKT_TIME( MPCP_PACKET_SIZE ) + OLT_HW_PROCESS_DELAY; 
-        ptr->GATE.StartTime = MAX( ptr->GATE.Timestamp + ONU_HW_PROCESS_DELAY, ScheduleEnd - rtt );
+        DownstreamEnd       = start + _PON_PCKT_TIME( pEvent->Pckt.PcktSize );
+
+        pEvent->Type        = EV_PCKT_BROADCAST;
+        pEvent->Consumer    = pSplitter;
+        pEvent->Pckt.LLID   = _DSR_ID( pEvent->Producer->ID );
+        RegisterEventAbs( pEvent, DownstreamEnd );
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    void ScheduleGATE( DESL::time_t time, DESL::time_t rtt, int16u port, int32s report, GATE_Data_t& gate )
+    // DESCRIPTION: Computes the GATE for a REPORT of 'report' bytes received 
+    //              at 'time' from 'port', and extends the schedule
+    // NOTES:       Also used for the REPORTs of fast-forwarded idle cycles
+    ////////////////////////////////////////////////////////////////////////////////
+    inline void ScheduleGATE( DESL::time_t time, DESL::time_t rtt, int16u port, int32s report, GATE_Data_t& gate )
+    {
+        (void) port;        // used by the elastic service
+        (void) report;      // not used by the fixed service
+
+        gate.Timestamp = time + _PON_PCKT_TIME( MPCP_PACKET_SIZE ) + OLT_HW_PROCESS_DELAY; 
+        gate.StartTime = MAX( gate.Timestamp + ONU_HW_PROCESS_DELAY, ScheduleEnd - rtt );
         
         //////////////////////////////////////////////////////////
         // scheduling disciplines
         //////////////////////////////////////////////////////////
 
         // a. Fixed service
-        ptr->GATE.Length = MaxSlot; 
+        gate.Length = MaxSlot; 
 
         // b. Limited service
-        //ptr->GATE.Length = MIN<int32s>( pEvent->RPRT.Length + _OVERHEAD( MPCP_PACKET_SIZE ), MaxSlot ); 
+        //gate.Length = MIN<int32s>( report + _OVERHEAD( MPCP_PACKET_SIZE ), MaxSlot ); 
 
         // c. Gated service
-        //ptr->GATE.Length = pEvent->RPRT.Length + _OVERHEAD( MPCP_PACKET_SIZE ); 
+        //gate.Length = report + _OVERHEAD( MPCP_PACKET_SIZE ); 
 
         // d. Constant Credit service
-        //ptr->GATE.Length = MIN<int32s>( pEvent->RPRT.Length + _OVERHEAD(MPCP_PACKET_SIZE) + _OVERHEAD(MAX_PACKET_SIZE), MaxSlot );  
+        //gate.Length = MIN<int32s>( report + _OVERHEAD(MPCP_PACKET_SIZE) + _OVERHEAD(MAX_PACKET_SIZE), MaxSlot );  
 
         // e. Linear Credit service
-        //ptr->GATE.Length = MIN<int32s>( pEvent->RPRT.Length * 1.2 + _OVERHEAD(MPCP_PACKET_SIZE), MaxSlot ); 
+        //gate.Length = MIN<int32s>( report * 1.2 + _OVERHEAD(MPCP_PACKET_SIZE), MaxSlot ); 
 
         // f. Elastic service
         //static int32s last_grant[NUM_LLID];
@@ -91,15 +160,206 @@ private:
         //for( int16s ndx = 0; ndx < NUM_LLID; ndx++ )
         //    total_granted += last_grant[ndx];
 
-        //ptr->GATE.Length = MIN<int32s>( pEvent->RPRT.Length + _OVERHEAD(MPCP_PACKET_SIZE), MAX<int32s>( NUM_LLID * MaxSlot - total_granted, 0 ));
-        //last_grant[ _LNK_ID( pEvent->Producer->ID ) ] = ptr->GATE.Length;
+        //gate.Length = MIN<int32s>( report + _OVERHEAD(MPCP_PACKET_SIZE), MAX<int32s>( NUM_LLID * MaxSlot - total_granted, 0 ));
+        //last_grant[ port ] = gate.Length;
 
+        ScheduleEnd = gate.StartTime + rtt + _PON_TIME( gate.Length ) + GUARD_BAND_TIME;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    void ReceiveREPORTPacket( DESL::evnt_t* pEvent )
+    // DESCRIPTION: 
+    // NOTES:
+    ////////////////////////////////////////////////////////////////////////////////
+    inline void ReceiveREPORTPacket( DESL::evnt_t* pEvent )
+    {
+        CheckPacketCollision( LocalTime(), MPCP_PACKET_SIZE );
+
+        //////////////////////////////////////////////////////////
+        // measure RTT
+        //////////////////////////////////////////////////////////
+        DESL::time_t rtt    = LocalTime() - pEvent->RPRT.Timestamp;
+        int16u       port   = _LNK_ID( pEvent->Producer->ID );
+
+        DESL::evnt_t* ptr   = DESL::AllocateEvent();
+        ptr->Type           = EV_MPCP_GATE;
+        ptr->Consumer       = pEvent->Producer;
+
+        ScheduleGATE( LocalTime(), rtt, port, pEvent->RPRT.Length, ptr->GATE );
 
         //////////////////////////////////////////////////////////
-        // Issue GATE message
+        // Issue GATE message, or fast-forward the cycles of an 
+        // empty ONU
         //////////////////////////////////////////////////////////
-        RegisterEventAbs( ptr, ptr->GATE.Timestamp );
-        ScheduleEnd = ptr->GATE.StartTime + rtt + _PON_TIME( ptr->GATE.Length ) + GUARD_BAND_TIME;
+        if( pEvent->RPRT.Length == 0 && IsIdleONU( port, pEvent->Producer ) && ptr->GATE.Length >= _OVERHEAD( MPCP_PACKET_SIZE ))
+        {
+            StartIdleCycles( port, rtt, ptr->GATE );
+            DESL::DestroyEvent( ptr );
+        }
+        else
+            RegisterEventAbs( ptr, ptr->GATE.Timestamp );
+    }
+
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Idle cycle fast-forward
+    //
+    // An idle cycle of an ONU (GATE, 'Grant for data' and REPORT timers, REPORT) 
+    // takes 6 events.  If enabled by SetIdleONU(), a GATE to an ONU that 
+    // reported an empty queue, and has received no packet since, is not sent.  
+    // Under the fixed service the grants do not depend on the REPORTs, so the 
+    // OLT computes the following cycles of the ONU itself, without events: the 
+    // REPORT of each cycle is processed, in time order with the REPORTs of the 
+    // other ONUs, before the OLT processes any later event (FollowIdleCycles).  
+    //
+    // The ONU tells the OLT when its first packet arrives (EV_IDLE_ARRIVAL).  
+    // If the REPORT of the current cycle is not sent yet, the ONU takes over 
+    // that cycle: it receives the GATE if the GATE is still on its way, or 
+    // else the timers of the grant (ONU::ScheduleGrant()).  Otherwise the cycle 
+    // is empty, and the OLT sends the GATE of the next cycle when the REPORT 
+    // of the current one arrives (EV_TIMER_IDLE_REPORT).  The ONU sends the 
+    // REPORTs of all cycles in which it has packets, so skipped REPORTs are 
+    // always empty.
+    // 
+    // All grants, the data sent, and the REPORT times are the same as without 
+    // fast-forward.  The skipped GATEs are passed to the monitor set by 
+    // SetGateMonitor() when the OLT catches up with them, i.e., not in time 
+    // order with the other events, but never before their arrival time.
+    ////////////////////////////////////////////////////////////////////////////////
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    BOOL IsIdleONU( int16u port, DESL::base_t* link ) const
+    // DESCRIPTION: Returns TRUE if the idle cycles of the ONU of 'port' are 
+    //              fast-forwarded and its queue is empty
+    // NOTES:       'link' must be connected to 'port'
+    ////////////////////////////////////////////////////////////////////////////////
+    inline BOOL IsIdleONU( int16u port, DESL::base_t* link ) const
+    {
+        return port < GetPortCount() && GetPort( port ) == link && pIdle[ port ].pOnu && pIdle[ port ].pOnu->GetQueueLength() == 0;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    void StartIdleCycles( int16u port, DESL::time_t rtt, const GATE_Data_t& gate )
+    // DESCRIPTION: Follows the cycles of 'port' at the OLT, starting with 'gate'
+    // NOTES:
+    ////////////////////////////////////////////////////////////////////////////////
+    inline void StartIdleCycles( int16u port, DESL::time_t rtt, const GATE_Data_t& gate )
+    {
+        IdleCycle* c = &pIdle[ port ];
+
+        c->Idle      = TRUE;
+        c->Monitored = FALSE;
+        c->Wakeup    = FALSE;
+        c->Delay     = static_cast<int32s>( rtt / 2 );
+        c->Timestamp = gate.Timestamp;
+        c->StartTime = gate.StartTime;
+        c->Length    = gate.Length;
+
+        c->pOnu->SetIdlePort( port );
+        IdleHeap.AddNode( c );
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    void FollowIdleCycles( DESL::time_t time )
+    // DESCRIPTION: Passes all GATEs and processes all REPORTs of fast-forwarded 
+    //              cycles up to 'time', in time order
+    // NOTES:
+    ////////////////////////////////////////////////////////////////////////////////
+    inline void FollowIdleCycles( DESL::time_t time )
+    {
+        for( IdleCycle* c = IdleHeap.GetHead(); c && c->GetKey() <= time; c = IdleHeap.GetHead() )
+        {
+            if( c->Monitored )
+            {
+                ReceiveIdleREPORT( c );
+                continue;
+            }
+
+            if( pMonitorGATE )
+                pMonitorGATE( c->Port, c->GetGateArrival(), c->StartTime, c->Length );
+
+            c->Monitored = TRUE;
+            IdleHeap.UpdateHead();
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    void ReceiveIdleREPORT( IdleCycle* c )
+    // DESCRIPTION: Processes the (empty) REPORT of fast-forwarded cycle c and 
+    //              starts the next cycle, or sends its GATE to the ONU if a 
+    //              packet has arrived 
+    // NOTES:       c must be the head of IdleHeap
+    ////////////////////////////////////////////////////////////////////////////////
+    inline void ReceiveIdleREPORT( IdleCycle* c )
+    {
+        DESL::time_t time = c->GetReportArrival();
+        GATE_Data_t  gate;
+
+        CheckPacketCollision( time, MPCP_PACKET_SIZE );
+        ScheduleGATE( time, 2 * c->Delay, c->Port, 0, gate );
+
+        if( c->Wakeup )
+        {
+            IdleHeap.RemoveHead();
+            c->Idle = FALSE;
+
+            DESL::evnt_t* ptr   = DESL::AllocateEvent();
+            ptr->Type           = EV_MPCP_GATE;
+            ptr->Consumer       = GetPort( c->Port );
+            ptr->GATE           = gate;
+            RegisterEventAbs( ptr, gate.Timestamp );
+            return;
+        }
+
+        c->Monitored = FALSE;
+        c->Timestamp = gate.Timestamp;
+        c->StartTime = gate.StartTime;
+        c->Length    = gate.Length;
+        IdleHeap.UpdateHead();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    void WakeIdleONU( DESL::evnt_t* pEvent )
+    // DESCRIPTION: Hands the polling cycles back to an ONU whose first packet 
+    //              has arrived
+    // NOTES:       The cycles are followed up to the current time
+    ////////////////////////////////////////////////////////////////////////////////
+    inline void WakeIdleONU( DESL::evnt_t* pEvent )
+    {
+        IdleCycle* c = &pIdle[ pEvent->IDLE.Port ];
+
+        //////////////////////////////////////////////////////////
+        // REPORT of the current cycle is sent: the ONU takes 
+        // over the next cycle
+        //////////////////////////////////////////////////////////
+        if( LocalTime() > c->GetReportSent() )
+        {
+            c->Wakeup        = TRUE;
+            pEvent->Type     = EV_TIMER_IDLE_REPORT;
+            pEvent->Consumer = this;
+            RegisterEventAbs( pEvent, c->GetReportArrival() );
+            return;
+        }
+
+        IdleHeap.RemoveNode( c );
+        c->Idle = FALSE;
+
+        //////////////////////////////////////////////////////////
+        // deliver the GATE of the current cycle, or set the 
+        // timers of its grant
+        //////////////////////////////////////////////////////////
+        if( c->Monitored )
+        {
+            c->pOnu->ScheduleGrant( c->StartTime, c->Length );
+            return;
+        }
+
+        pEvent->Type           = EV_MPCP_GATE;
+        pEvent->Consumer       = c->pOnu;
+        pEvent->GATE.Timestamp = c->Timestamp;
+        pEvent->GATE.StartTime = c->StartTime;
+        pEvent->GATE.Length    = c->Length;
+        RegisterEventAbs( pEvent, c->GetGateArrival() );
     }
 
 
@@ -115,7 +375,7 @@ private:
         DESL::time_t  timestamp = LocalTime();
 
 
-        for( int16s ndx = 0; ndx < NUM_LLID; ndx++)
+        for( int16u ndx = 0; ndx < GetPortCount(); ndx++)
         {
             ptr                 = DESL::AllocateEvent();
             ptr->Type           = EV_MPCP_GATE;
@@ -135,14 +395,71 @@ private:
 
 public:
     ////////////////////////////////////////////////////////////////////////////////
-    // FUNCTION:    OLT( DESL::obid_t id ) : MultiPort< NUM_LLID >( id )
+    // FUNCTION:    OLT( DESL::obid_t id, int16u ports, int32s max_slot )
     // DESCRIPTION: Constructor
-    // NOTES:
+    // NOTES:       one port per LLID
     ////////////////////////////////////////////////////////////////////////////////
-    OLT( DESL::obid_t id ) : SimBase< NUM_LLID >( id )
+    OLT( DESL::obid_t id, int16u ports, int32s max_slot ) : SimBase< DYNAMIC_PORTS >( id, ports )
     {
+        pIdle        = new IdleCycle[ ports ];
+        pMonitorGATE = NULL;
+
+        for( int16u ndx = 0; ndx < ports; ndx++ )
+            pIdle[ ndx ].Port = ndx;
+
+        pSplitter        = NULL;
+        DownstreamBuffer = 0;
+
         Reset();
-        MaxSlot = MAX_SLOT;
+        MaxSlot = max_slot;
+    }
+
+    virtual ~OLT()      { delete [] pIdle; }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    void SetIdleONU( int16u port, ONU* pOnu )
+    // DESCRIPTION: Enables fast-forward of the idle cycles of ONU pOnu, which 
+    //              is connected to 'port' (NULL disables it)
+    // NOTES:       The OLT inspects the queue of the ONU directly.  Exact only 
+    //              under a service whose grants do not depend on the REPORTs.
+    ////////////////////////////////////////////////////////////////////////////////
+    inline void SetIdleONU( int16u port, ONU* pOnu ) 
+    { 
+        _ASSERT( port < GetPortCount() );
+        pIdle[ port ].pOnu = pOnu; 
+
+        if( pOnu )
+            pOnu->SetIdleOLT( this );
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    void SetGateMonitor( pf_monitor_gate monitor )
+    // DESCRIPTION: Sets the function that receives the GATEs of fast-forwarded 
+    //              idle cycles (NULL = none)
+    // NOTES:
+    ////////////////////////////////////////////////////////////////////////////////
+    inline void SetGateMonitor( pf_monitor_gate monitor )   { pMonitorGATE = monitor; }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    void CompleteIdleCycles( void )
+    // DESCRIPTION: Passes all GATEs of fast-forwarded idle cycles up to the 
+    //              current time to the monitor
+    // NOTES:       Call before the statistics of a load point are closed
+    ////////////////////////////////////////////////////////////////////////////////
+    inline void CompleteIdleCycles( void )                  { FollowIdleCycles( LocalTime() ); }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    void SetSplitter( DESL::base_t* splitter, int32s buffer_size )
+    // DESCRIPTION: Connects the downstream channel, on which packets from the 
+    //              downstream sources are broadcast through 'splitter'
+    // NOTES:       Downstream sources must have ids _DSR_ID( llid ).  GATEs 
+    //              are still sent over the logical links, i.e., they do not 
+    //              delay and are not delayed by downstream frames.
+    ////////////////////////////////////////////////////////////////////////////////
+    inline void SetSplitter( DESL::base_t* splitter, int32s buffer_size )
+    {
+        pSplitter        = splitter;
+        DownstreamBuffer = buffer_size;
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -161,7 +478,13 @@ public:
     virtual void Reset( void )
     {
         ScheduleEnd       = 
-        LastPacketArrival = LocalTime();
+        LastPacketArrival = 
+        DownstreamEnd     = LocalTime();
+
+        while( IdleHeap.RemoveHead() )
+            ;
+        for( int16u ndx = 0; ndx < GetPortCount(); ndx++ )
+            pIdle[ ndx ].Idle = FALSE;
 
         SimplifiedDiscovery();
     }
@@ -173,18 +496,57 @@ public:
     ////////////////////////////////////////////////////////////////////////////////
     virtual void Free( void ) {}
 
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    void Serialize( Archive& ar )
+    // DESCRIPTION: Writes or reads the scheduling state (checkpoint)
+    // NOTES:
+    ////////////////////////////////////////////////////////////////////////////////
+    virtual void Serialize( Archive& ar ) 
+    {
+        SimBase< DYNAMIC_PORTS >::Serialize( ar );
+        ar & ScheduleEnd & LastPacketArrival & MaxSlot & DownstreamEnd;
+
+        //////////////////////////////////////////////////////////
+        // fast-forwarded idle cycles
+        //////////////////////////////////////////////////////////
+        for( int16u ndx = 0; ndx < GetPortCount(); ndx++ )
+        {
+            IdleCycle& c = pIdle[ ndx ];
+            ar & c.Idle & c.Monitored & c.Wakeup & c.Delay & c.Timestamp & c.StartTime & c.Length;
+        }
+
+        if( ar.IsReading() )
+        {
+            while( IdleHeap.RemoveHead() )
+                ;
+            for( int16u ndx = 0; ndx < GetPortCount(); ndx++ )
+                if( pIdle[ ndx ].Idle )
+                    IdleHeap.AddNode( &pIdle[ ndx ] );
+        }
+    }
+
     ////////////////////////////////////////////////////////////////////////////////
     // FUNCTION:    void ProcessEvent( DESL::evnt_t* pEvent )
     // DESCRIPTION: Event Dispatcher
-    // NOTES:       
+    // NOTES:       Fast-forwarded idle cycles are followed up to the time of 
+    //              each event first
     // RETURN:      
     ////////////////////////////////////////////////////////////////////////////////
     virtual void ProcessEvent( DESL::evnt_t* pEvent ) 
     {
+        FollowIdleCycles( LocalTime() );
+
         switch( pEvent->Type )
         {
             case EV_MPCP_REPORT:                ReceiveREPORTPacket( pEvent );      break;
-            case EV_PCKT_ARRIVAL:               ReceiveDataPacket( pEvent );        break;
+            case EV_PCKT_ARRIVAL:
+                if( pEvent->Producer->ID & SRC_BASE_ID )
+                    SendDownstreamPacket( pEvent );     // from a downstream source
+                else
+                    ReceiveDataPacket( pEvent );        // from a logical link
+                break;
+            case EV_IDLE_ARRIVAL:               WakeIdleONU( pEvent );              break;
+            case EV_TIMER_IDLE_REPORT:          break;      // REPORT followed above
             default:  MSG_WARN( "Unhandled event in OLT (Type = " << pEvent->Type << " )" );
         }
     }   
@@ -18,12 +18,16 @@ class ONU : public SimBase<>, public PacketPool
 private:
     PDList< Packet >  FIFO;                // FIFO queue implemented as linked list
     int32s            QueueBytes;          // number of bytes in the queue
+    int32s            BufferSize;          // capacity of the queue (bytes)
 
     DESL::time_t      LastSent;            // transmission timestamp of the last packet
     DESL::time_t      SlotEnd;             // time when current slot ends
 
     BOOL              Sending;             // indication whether a queue is currently transmitting 
 
+    DESL::base_t*     pIdleOLT;            // OLT that may fast-forward the idle cycles of this ONU
+    int16s            IdlePort;            // port of the ONU at pIdleOLT while its cycles are fast-forwarded, else -1
+
     ////////////////////////////////////////////////////////////////////////////////
     // FUNCTION:    void EnqueuePacket( const Pckt_Data_t& pckt )
     // DESCRIPTION: Adds packet to FIFO queue, updates counters
@@ -44,7 +48,7 @@ private:
     ////////////////////////////////////////////////////////////////////////////////
     inline Pckt_Data_t DequeuePacket( void )
     {
-        Pckt_Data_t pckt = { 0, 0, 0 };
+        Pckt_Data_t pckt = { 0, 0, 0, 0 };
         Packet*     ptr = FIFO.RemoveHead();
         if( ptr ) 
         {
@@ -65,7 +69,7 @@ private:
     ////////////////////////////////////////////////////////////////////////////////
     inline void ReceiveDataPacket( DESL::evnt_t* pEvent )
      {
-        if( QueueBytes + pEvent->Pckt.PcktSize <= BUFFER_SIZE ) // if enough space in buffer
+        if( QueueBytes + pEvent->Pckt.PcktSize <= BufferSize ) // if enough space in buffer
         {
             EnqueuePacket( pEvent->Pckt );    // add packet to the queue 
             pEvent->Type = EV_PCKT_ENQUE;     // create EV_PCKT_ENQUE event    
@@ -77,6 +81,38 @@ private:
 
         pEvent->Consumer = NULL;        
         RegisterEvent( pEvent );              // register an immediate event
+
+        if( IdlePort >= 0 )
+            WakeIdleOLT();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    void WakeIdleOLT( void )
+    // DESCRIPTION: Tells the OLT that follows the idle cycles of this ONU that 
+    //              a packet has arrived
+    // NOTES:       Not a frame: the OLT receives it at the time of the arrival 
+    ////////////////////////////////////////////////////////////////////////////////
+    inline void WakeIdleOLT( void )
+    {
+        DESL::evnt_t* ptr = DESL::AllocateEvent();
+        ptr->Type         = EV_IDLE_ARRIVAL;
+        ptr->Consumer     = pIdleOLT;
+        ptr->IDLE.Port    = IdlePort;
+        RegisterEvent( ptr );
+
+        IdlePort = -1;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    void ReceiveBroadcast( DESL::evnt_t* pEvent )
+    // DESCRIPTION: Receives a downstream frame
+    // NOTES:       The splitter delivers frames only to their LLID, so the LLID 
+    //              filter of the ONU never discards a frame here
+    ////////////////////////////////////////////////////////////////////////////////
+    inline void ReceiveBroadcast( DESL::evnt_t* pEvent )
+    {
+        _ASSERT( pEvent->Pckt.LLID == _ONU_ID( ID ));
+        DESL::DestroyEvent( pEvent );
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -86,9 +122,6 @@ private:
     ////////////////////////////////////////////////////////////////////////////////
     inline void ProcessGATE( DESL::evnt_t* pEvent )
     {
-        DESL::evnt_t* ptr;
-        int32s        length = pEvent->GATE.Length;
-
         //////////////////////////////////////////////////////////////
         // update local time 
         //////////////////////////////////////////////////////////////
@@ -103,35 +136,7 @@ private:
             return;
         }
 
-        //////////////////////////////////////////////////////////////
-        // allocate space for Report message
-        //////////////////////////////////////////////////////////////
-        if( length >= _OVERHEAD( MPCP_PACKET_SIZE ))
-        {
-            length -= _OVERHEAD( MPCP_PACKET_SIZE );
-
-            //////////////////////////////////////////////////////////////
-            // Set timer to to pReport message
-            //////////////////////////////////////////////////////////////
-            ptr                   = DESL::AllocateEvent();
-            ptr->Consumer         = this;
-            ptr->Type             = EV_TIMER_GRANT_REPORT;
-            RegisterEventAbs( ptr, pEvent->GATE.StartTime + _PON_TIME( length ));
-        }
-        else
-            MSG_WARN( "Grant at ONU " << _ONU_ID( ID ) << " is too small for Report " );
-
-        //////////////////////////////////////////////////////////////
-        // Set timer to 'Grant for data'
-        //////////////////////////////////////////////////////////////
-        if( length >= _OVERHEAD( MIN_PACKET_SIZE ))
-        {
-            ptr                   = DESL::AllocateEvent();
-            ptr->Consumer         = this;
-            ptr->Type             = EV_TIMER_GRANT_DATA;
-            ptr->GATE.Length      = length;
-            RegisterEventAbs( ptr, pEvent->GATE.StartTime );
-        }
+        ScheduleGrant( pEvent->GATE.StartTime, pEvent->GATE.Length );
 
         DESL::DestroyEvent( pEvent );
     }
@@ -206,19 +211,21 @@ private:
         pEvent->Type            = EV_MPCP_REPORT;
         //pEvent->RPRT.LLID       = _ONU_ID( ID );
         pEvent->RPRT.Timestamp  = LocalTime() + _PON_PCKT_TIME( MPCP_PACKET_SIZE );
-        pEvent->RPRT.Length     = QueueBytes + FIFO.GetCount() * PACKET_OVERHEAD;
+        pEvent->RPRT.Length     = GetReportLength();
 
         RegisterEvent( pEvent, _PON_PCKT_TIME( MPCP_PACKET_SIZE ));
     }
 
 public:
     ////////////////////////////////////////////////////////////////////////////////
-    // FUNCTION:    ONU( DESL::obid_t id ): MultiPort<>( id )
+    // FUNCTION:    ONU( DESL::obid_t id, int32s buffer_size )
     // DESCRIPTION: Constructor
     // NOTES:
     ////////////////////////////////////////////////////////////////////////////////
-    ONU( DESL::obid_t id ) : SimBase<>( id )
+    ONU( DESL::obid_t id, int32s buffer_size = BUFFER_SIZE ) : SimBase<>( id )
     {
+        BufferSize = buffer_size;
+        pIdleOLT   = NULL;
         Reset();
     }
 
@@ -229,6 +236,72 @@ public:
     ////////////////////////////////////////////////////////////////////////////////
     int32s GetQueueLength( void )       { return QueueBytes; }
 
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    int32s GetReportLength( void )
+    // DESCRIPTION: Returns the queue length reported to the OLT (with overhead)
+    // NOTES:
+    ////////////////////////////////////////////////////////////////////////////////
+    int32s GetReportLength( void )      { return QueueBytes + FIFO.GetCount() * PACKET_OVERHEAD; }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    void ScheduleGrant( DESL::time_t start_time, int32s length )
+    // DESCRIPTION: Sets the timers of a grant: 'Grant for data' at start_time 
+    //              and REPORT at the end of the grant
+    // NOTES:       start_time is in local time.  Also called by the OLT when  
+    //              a packet arrives during a fast-forwarded idle cycle (see 
+    //              OLT::WakeIdleONU), after the slot may have opened with an 
+    //              empty queue; such a slot is not opened again.
+    ////////////////////////////////////////////////////////////////////////////////
+    void ScheduleGrant( DESL::time_t start_time, int32s length )
+    {
+        DESL::evnt_t* ptr;
+
+        //////////////////////////////////////////////////////////////
+        // allocate space for Report message
+        //////////////////////////////////////////////////////////////
+        if( length >= _OVERHEAD( MPCP_PACKET_SIZE ))
+        {
+            length -= _OVERHEAD( MPCP_PACKET_SIZE );
+
+            //////////////////////////////////////////////////////////////
+            // Set timer to to pReport message
+            //////////////////////////////////////////////////////////////
+            ptr                   = DESL::AllocateEvent();
+            ptr->Consumer         = this;
+            ptr->Type             = EV_TIMER_GRANT_REPORT;
+            RegisterEventAbs( ptr, start_time + _PON_TIME( length ));
+        }
+        else
+            MSG_WARN( "Grant at ONU " << _ONU_ID( ID ) << " is too small for Report " );
+
+        //////////////////////////////////////////////////////////////
+        // Set timer to 'Grant for data'
+        //////////////////////////////////////////////////////////////
+        if( length >= _OVERHEAD( MIN_PACKET_SIZE ) && start_time >= LocalTime() )
+        {
+            ptr                   = DESL::AllocateEvent();
+            ptr->Consumer         = this;
+            ptr->Type             = EV_TIMER_GRANT_DATA;
+            ptr->GATE.Length      = length;
+            RegisterEventAbs( ptr, start_time );
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    void SetIdleOLT( DESL::base_t* olt )
+    // DESCRIPTION: Sets the OLT that may fast-forward the idle cycles of this ONU
+    // NOTES:       Called by OLT::SetIdleONU()
+    ////////////////////////////////////////////////////////////////////////////////
+    void SetIdleOLT( DESL::base_t* olt )    { pIdleOLT = olt; }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    void SetIdlePort( int16s port )
+    // DESCRIPTION: Marks the cycles of this ONU as fast-forwarded by port 'port' 
+    //              of the OLT, until the next packet arrives
+    // NOTES:
+    ////////////////////////////////////////////////////////////////////////////////
+    void SetIdlePort( int16s port )         { IdlePort = port; }
+
     ////////////////////////////////////////////////////////////////////////////////
     // FUNCTION:    void Reset( void )
     // DESCRIPTION: Clears all buffers in the ONU.
@@ -239,6 +312,7 @@ public:
         Sending    = FALSE;
         SlotEnd    = 0;                // slot is closed at the beginning 
         QueueBytes = 0;
+        IdlePort   = -1;
         RecycleAllPackets( &FIFO );
     }
 
@@ -253,6 +327,36 @@ public:
         ReleaseAllPackets();
     }
 
+    ////////////////////////////////////////////////////////////////////////////////
+    // FUNCTION:    void Serialize( Archive& ar )
+    // DESCRIPTION: Writes or reads the state and the FIFO contents (checkpoint)
+    // NOTES:
+    ////////////////////////////////////////////////////////////////////////////////
+    virtual void Serialize( Archive& ar ) 
+    {
+        int32s count = FIFO.GetCount();
+
+        SimBase<>::Serialize( ar );
+        ar & LastSent & SlotEnd & Sending & IdlePort & count;
+
+        if( ar.IsWriting() )
+        {
+            for( Packet* ptr = FIFO.GetHead(); ptr; ptr = ptr->GetNext() )
+                ar & static_cast< Pckt_Data_t& >( *ptr );
+        }
+        else
+        {
+            QueueBytes = 0;
+            RecycleAllPackets( &FIFO );
+
+            for( Pckt_Data_t pckt; count > 0 && ar.IsGood(); count-- )
+            {
+                ar & pckt;
+                EnqueuePacket( pckt );
+            }
+        }
+    }
+
     ////////////////////////////////////////////////////////////////////////////////
     // FUNCTION:    void ProcessEvent( DESL::evnt_t* pEvent )
     // DESCRIPTION: Event Dispatcher
@@ -271,6 +375,7 @@ public:
             // data processing 
             case EV_PCKT_ARRIVAL:       ReceiveDataPacket( pEvent );    break;
             case EV_PCKT_DEQUE:         FinishSendingPacket( pEvent );  break;
+            case EV_PCKT_BROADCAST:     ReceiveBroadcast( pEvent );     break;
             default:                    MSG_WARN( "Unhandled event in ONU (Type = " << pEvent->Type << " )" );
         }
     }     
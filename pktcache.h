@@ -0,0 +1,341 @@
+/**********************************************************
+ * Filename:    pktcache.h
+ *
+ * Description: This file contains declaration for
+ *              class PacketCache, a compressed block file
+ *              of generated packets
+ *
+ *********************************************************/
+
+#if !defined(_PACKET_CACHE_H_INCLUDED_)
+#define _PACKET_CACHE_H_INCLUDED_
+
+#include <stdio.h>
+#include <string.h>
+#include "_ckpt.h"
+#include "trf_gen_v3.h"
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+////
+//// Class PacketCache stores the sequence of packets (interval and size)
+//// produced by a packet generator, so that a later run with the same
+//// generator parameters can read it back instead of generating it.
+////
+//// File layout (native byte order):
+////      header:     int32u  PACKET_CACHE_MAGIC
+////                  int32u  PACKET_CACHE_VERSION
+////                  int64u  key (hash of generator parameters)
+////      blocks:     int32u  number of packets
+////                  int32u  number of bytes
+////                  packets: interval and size, each as a 7-bit varint
+////      trailer:    state of the generator after the last block
+////                  (written and read by the owner through Trailer())
+////      footer:     int64u  offset of the trailer
+////                  int32u  PACKET_CACHE_END
+////
+//// A cache is written to "name.tmp" and renamed to "name" by Commit(), so
+//// a file that exists under its final name is always complete.
+////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+const int32u PACKET_CACHE_MAGIC   = 0x41434B50;     // "PKCA"
+const int32u PACKET_CACHE_END     = 0x45434B50;     // "PKCE"
+const int32u PACKET_CACHE_VERSION = 1;
+const int32u PACKET_CACHE_BLOCK   = 4096;           // packets per block
+
+class PacketCache
+{
+private:
+    FILE*   pFile;
+    BOOL    Writing;
+    char*   FileName;
+    int64u  Offset;                 // current position in the file
+    int64u  TrailerOffset;
+    int32u  Blocks;                 // blocks written or read
+    BYTE    Buffer[ PACKET_CACHE_BLOCK * 8 ];
+    Archive TrailerAr;
+
+    ///////////////////////////////////////////////////////////////////////////
+    static inline BYTE* Encode( BYTE* ptr, int32u val )
+    {
+        while( val >= 0x80 )
+        {
+            *ptr++ = (BYTE)( val | 0x80 );
+            val >>= 7;
+        }
+        *ptr++ = (BYTE) val;
+        return ptr;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    static inline const BYTE* Decode( const BYTE* ptr, int32u& val )
+    {
+        int32u shift = 0;
+        val = 0;
+        while( *ptr & 0x80 )
+        {
+            val |= (int32u)( *ptr++ & 0x7F ) << shift;
+            shift += 7;
+        }
+        val |= (int32u)( *ptr++ ) << shift;
+        return ptr;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline BOOL Fail( void )
+    {
+        Close();
+        return FALSE;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline FILE* OpenFile( const char* file_name, const char* mode )
+    {
+        FILE* file = NULL;
+#if defined( _MSC_VER )
+        if( fopen_s( &file, file_name, mode ) != 0 )
+            file = NULL;
+#else
+        file = fopen( file_name, mode );
+#endif
+        if( file )
+            setvbuf( file, NULL, _IOFBF, 1 << 16 );
+        return file;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Seeks with a 64-bit offset (fseek takes a long, which is 32 bits on 
+    // Windows and on 32-bit builds)
+    ///////////////////////////////////////////////////////////////////////////
+    inline int Seek( int64s offset, int origin )
+    {
+#if defined( _MSC_VER )
+        return _fseeki64( pFile, offset, origin );
+#else
+        return fseeko( pFile, (off_t) offset, origin );
+#endif
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void SetName( const char* file_name )
+    {
+        delete [] FileName;
+        FileName = new char[ strlen( file_name ) + 1 ];
+        memcpy( FileName, file_name, strlen( file_name ) + 1 );
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline void TempName( char* buffer, size_t size ) const
+    {
+        _snprintf_s( buffer, size, size - 1, "%s.tmp", FileName );
+    }
+
+public:
+    PacketCache()
+    {
+        pFile    = NULL;
+        Writing  = FALSE;
+        FileName = NULL;
+        Offset   = TrailerOffset = 0;
+        Blocks   = 0;
+    }
+
+    virtual ~PacketCache()  { Close(); delete [] FileName; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Opens a complete cache with given key for reading
+    ///////////////////////////////////////////////////////////////////////////
+    BOOL OpenRead( const char* file_name, int64u key )
+    {
+        int32u header[2];
+        int64u file_key;
+        int64u footer_offset;
+        int32u footer_magic;
+
+        Close();
+        if( ( pFile = OpenFile( file_name, "rb" )) == NULL )
+            return FALSE;
+
+        Writing = FALSE;
+        SetName( file_name );
+
+        if( fread( header, sizeof( header ), 1, pFile ) != 1 || fread( &file_key, sizeof( file_key ), 1, pFile ) != 1 ||
+            header[0] != PACKET_CACHE_MAGIC || header[1] != PACKET_CACHE_VERSION || file_key != key )
+            return Fail();
+
+        if( Seek( -(int64s)( sizeof( footer_offset ) + sizeof( footer_magic )), SEEK_END ) != 0 ||
+            fread( &footer_offset, sizeof( footer_offset ), 1, pFile ) != 1 ||
+            fread( &footer_magic,  sizeof( footer_magic ),  1, pFile ) != 1 ||
+            footer_magic != PACKET_CACHE_END )
+            return Fail();
+
+        Offset        = sizeof( header ) + sizeof( file_key );
+        TrailerOffset = footer_offset;
+        Blocks        = 0;
+        return Seek( (int64s) Offset, SEEK_SET ) == 0? TRUE: Fail();
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Creates a new cache (as a temporary file until Commit())
+    ///////////////////////////////////////////////////////////////////////////
+    BOOL OpenWrite( const char* file_name, int64u key )
+    {
+        char   tmp_name[ 1024 ];
+        int32u header[2] = { PACKET_CACHE_MAGIC, PACKET_CACHE_VERSION };
+
+        Close();
+        SetName( file_name );
+        TempName( tmp_name, sizeof( tmp_name ));
+
+        if( ( pFile = OpenFile( tmp_name, "wb" )) == NULL )
+            return FALSE;
+
+        Writing = TRUE;
+        Offset  = sizeof( header ) + sizeof( key );
+        Blocks  = 0;
+
+        if( fwrite( header, sizeof( header ), 1, pFile ) != 1 || fwrite( &key, sizeof( key ), 1, pFile ) != 1 )
+            return Fail();
+        return TRUE;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Closes the file; an uncommitted temporary file is deleted
+    ///////////////////////////////////////////////////////////////////////////
+    void Close( void )
+    {
+        if( pFile == NULL )
+            return;
+
+        fclose( pFile );
+        pFile = NULL;
+
+        if( Writing )
+        {
+            char tmp_name[ 1024 ];
+            TempName( tmp_name, sizeof( tmp_name ));
+            remove( tmp_name );
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline BOOL   IsOpen( void )    const { return pFile != NULL; }
+    inline BOOL   IsReading( void ) const { return pFile != NULL && !Writing; }
+    inline BOOL   IsWriting( void ) const { return pFile != NULL && Writing;  }
+    inline int32u GetBlocks( void ) const { return Blocks; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    BOOL WriteBlock( const GEN::Packet* pckt, int32u count )
+    {
+        BYTE*  ptr = Buffer;
+        int32u size[2];
+
+        for( int32u n = 0; n < count; n++ )
+        {
+            ptr = Encode( ptr, pckt[n].Interval );
+            ptr = Encode( ptr, pckt[n].PcktSize );
+        }
+
+        size[0] = count;
+        size[1] = (int32u)( ptr - Buffer );
+
+        if( fwrite( size, sizeof( size ), 1, pFile ) != 1 || fwrite( Buffer, size[1], 1, pFile ) != 1 )
+            return Fail();
+
+        Offset += sizeof( size ) + size[1];
+        Blocks++;
+        return TRUE;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Reads next block; returns FALSE at the end of the cached packets
+    ///////////////////////////////////////////////////////////////////////////
+    BOOL ReadBlock( GEN::Packet* pckt, int32u& count, GEN::source_id_t source_id )
+    {
+        int32u size[2];
+
+        if( Offset >= TrailerOffset || fread( size, sizeof( size ), 1, pFile ) != 1 ||
+            size[0] > PACKET_CACHE_BLOCK || size[1] > sizeof( Buffer ) || fread( Buffer, size[1], 1, pFile ) != 1 )
+            return FALSE;
+
+        const BYTE* ptr = Buffer;
+        for( int32u n = 0; n < size[0]; n++ )
+        {
+            int32u interval, pckt_size;
+            ptr = Decode( ptr, interval );
+            ptr = Decode( ptr, pckt_size );
+
+            pckt[n].SourceId = source_id;
+            pckt[n].Interval = (GEN::pause_size_t) interval;
+            pckt[n].PcktSize = (GEN::pckt_size_t) pckt_size;
+        }
+
+        count   = size[0];
+        Offset += sizeof( size ) + size[1];
+        Blocks++;
+        return TRUE;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Skips given number of blocks (used when restoring a checkpoint)
+    ///////////////////////////////////////////////////////////////////////////
+    BOOL SkipBlocks( int32u blocks )
+    {
+        int32u size[2];
+
+        while( Blocks < blocks )
+        {
+            if( Offset >= TrailerOffset || fread( size, sizeof( size ), 1, pFile ) != 1 ||
+                Seek( size[1], SEEK_CUR ) != 0 )
+                return FALSE;
+
+            Offset += sizeof( size ) + size[1];
+            Blocks++;
+        }
+        return TRUE;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Returns archive for writing the trailer after the last block, or for
+    // reading it after the last block was read
+    ///////////////////////////////////////////////////////////////////////////
+    Archive& Trailer( void )
+    {
+        if( Writing )
+            TrailerOffset = Offset;
+        else
+            Seek( (int64s) TrailerOffset, SEEK_SET );
+
+        TrailerAr = Archive( pFile, Writing );
+        return TrailerAr;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Completes a cache being written and gives it its final name
+    ///////////////////////////////////////////////////////////////////////////
+    BOOL Commit( void )
+    {
+        char tmp_name[ 1024 ];
+        BOOL result = TrailerAr.Close() &&
+                      fwrite( &TrailerOffset, sizeof( TrailerOffset ), 1, pFile ) == 1 &&
+                      fwrite( &PACKET_CACHE_END, sizeof( PACKET_CACHE_END ), 1, pFile ) == 1;
+
+        result = ( fclose( pFile ) == 0 ) && result;
+        pFile  = NULL;
+
+        TempName( tmp_name, sizeof( tmp_name ));
+        if( result )
+        {
+            remove( FileName );
+            result = rename( tmp_name, FileName ) == 0;
+        }
+        if( !result )
+            remove( tmp_name );
+        return result;
+    }
+};
+
+
+#endif // _PACKET_CACHE_H_INCLUDED_
@@ -4,7 +4,11 @@
  * Description: This file contains declarations for
  *              class Packet: public GEN::Packet
  *              class PacketPool
+ *              class PacketSourceBase
+ *              class PacketSourceT (with traffic cache)
  *              class PacketSource
+ *              class PacketTrace
+ *              class TraceSource
  *
  * Author: Glen Kramer (kramer@cs.ucdavis.edu)
  *         University of California @ Davis
@@ -13,15 +17,18 @@
 #if !defined(_PACKET_SOURCE_H_INCLUDED_)
 #define _PACKET_SOURCE_H_INCLUDED_
 
+#include <string.h>
 #include "broadcom_pdf.h"
 #include "trf_gen_v3.h"
+#include "_mmap.h"
+#include "pktcache.h"
 
 ////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////
 
 GEN::Stream* CreateParetoStream( GEN::load_t load, float mean_burst )
 {
-    return new GEN::StreamPareto( load, mean_burst, 1.4F );
+    return new GEN::StreamPareto( load, mean_burst, PARETO_SHAPE );
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -32,6 +39,26 @@ GEN::Stream* CreateExponStream(  GEN::load_t load, float mean_burst )
     return new GEN::StreamExpon( load, mean_burst );
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+// Creates a single stream for all BURST_POOL_SIZE exponential sources; use with 
+// a pool size of 1
+////////////////////////////////////////////////////////////////////////////////////
+
+GEN::Stream* CreateExponAggregate(  GEN::load_t load, float mean_burst )
+{
+    return new GEN::StreamExponAggregate( load, mean_burst, BURST_POOL_SIZE );
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// Creates a single fractional Gaussian noise stream for the whole load; use with
+// a pool size of 1
+////////////////////////////////////////////////////////////////////////////////////
+
+GEN::Stream* CreateFGNStream(  GEN::load_t load, float mean_burst )
+{
+    return new GEN::StreamFGN( load, mean_burst, FGN_HURST, FGN_VARIANCE, FGN_BLOCK );
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////
 
@@ -45,7 +72,56 @@ GEN::Stream* CreateCBRStream(  GEN::load_t load, float mean_burst )
 
 GEN::Stream* CreateVideoStream( GEN::load_t load, float max_burst)
 {
-    return new GEN::StreamVideo( load, max_burst, 10000, 1.4F );
+    return new GEN::StreamVideo( load, max_burst, VIDEO_BURST_PERIOD, VIDEO_SHAPE );
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+//
+// ConstructStream: constructs a stream in place, with the same parameters as 
+// the Create...() functions above, for GEN::PacketGeneratorT< S >
+//
+////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////
+
+void ConstructStream( GEN::StreamPareto* ptr, GEN::load_t load, float mean_burst )
+{
+    new( ptr ) GEN::StreamPareto( load, mean_burst, PARETO_SHAPE );
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+
+void ConstructStream( GEN::StreamExpon* ptr, GEN::load_t load, float mean_burst )
+{
+    new( ptr ) GEN::StreamExpon( load, mean_burst );
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+
+void ConstructStream( GEN::StreamExponAggregate* ptr, GEN::load_t load, float mean_burst )
+{
+    new( ptr ) GEN::StreamExponAggregate( load, mean_burst, BURST_POOL_SIZE );
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+
+void ConstructStream( GEN::StreamFGN* ptr, GEN::load_t load, float mean_burst )
+{
+    new( ptr ) GEN::StreamFGN( load, mean_burst, FGN_HURST, FGN_VARIANCE, FGN_BLOCK );
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+
+void ConstructStream( GEN::StreamCBR* ptr, GEN::load_t load, float mean_burst )
+{
+    new( ptr ) GEN::StreamCBR( load, mean_burst );
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+
+void ConstructStream( GEN::StreamVideo* ptr, GEN::load_t load, float max_burst )
+{
+    new( ptr ) GEN::StreamVideo( load, max_burst, VIDEO_BURST_PERIOD, VIDEO_SHAPE );
 }
 
 
@@ -125,9 +201,10 @@ PDList< Packet >     PacketPool::ppPool;
 
 
 ///////////////////////////////////////////////////////////////////////////
-// Callback function
+// Callback function (constexpr: the packet size distribution is built at 
+// compile time, see GenericDistribByIndex)
 ///////////////////////////////////////////////////////////////////////////
-int32s broadcom_frequency( int32s n )
+constexpr int32s broadcom_frequency( int32s n )
 {
     return round<int32u>( upstrm_size_pdf[n] * 0x7FFFFFFFL );
 }
@@ -137,23 +214,251 @@ int32s broadcom_frequency( int32s n )
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ////
-//// Class PacketSource generates stream of packets with a given size distribution
+//// Class PacketSourceT generates stream of packets with a given size distribution
+//// from a pool of streams of type S.  PacketSource is PacketSourceT< GEN::Stream >,
+//// which accepts streams of any type.
 ////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
 #define PACKET_GEN GEN::PacketGeneratorDist<int32s, MAX_PACKET_SIZE + 1, broadcom_frequency>
 
-class PacketSource : public SimBase<>, public PACKET_GEN
+///////////////////////////////////////////////////////////////////////////////
+// Traffic cache
+//
+// If enabled by PacketSourceBase::EnableCache(), each source generates its 
+// packets in blocks, using its own random generator seeded from the 
+// generator parameters, the load, and the traffic seed.  The packets are 
+// written to a PacketCache file named after the hash of these parameters.  
+// A later run with the same parameters reads the packets back from the 
+// cache; if it needs more packets than were cached, it restores the 
+// generator state saved in the cache and continues generating.
+//
+// Since the traffic does not depend on the global random generator, 
+// a run that reads the cache produces the same results as the run that 
+// wrote it.
+///////////////////////////////////////////////////////////////////////////////
+
+class PacketSourceBase
+{
+protected:
+        /* traffic cache */
+        static BOOL         CacheOn;
+        static char         CacheDir[ 256 ];
+        static int64u       CacheTag;           // hash of traffic type and seed
+
+        ///////////////////////////////////////////////////////////////////////
+        // FNV-1a hash
+        ///////////////////////////////////////////////////////////////////////
+        static inline int64u Hash( int64u hash, const void* ptr, size_t size )
+        {
+            for( size_t n = 0; n < size; n++ )
+                hash = ( hash ^ ((const BYTE*) ptr )[n] ) * 0x100000001B3ULL;
+            return hash;
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        // StreamKey: adds the stream model parameters (those set by
+        // ConstructStream and the Create...Stream functions) to the hash;
+        // one overload per stream type.
+        ///////////////////////////////////////////////////////////////////////
+        static inline int64u StreamKey( int64u hash, const GEN::StreamPareto* )
+        {
+            return Hash( hash, &PARETO_SHAPE, sizeof( PARETO_SHAPE ));
+        }
+
+        static inline int64u StreamKey( int64u hash, const GEN::StreamExpon* )
+        {
+            return hash;
+        }
+
+        static inline int64u StreamKey( int64u hash, const GEN::StreamExponAggregate* )
+        {
+            return Hash( hash, &BURST_POOL_SIZE, sizeof( BURST_POOL_SIZE ));
+        }
+
+        static inline int64u StreamKey( int64u hash, const GEN::StreamFGN* )
+        {
+            hash = Hash( hash, &FGN_HURST,    sizeof( FGN_HURST ));
+            hash = Hash( hash, &FGN_VARIANCE, sizeof( FGN_VARIANCE ));
+            return Hash( hash, &FGN_BLOCK,    sizeof( FGN_BLOCK ));
+        }
+
+        static inline int64u StreamKey( int64u hash, const GEN::StreamCBR* )
+        {
+            return hash;
+        }
+
+        static inline int64u StreamKey( int64u hash, const GEN::StreamVideo* )
+        {
+            hash = Hash( hash, &VIDEO_BURST_PERIOD, sizeof( VIDEO_BURST_PERIOD ));
+            return Hash( hash, &VIDEO_SHAPE,        sizeof( VIDEO_SHAPE ));
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        // PacketSource creates its streams through a PF_STREAM_CTOR, so the
+        // stream type is not known here; use the parameters of all types.
+        ///////////////////////////////////////////////////////////////////////
+        static inline int64u StreamKey( int64u hash, const GEN::Stream* )
+        {
+            hash = StreamKey( hash, (const GEN::StreamPareto*) NULL );
+            hash = StreamKey( hash, (const GEN::StreamExponAggregate*) NULL );
+            hash = StreamKey( hash, (const GEN::StreamFGN*) NULL );
+            return StreamKey( hash, (const GEN::StreamVideo*) NULL );
+        }
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    // Enables the traffic cache for all PacketSources created afterwards.
+    // 'traffic' identifies the stream type (it is part of the cache key, 
+    // together with the stream parameters added by StreamKey()).
+    ///////////////////////////////////////////////////////////////////////////
+    static void EnableCache( const char* dir, const char* traffic, int32u seed )
+    {
+        CacheOn  = TRUE;
+        CacheTag = Hash( 0xCBF29CE484222325ULL, traffic, strlen( traffic ));
+        CacheTag = Hash( CacheTag, &seed, sizeof( seed ));
+        _snprintf_s( CacheDir, sizeof( CacheDir ), sizeof( CacheDir ) - 1, "%s", dir );
+    }
+};
+
+/** Initialize static members **************************************/
+BOOL    PacketSourceBase::CacheOn = FALSE;
+char    PacketSourceBase::CacheDir[ 256 ] = ".";
+int64u  PacketSourceBase::CacheTag = 0;
+/*******************************************************************/
+
+///////////////////////////////////////////////////////////////////////////////
+
+template < class S > class PacketSourceT : public SimBase<>, 
+    public GEN::PacketGeneratorDist< int32s, MAX_PACKET_SIZE + 1, broadcom_frequency, GEN::PacketGeneratorT< S > >,
+    public PacketSourceBase
 {
+        typedef GEN::PacketGeneratorDist< int32s, MAX_PACKET_SIZE + 1, broadcom_frequency, GEN::PacketGeneratorT< S > > gen_t;
+
+        using gen_t::Tokens;
+        using gen_t::NextPacket;
+        using gen_t::MinIFG;
+        using gen_t::pfPcktSize;
+        using gen_t::GetNextPacket;
+        using gen_t::PeekNextPacket;
+        using gen_t::SetLoadReset;
+
 private:    
         DESL::evnt_t*    SClock;
         int32u           ByteTime;
 
+        int64u              ParamHash;          // hash of generator parameters
+        GEN::load_t         Load;
+        MTRand::uint32      RndState[ MTRand::SAVE ];
+        PacketCache         Cache;
+        GEN::Packet         Block[ PACKET_CACHE_BLOCK ];
+        int32u              BlockCount;
+        int32u              BlockPos;
+
+        ///////////////////////////////////////////////////////////////////////
+        inline int64u CacheKey( void ) const
+        {
+            return Hash( ParamHash, &Load, sizeof( Load ));
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        inline void CacheName( char* buffer, size_t size ) const
+        {
+            _snprintf_s( buffer, size, size - 1, "%s/pkc_%016llx.pkc", CacheDir, (unsigned long long) CacheKey() );
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        // Runs the generator with the private random generator state
+        ///////////////////////////////////////////////////////////////////////
+        inline void SwapRandomState( void )
+        {
+            MTRand::uint32 state[ MTRand::SAVE ];
+            RND.save( state );
+            RND.load( RndState );
+            memcpy( RndState, state, sizeof( RndState ));
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        // Writes the state of the generator after the last cached block
+        ///////////////////////////////////////////////////////////////////////
+        void CacheState( Archive& ar )
+        {
+            ar & RndState;
+            gen_t::Serialize( ar );
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        // Restarts the traffic of the current load from the cache, or from 
+        // the private random generator seeded for this load
+        ///////////////////////////////////////////////////////////////////////
+        void RestartCache( void )
+        {
+            char   file_name[ 512 ];
+            int64u key = CacheKey();
+
+            Cache.Close();      /* an incomplete cache is discarded */
+            CacheName( file_name, sizeof( file_name ));
+
+            MTRand::uint32 state[ MTRand::SAVE ];
+            RND.save( state );
+            RND.seed( (MTRand::uint32)( key ^ ( key >> 32 )));
+
+            SetLoadReset( Load );
+            Tokens              = 0;
+            NextPacket.PcktSize = pfPcktSize();
+            NextPacket.Interval = NextPacket.PcktSize + MinIFG;
+
+            RND.save( RndState );
+            RND.load( state );
+
+            BlockCount = BlockPos = 0;
+
+            if( !Cache.OpenRead( file_name, key ) && !Cache.OpenWrite( file_name, key ))
+                MSG_WARN( "Cannot open traffic cache " << file_name );
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        // Reads or generates the next block of packets
+        ///////////////////////////////////////////////////////////////////////
+        void FillBlock( void )
+        {
+            BlockPos = 0;
+
+            if( Cache.IsReading() )
+            {
+                if( Cache.ReadBlock( Block, BlockCount, PeekNextPacket().SourceId ))
+                    return;
+
+                /* end of cached packets: continue from the saved generator state */
+                CacheState( Cache.Trailer() );
+                Cache.Close();
+            }
+
+            SwapRandomState();
+            for( BlockCount = 0; BlockCount < PACKET_CACHE_BLOCK; BlockCount++ )
+                Block[ BlockCount ] = GetNextPacket();
+            SwapRandomState();
+
+            if( Cache.IsWriting() )
+                Cache.WriteBlock( Block, BlockCount );
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        inline GEN::Packet TakeNextPacket( void )
+        {
+            if( !CacheOn )
+                return GetNextPacket();
+
+            if( BlockPos == BlockCount )
+                FillBlock();
+            return Block[ BlockPos++ ];
+        }
+
 protected:
     inline void SetNextPacketTimer( void )
     {
-        GEN::Packet nxt_pckt  = GetNextPacket();
+        GEN::Packet nxt_pckt  = TakeNextPacket();
         SClock                = DESL::AllocateEvent();
         SClock->Consumer      = this;
         SClock->Type          = EV_TIMER_NEXT_PACKET;
@@ -166,41 +471,112 @@ protected:
 
 public:
 
-    PacketSource( int16s                byte_time, 
-                  GEN::pckt_size_t      ifg, 
-                  float                 mean_burst,
-                  GEN::PF_STREAM_CTOR   pf_strm, 
-                  int16s                pool_size,
-                  GEN::load_t           load, 
-                  GEN::source_id_t      src_id,
-                  DESL::obid_t          id = 0 ) 
-    : SimBase<>( id ), PACKET_GEN( src_id, ifg, mean_burst, pf_strm, pool_size, load )
+    PacketSourceT( int16s                   byte_time, 
+                   GEN::pckt_size_t         ifg, 
+                   float                    mean_burst,
+                   typename gen_t::ctor_t   pf_strm, 
+                   int16s                   pool_size,
+                   GEN::load_t              load, 
+                   GEN::source_id_t         src_id,
+                   DESL::obid_t             id = 0 ) 
+    : SimBase<>( id ), gen_t( src_id, ifg, mean_burst, pf_strm, pool_size, load )
     {
-        SClock    = NULL;
-        ByteTime  = byte_time;
+        SClock     = NULL;
+        ByteTime   = byte_time;
+        Load       = load;
+        BlockCount = BlockPos = 0;
+
+        ParamHash  = Hash( CacheTag,  &byte_time,  sizeof( byte_time ));
+        ParamHash  = Hash( ParamHash, &ifg,        sizeof( ifg ));
+        ParamHash  = Hash( ParamHash, &mean_burst, sizeof( mean_burst ));
+        ParamHash  = Hash( ParamHash, &pool_size,  sizeof( pool_size ));
+        ParamHash  = Hash( ParamHash, &src_id,     sizeof( src_id ));
+        ParamHash  = Hash( ParamHash, &id,         sizeof( id ));
+        ParamHash  = StreamKey( ParamHash, (const S*) NULL );
+
+        if( CacheOn )
+            RestartCache();
+
         SetNextPacketTimer();   /* set timer to next packet */
     }
 
 
-    virtual ~PacketSource()    {}
+    virtual ~PacketSourceT()    {}
     ///////////////////////////////////////////////////////////////////////////
     virtual void Free( void ) 
     { 
-        PACKET_GEN::Clear();
+        CloseCache();
+        gen_t::Clear();
     }
     ///////////////////////////////////////////////////////////////////////////
     void Reset( void )
     {
         SClock = NULL;
-        PACKET_GEN::Reset();
+        if( CacheOn )
+            RestartCache();
+        else
+            gen_t::Reset();
         SetNextPacketTimer();   /* set timer to next packet */
     }
 
+    ///////////////////////////////////////////////////////////////////////////
+    // Completes the cache being written.  Must be called at the end of each 
+    // load; a cache that is not completed is discarded.
+    ///////////////////////////////////////////////////////////////////////////
+    void CloseCache( void )
+    {
+        if( Cache.IsWriting() && Cache.GetBlocks() > 0 )
+        {
+            CacheState( Cache.Trailer() );
+            if( !Cache.Commit() )
+                MSG_WARN( "Cannot write traffic cache for source " << ID );
+        }
+        Cache.Close();
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    virtual void Serialize( Archive& ar ) 
+    { 
+        int32u blocks  = Cache.GetBlocks();
+        BOOL   reading = Cache.IsReading();
+
+        SimBase<>::Serialize( ar );
+        gen_t::Serialize( ar );
+        ar & ByteTime & Load;
+        SClock = ar.IsWriting()? SClock: NULL;   /* restored in EventRestored() */
+
+        if( !CacheOn )
+            return;
+
+        ar & RndState & BlockCount & BlockPos & blocks & reading;
+        for( int32u n = 0; n < BlockCount; n++ )
+            ar & Block[n];
+
+        if( ar.IsReading() )
+        {
+            /* continue reading the cache; a cache being written is discarded */
+            char file_name[ 512 ];
+            CacheName( file_name, sizeof( file_name ));
+            Cache.Close();
+            if( reading && !( Cache.OpenRead( file_name, CacheKey() ) && Cache.SkipBlocks( blocks )))
+                MSG_WARN( "Cannot restore traffic cache " << file_name );
+        }
+    }
+    ///////////////////////////////////////////////////////////////////////////
+    virtual void EventRestored( DESL::evnt_t* pEvent ) 
+    { 
+        if( pEvent->Type == EV_TIMER_NEXT_PACKET ) 
+            SClock = pEvent;
+    }
     ///////////////////////////////////////////////////////////////////////////
     void SetLoad( GEN::load_t load )
     {
         DESL::CancelEvent( SClock );
-        SetLoadReset( load );
+        Load = load;
+        if( CacheOn )
+            RestartCache();
+        else
+            SetLoadReset( load );
         SetNextPacketTimer();   /* set timer to next packet */
     }
     
@@ -228,6 +604,8 @@ public:
     ///////////////////////////////////////////////////////////////////////////
 };
 
+typedef PacketSourceT< GEN::Stream >  PacketSource;
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ////
@@ -279,6 +657,13 @@ public:
         StreamCBR::Reset();
         SetNextPacketTimer();
     }
+    ///////////////////////////////////////////////////////////////////////////
+    virtual void Serialize( Archive& ar ) 
+    { 
+        SimBase<>::Serialize( ar );
+        StreamCBR::Serialize( ar );
+        ar & ByteTime & PcktSize & SourceId;
+    }
     
     ///////////////////////////////////////////////////////////////////////////
     inline void OutputPacket( DESL::evnt_t* pEvent ) 
@@ -305,5 +690,304 @@ public:
 };
 
 
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+////
+//// Class PacketTrace is a memory-mapped file of captured packets.
+////
+//// File layout (native byte order):
+////      PacketTraceHeader
+////      PacketTraceRecord [ Records ]
+////
+//// Records are used in place; nothing is parsed or copied when a packet 
+//// is generated.  One trace is mapped only once and shared by all 
+//// TraceSources that replay it.
+////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+const int32u PACKET_TRACE_MAGIC   = 0x52544B50;    // "PKTR"
+const int32u PACKET_TRACE_VERSION = 1;
+
+struct PacketTraceHeader
+{
+    int32u  Magic;
+    int32u  Version;
+    int64u  Records;        // number of records
+    int64u  Duration;       // sum of all intervals (ns)
+    int64u  Bytes;          // sum of all packet sizes
+};
+
+struct PacketTraceRecord
+{
+    int32u  Interval;       // time since the previous packet (ns)
+    int16u  PcktSize;       // packet size (bytes)
+    int16u  Reserved;
+};
+
+class PacketTrace
+{
+private:
+    MappedFile          File;
+    char*               FileName;
+    PacketTrace*        pNext;
+    
+    static PacketTrace* pTraces;    // all opened traces
+
+    ///////////////////////////////////////////////////////////////////////////
+    PacketTrace( const char* file_name )
+    {
+        FileName = new char[ strlen( file_name ) + 1 ];
+        memcpy( FileName, file_name, strlen( file_name ) + 1 );
+        pNext    = pTraces;
+        pTraces  = this;
+
+        if( File.Open( file_name ) && !IsValid() )
+        {
+            MSG_WARN( "Invalid packet trace " << file_name );
+            File.Close();
+        }
+    }
+
+    ~PacketTrace()  { delete [] FileName; }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline BOOL IsValid( void ) const
+    {
+        const PacketTraceHeader* hdr = GetHeader();
+        return File.GetSize() >= sizeof( PacketTraceHeader )
+            && hdr->Magic   == PACKET_TRACE_MAGIC 
+            && hdr->Version == PACKET_TRACE_VERSION
+            && hdr->Records >  0
+            && hdr->Records <= ( File.GetSize() - sizeof( PacketTraceHeader )) / sizeof( PacketTraceRecord )
+            && hdr->Duration > 0;
+    }
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    // Returns the shared trace mapped from given file
+    ///////////////////////////////////////////////////////////////////////////
+    static PacketTrace* Get( const char* file_name )
+    {
+        for( PacketTrace* ptr = pTraces; ptr; ptr = ptr->pNext )
+            if( strcmp( ptr->FileName, file_name ) == 0 )
+                return ptr;
+
+        return new PacketTrace( file_name );
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    static void ReleaseAll( void )
+    {
+        while( pTraces )
+        {
+            PacketTrace* ptr = pTraces;
+            pTraces = ptr->pNext;
+            delete ptr;
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    inline BOOL IsOpen( void ) const    { return File.IsOpen(); }
+
+    inline const PacketTraceHeader* GetHeader( void ) const  
+    { 
+        return (const PacketTraceHeader*) File.GetData(); 
+    }
+
+    inline const PacketTraceRecord* GetRecords( void ) const  
+    { 
+        return (const PacketTraceRecord*)( File.GetData() + sizeof( PacketTraceHeader )); 
+    }
+
+    inline void Prefetch( const PacketTraceRecord* ptr, int64u count ) const
+    {
+        File.Prefetch( ptr, count * sizeof( PacketTraceRecord ));
+    }
+};
+
+/** Initialize static members **************************************/
+PacketTrace* PacketTrace::pTraces = NULL;
+/*******************************************************************/
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+////
+//// Class TraceSource replays packets from a PacketTrace.
+////
+//// The trace is split into 'shards' equal slices; the source replays 
+//// slice 'shard' and starts over when it reaches the end of the slice 
+//// (or stops, if 'loop' is FALSE).  Intervals are scaled so that the 
+//// source generates given load; the native load of the trace is taken 
+//// from the trace header.
+////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+const int32u TRACE_PREFETCH_RECORDS = 1 << 16;    // read-ahead distance
+
+class TraceSource : public SimBase<>
+{
+private:    
+    DESL::evnt_t*               SClock;
+    int32u                      ByteTime;
+    GEN::pckt_size_t            Overhead;
+    GEN::source_id_t            SourceId;
+    BOOL                        Loop;
+
+    const PacketTrace*          pTrace;
+    const PacketTraceRecord*    pFirst;     // first record of the shard
+    const PacketTraceRecord*    pLast;      // end of the shard
+    const PacketTraceRecord*    pNextRec;   // next record to replay
+    const PacketTraceRecord*    pPrefetch;  // next prefetch position
+
+    DOUBLE                      NativeLoad; // load of the trace without scaling
+    DOUBLE                      Scale;      // interval scaling factor
+    DOUBLE                      Carry;      // fraction of ns left from the last interval
+
+protected:
+    inline void SetNextPacketTimer( void )
+    {
+        if( pNextRec == pLast )
+        {
+            if( !Loop || pFirst == pLast )
+            {
+                SClock = NULL;      /* end of trace */
+                return;
+            }
+            pNextRec = pPrefetch = pFirst;
+        }
+
+        if( pNextRec == pPrefetch )
+        {
+            pPrefetch = MIN< const PacketTraceRecord* >( pPrefetch + TRACE_PREFETCH_RECORDS, pLast );
+            pTrace->Prefetch( pPrefetch, TRACE_PREFETCH_RECORDS );
+        }
+
+        const PacketTraceRecord* rec = pNextRec++;
+
+        DOUBLE       interval = rec->Interval * Scale + Carry;
+        DESL::time_t delay    = (DESL::time_t) interval;
+        Carry                 = interval - delay;
+
+        SClock                = DESL::AllocateEvent();
+        SClock->Consumer      = this;
+        SClock->Type          = EV_TIMER_NEXT_PACKET;
+        SClock->Pckt.PcktTime = DESL::GlobalTime() + delay;
+        SClock->Pckt.PcktSize = rec->PcktSize;
+        SClock->Pckt.SourceId = SourceId;
+
+        RegisterEvent( SClock, delay );
+    }
+
+public:
+
+    TraceSource( int16s                 byte_time, 
+                 GEN::pckt_size_t       ifg, 
+                 const char*            file_name,
+                 int32u                 shard,
+                 int32u                 shards,
+                 BOOL                   loop,
+                 GEN::load_t            load, 
+                 GEN::source_id_t       src_id,
+                 DESL::obid_t           id = 0 ) 
+    : SimBase<>( id )
+    {
+        SClock     = NULL;
+        ByteTime   = byte_time;
+        Overhead   = ifg;
+        SourceId   = src_id;
+        Loop       = loop;
+        pTrace     = PacketTrace::Get( file_name );
+        pFirst     = pLast = NULL;
+        NativeLoad = 1.0;
+        Carry      = 0.0;
+
+        if( pTrace->IsOpen() )
+        {
+            const PacketTraceHeader* hdr = pTrace->GetHeader();
+
+            pFirst     = pTrace->GetRecords() + hdr->Records * shard / shards;
+            pLast      = pTrace->GetRecords() + hdr->Records * ( shard + 1 ) / shards;
+            NativeLoad = (DOUBLE)( hdr->Bytes + hdr->Records * ifg ) * byte_time / hdr->Duration;
+        }
+        else
+            MSG_WARN( "Cannot open packet trace " << file_name );
+
+        Scale = NativeLoad / load;
+        Reset();
+    }
+
+
+    virtual ~TraceSource()    {}
+    ///////////////////////////////////////////////////////////////////////////
+    virtual void Free( void ) 
+    { 
+    }
+    ///////////////////////////////////////////////////////////////////////////
+    void Reset( void )
+    {
+        SClock   = NULL;
+        Carry    = 0.0;
+        pNextRec = pPrefetch = pFirst;
+        SetNextPacketTimer();   /* set timer to next packet */
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    virtual void Serialize( Archive& ar ) 
+    { 
+        int64u position = pNextRec - pFirst;
+        int64u prefetch = pPrefetch - pFirst;
+
+        SimBase<>::Serialize( ar );
+        ar & position & prefetch & Scale & Carry;
+
+        pNextRec  = pFirst + position;
+        pPrefetch = pFirst + prefetch;
+        SClock    = ar.IsWriting()? SClock: NULL;   /* restored in EventRestored() */
+    }
+    ///////////////////////////////////////////////////////////////////////////
+    virtual void EventRestored( DESL::evnt_t* pEvent ) 
+    { 
+        if( pEvent->Type == EV_TIMER_NEXT_PACKET ) 
+            SClock = pEvent;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+    inline void CloseCache( void )  {}    /* traces are not cached */
+    ///////////////////////////////////////////////////////////////////////////
+    void SetLoad( GEN::load_t load )
+    {
+        DESL::CancelEvent( SClock );
+        Scale = NativeLoad / load;
+        SetNextPacketTimer();   /* set timer to next packet */
+    }
+    
+    ///////////////////////////////////////////////////////////////////////////
+    inline void OutputPacket( DESL::evnt_t* pEvent ) 
+    {
+        if( pEvent == SClock )
+        {
+            pEvent->Type     = EV_PCKT_ARRIVAL;   /* change pEvent into 'arrival' event */
+            pEvent->Consumer = OutPort[0];
+
+            RegisterEvent( pEvent, 0 );           /* send immediate arrival event */ 
+            SetNextPacketTimer();                 /* set timer to next packet */                           
+        }
+    }    
+    ////////////////////////////////////////////////////////////////////////////////
+
+    virtual void ProcessEvent( DESL::evnt_t* pEvent ) 
+    {
+        if( pEvent->Type == EV_TIMER_NEXT_PACKET )
+            OutputPacket( pEvent );
+        else
+            MSG_WARN( "Unhandled event in class TraceSource (Type = " << pEvent->Type << " )" );
+    }    
+    ///////////////////////////////////////////////////////////////////////////
+};
+
+
 
 #endif // _PACKET_SOURCE_H_INCLUDED_
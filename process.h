@@ -0,0 +1,469 @@
+/////////////////////////////////////////////////////////////////////
+// Filename:    process.h
+//
+// Description: This file contains declarations for
+//                  class PROC::FramePool
+//                  class PROC::Task
+//                  class SimProcess
+//
+//              Process-oriented modelling with C++20 coroutines: the
+//              behaviour of a SimProcess is written sequentially in
+//              its Run() coroutine, which waits with
+//
+//                  co_await Delay( interval );
+//                  DESL::evnt_t* ev = co_await Receive( type );
+//                  co_await SubProcedure();    // another PROC::Task
+//
+//              Each process owns one timer event that is held between
+//              delays (DESL::HoldEvent), coroutine frames are recycled
+//              by PROC::FramePool, and events that arrive while the
+//              process does not wait for them are held in a mailbox
+//              that grows by doubling.  After warm-up, waiting does
+//              not allocate memory or events.
+/////////////////////////////////////////////////////////////////////
+
+#ifndef _PROCESS_H_INCLUDED_
+#define _PROCESS_H_INCLUDED_
+
+#include <coroutine>
+#include <exception>
+#include <new>
+
+
+namespace PROC
+{
+    /////////////////////////////////////////////////////////////////
+    // CLASS:        class FramePool
+    // PURPOSE:      Keeps the frames of finished coroutines for reuse.
+    //               Free frames are kept in lists by size, in units
+    //               of UNIT bytes; larger frames are not kept.
+    /////////////////////////////////////////////////////////////////
+    class FramePool
+    {
+    private:
+        enum { UNIT = 64, CLASSES = 64 };
+
+        struct Frame { Frame* pNext; };
+
+        static inline Frame*    FreeList[ CLASSES ] = {};
+
+        static inline size_t    SizeClass( size_t size ) { return ( size + UNIT - 1 ) / UNIT; }
+
+    public:
+        /////////////////////////////////////////////////////////////
+        static void* Allocate( size_t size )
+        {
+            size_t cls = SizeClass( size );
+            if( cls >= CLASSES )
+                return ::operator new( size );
+
+            Frame* frame = FreeList[ cls ];
+            if( frame == NULL )
+                return ::operator new( cls * UNIT );
+
+            FreeList[ cls ] = frame->pNext;
+            return frame;
+        }
+
+        /////////////////////////////////////////////////////////////
+        static void Free( void* ptr, size_t size )
+        {
+            size_t cls = SizeClass( size );
+            if( cls >= CLASSES )
+            {
+                ::operator delete( ptr );
+                return;
+            }
+
+            Frame* frame    = static_cast< Frame* >( ptr );
+            frame->pNext    = FreeList[ cls ];
+            FreeList[ cls ] = frame;
+        }
+
+        /////////////////////////////////////////////////////////////
+        // Returns all free frames to the heap
+        /////////////////////////////////////////////////////////////
+        static void Clear( void )
+        {
+            for( int32s cls = 0; cls < CLASSES; cls++ )
+                while( FreeList[ cls ] )
+                {
+                    Frame* frame    = FreeList[ cls ];
+                    FreeList[ cls ] = frame->pNext;
+                    ::operator delete( frame );
+                }
+        }
+    };
+
+
+    /////////////////////////////////////////////////////////////////
+    // CLASS:        class Task
+    // PURPOSE:      Coroutine that is started suspended and owns its
+    //               frame.  A coroutine awaiting a Task runs it to
+    //               completion and continues after it (the Task is a
+    //               sub-procedure of the awaiting coroutine).
+    /////////////////////////////////////////////////////////////////
+    class Task
+    {
+    public:
+        struct promise_type;
+        typedef std::coroutine_handle< promise_type > handle_t;
+
+        /////////////////////////////////////////////////////////////
+        // Resumes the awaiting coroutine when the task completes
+        /////////////////////////////////////////////////////////////
+        struct FinalAwaiter
+        {
+            bool await_ready( void ) noexcept   { return false; }
+            void await_resume( void ) noexcept  {}
+
+            std::coroutine_handle<> await_suspend( handle_t h ) noexcept
+            {
+                std::coroutine_handle<> next = h.promise().Continuation;
+                return next? next: std::noop_coroutine();
+            }
+        };
+
+        /////////////////////////////////////////////////////////////
+        struct promise_type
+        {
+            std::coroutine_handle<> Continuation;
+
+            static void* operator new( size_t size )                { return FramePool::Allocate( size ); }
+            static void  operator delete( void* ptr, size_t size )  { FramePool::Free( ptr, size );       }
+
+            Task                get_return_object( void )           { return Task( handle_t::from_promise( *this )); }
+            std::suspend_always initial_suspend( void ) noexcept    { return {}; }
+            FinalAwaiter        final_suspend( void ) noexcept      { return {}; }
+            void                return_void( void )                 {}
+            void                unhandled_exception( void )         { std::terminate(); }
+        };
+
+    private:
+        handle_t    hCoro;
+
+        explicit Task( handle_t h ) : hCoro( h ) {}
+
+    public:
+        Task() : hCoro( nullptr )                   {}
+        Task( Task&& task ) : hCoro( task.hCoro )   { task.hCoro = nullptr; }
+        Task( const Task& )                         = delete;
+        ~Task()                                     { Destroy(); }
+
+        Task& operator= ( Task&& task )
+        {
+            if( this != &task )
+            {
+                Destroy();
+                hCoro      = task.hCoro;
+                task.hCoro = nullptr;
+            }
+            return *this;
+        }
+
+        /////////////////////////////////////////////////////////////
+        inline void Destroy( void )
+        {
+            if( hCoro )
+                hCoro.destroy();
+            hCoro = nullptr;
+        }
+
+        inline BOOL                     IsValid( void ) const   { return hCoro? TRUE: FALSE; }
+        inline BOOL                     IsDone( void ) const    { return hCoro && hCoro.done(); }
+        inline std::coroutine_handle<>  GetHandle( void ) const { return hCoro; }
+
+        /////////////////////////////////////////////////////////////
+        // Awaiting a task starts it; the awaiting coroutine continues
+        // when the task completes
+        /////////////////////////////////////////////////////////////
+        bool await_ready( void ) const              { return !hCoro || hCoro.done(); }
+        void await_resume( void ) const             {}
+
+        std::coroutine_handle<> await_suspend( std::coroutine_handle<> caller )
+        {
+            hCoro.promise().Continuation = caller;
+            return hCoro;
+        }
+    };
+}   // namespace PROC
+
+
+
+
+/////////////////////////////////////////////////////////////////////
+// CLASS:        template < int16u PORTS = 1 > class SimProcess
+// PURPOSE:      Base class for simulation objects whose behaviour is
+//               a coroutine.  Run() is started by Start() and resumed
+//               when its timer expires or when an event it waits for
+//               arrives.  Events that arrive while the process does
+//               not wait for them are kept in the mailbox and taken
+//               by a later Receive() in order of arrival; a derived
+//               class may handle some events in its own ProcessEvent
+//               and pass the rest to SimProcess::ProcessEvent.
+// NOTES:        An event returned by Receive() is valid until the
+//               next co_await; the process may register it again
+//               (e.g., forward it to an output port) before that.
+//               The state of a suspended coroutine is not saved in a
+//               checkpoint.
+/////////////////////////////////////////////////////////////////////
+const int16s    ANY_EVENT   = -1;           // Receive() any event type
+
+template < int16u PORTS = 1 > class SimProcess : public SimBase< PORTS >
+{
+private:
+    enum { WAIT_NONE, WAIT_TIMER, WAIT_EVENT, MAILBOX_SIZE = 16 };
+
+    PROC::Task              Body;           // the Run() coroutine
+    std::coroutine_handle<> hWaiting;       // innermost suspended coroutine
+    int16s                  WaitState;
+    int16s                  WaitType;       // event type expected by Receive()
+
+    DESL::evnt_t*           pTimer;         // timer event (held between delays)
+    DESL::evnt_t*           pReceived;      // event returned by Receive()
+    BOOL                    bOwned;         // pReceived was taken from the mailbox
+
+    DESL::evnt_t**          Mailbox;        // held events, in order of arrival
+    int32s                  MailSize;
+    int32s                  MailCount;
+
+    /////////////////////////////////////////////////////////////////
+    // Destroys the event returned by the previous Receive(), unless
+    // it was registered again.  Events dispatched to the process are
+    // destroyed by DispatchEvent.
+    /////////////////////////////////////////////////////////////////
+    inline void Discard( void )
+    {
+        if( bOwned )
+            DESL::DestroyEvent( pReceived );
+        pReceived = NULL;
+        bOwned    = FALSE;
+    }
+
+    /////////////////////////////////////////////////////////////////
+    inline void PutMail( DESL::evnt_t* pEvent )
+    {
+        if( MailCount == MailSize )
+        {
+            DESL::evnt_t** mailbox = new DESL::evnt_t*[ MailSize * 2 ];
+            memcpy( mailbox, Mailbox, MailCount * sizeof( DESL::evnt_t* ));
+            delete [] Mailbox;
+            Mailbox   = mailbox;
+            MailSize *= 2;
+        }
+        DESL::HoldEvent( pEvent );
+        Mailbox[ MailCount++ ] = pEvent;
+    }
+
+    /////////////////////////////////////////////////////////////////
+    // Takes the first event of the given type from the mailbox
+    /////////////////////////////////////////////////////////////////
+    inline BOOL TakeMail( int16s type )
+    {
+        for( int32s n = 0; n < MailCount; n++ )
+            if( type == ANY_EVENT || Mailbox[n]->Type == type )
+            {
+                pReceived = Mailbox[n];
+                bOwned    = TRUE;
+                DESL::ReleaseEvent( pReceived );
+
+                memmove( Mailbox + n, Mailbox + n + 1, ( MailCount - n - 1 ) * sizeof( DESL::evnt_t* ));
+                MailCount--;
+                return TRUE;
+            }
+        return FALSE;
+    }
+
+    /////////////////////////////////////////////////////////////////
+    inline void Wait( std::coroutine_handle<> h, int16s state, int16s type = ANY_EVENT )
+    {
+        hWaiting  = h;
+        WaitState = state;
+        WaitType  = type;
+    }
+
+    /////////////////////////////////////////////////////////////////
+    inline void Resume( void )
+    {
+        std::coroutine_handle<> h = hWaiting;
+
+        hWaiting  = nullptr;
+        WaitState = WAIT_NONE;
+        h.resume();
+
+        if( Body.IsDone())
+        {
+            Discard();
+            Body.Destroy();
+        }
+    }
+
+    /////////////////////////////////////////////////////////////////
+    inline void StartTimer( DESL::time_t interval )
+    {
+        if( pTimer == NULL )
+        {
+            pTimer           = DESL::AllocateEvent();
+            pTimer->Consumer = this;
+        }
+        else
+            DESL::ReleaseEvent( pTimer );
+
+        this->RegisterEvent( pTimer, interval );
+    }
+
+protected:
+    /////////////////////////////////////////////////////////////////
+    // Awaitable returned by Delay()
+    /////////////////////////////////////////////////////////////////
+    struct DelayAwaiter
+    {
+        SimProcess*     pProc;
+        DESL::time_t    Interval;
+
+        bool await_ready( void )                        { pProc->Discard(); return false; }
+        void await_resume( void )                       {}
+        void await_suspend( std::coroutine_handle<> h )
+        {
+            pProc->StartTimer( Interval );
+            pProc->Wait( h, WAIT_TIMER );
+        }
+    };
+
+    /////////////////////////////////////////////////////////////////
+    // Awaitable returned by Receive()
+    /////////////////////////////////////////////////////////////////
+    struct ReceiveAwaiter
+    {
+        SimProcess*     pProc;
+        int16s          Type;
+
+        bool          await_ready( void )                       { pProc->Discard(); return pProc->TakeMail( Type ) == TRUE; }
+        void          await_suspend( std::coroutine_handle<> h ){ pProc->Wait( h, WAIT_EVENT, Type ); }
+        DESL::evnt_t* await_resume( void )                      { return pProc->pReceived; }
+    };
+
+    /////////////////////////////////////////////////////////////////
+    // METHOD:       DelayAwaiter Delay( DESL::time_t interval )
+    // PURPOSE:      co_await Delay( interval ) suspends the process
+    //               for the interval (local time)
+    /////////////////////////////////////////////////////////////////
+    inline DelayAwaiter Delay( DESL::time_t interval )      { return DelayAwaiter{ this, interval }; }
+
+    /////////////////////////////////////////////////////////////////
+    // METHOD:       DelayAwaiter DelayUntil( DESL::time_t localtime )
+    // PURPOSE:      co_await DelayUntil( localtime ) suspends the
+    //               process until the given local time
+    /////////////////////////////////////////////////////////////////
+    inline DelayAwaiter DelayUntil( DESL::time_t localtime ) { return Delay( localtime - this->LocalTime()); }
+
+    /////////////////////////////////////////////////////////////////
+    // METHOD:       ReceiveAwaiter Receive( int16s type )
+    // PURPOSE:      co_await Receive( type ) suspends the process
+    //               until an event of the type (or of any type) is
+    //               received, and returns the event
+    /////////////////////////////////////////////////////////////////
+    inline ReceiveAwaiter Receive( int16s type = ANY_EVENT ) { return ReceiveAwaiter{ this, type }; }
+
+    /////////////////////////////////////////////////////////////////
+    // METHOD:       PROC::Task Run( void )
+    // PURPOSE:      Behaviour of the process
+    /////////////////////////////////////////////////////////////////
+    virtual PROC::Task Run( void ) = 0;
+
+public:
+    /////////////////////////////////////////////////////////////////
+    SimProcess( DESL::obid_t id = 0, int16u ports = PORTS ) : SimBase< PORTS >( id, ports )
+    {
+        hWaiting  = nullptr;
+        WaitState = WAIT_NONE;
+        WaitType  = ANY_EVENT;
+        pTimer    = NULL;
+        pReceived = NULL;
+        bOwned    = FALSE;
+        MailSize  = MAILBOX_SIZE;
+        MailCount = 0;
+        Mailbox   = new DESL::evnt_t*[ MailSize ];
+    }
+
+    virtual ~SimProcess()
+    {
+        Body.Destroy();
+        delete [] Mailbox;
+    }
+
+    /////////////////////////////////////////////////////////////////
+    // METHOD:       void Start( void )
+    // PURPOSE:      Stops the process if it is running, creates the
+    //               Run() coroutine and runs it to the first co_await
+    /////////////////////////////////////////////////////////////////
+    void Start( void )
+    {
+        Stop();
+        Body     = Run();
+        hWaiting = Body.GetHandle();
+        Resume();
+    }
+
+    /////////////////////////////////////////////////////////////////
+    // METHOD:       void Stop( void )
+    // PURPOSE:      Destroys the coroutine, the timer event, and the
+    //               events in the mailbox.  A pending timer event is
+    //               canceled and destroyed when it is dispatched.
+    /////////////////////////////////////////////////////////////////
+    void Stop( void )
+    {
+        Body.Destroy();
+        Discard();
+
+        if( WaitState == WAIT_TIMER )
+            DESL::CancelEvent( pTimer );
+        else if( pTimer )
+        {
+            DESL::ReleaseEvent( pTimer );
+            DESL::DestroyEvent( pTimer );
+        }
+        pTimer = NULL;
+
+        while( MailCount )
+        {
+            DESL::evnt_t* pEvent = Mailbox[ --MailCount ];
+            DESL::ReleaseEvent( pEvent );
+            DESL::DestroyEvent( pEvent );
+        }
+
+        hWaiting  = nullptr;
+        WaitState = WAIT_NONE;
+    }
+
+    inline BOOL IsRunning( void ) const     { return Body.IsValid(); }
+
+    /////////////////////////////////////////////////////////////////
+    // METHOD:       void ProcessEvent( DESL::evnt_t* pEvent )
+    // PURPOSE:      Resumes the process on its timer or on an event
+    //               it waits for; keeps other events in the mailbox
+    /////////////////////////////////////////////////////////////////
+    virtual void ProcessEvent( DESL::evnt_t* pEvent )
+    {
+        if( pEvent == pTimer )
+        {
+            DESL::HoldEvent( pEvent );
+            if( WaitState == WAIT_TIMER )
+                Resume();
+        }
+        else if( WaitState == WAIT_EVENT && ( WaitType == ANY_EVENT || pEvent->Type == WaitType ))
+        {
+            pReceived = pEvent;
+            bOwned    = FALSE;
+            Resume();
+        }
+        else
+            PutMail( pEvent );
+    }
+
+    virtual void Free( void )   { Stop(); }
+    virtual void Reset( void )  { Stop(); }
+};
+
+
+#endif // _PROCESS_H_INCLUDED_
@@ -0,0 +1,191 @@
+/**********************************************************
+ * Filename:    process_test.cpp
+ *
+ * Description: Test of class SimProcess (process.h):
+ *              Receive( type ) takes only events of the type,
+ *              events that arrive while the process does not
+ *              wait for them are kept in the mailbox and taken
+ *              in order of arrival, and the mailbox grows beyond
+ *              its initial size.
+ *
+ * Usage:       process_test
+ *
+ *              Prints the first mismatch and returns 1 if the
+ *              test fails.  Run by ctest.
+ *********************************************************/
+
+#include <time.h>
+#include <iostream>
+
+using namespace std;
+
+#include "_types.h"
+#include "_util.h"
+#include "sim_config.h"
+
+
+/////////////////////////////////////////////////////////////////////
+// Test Parameters
+/////////////////////////////////////////////////////////////////////
+const int32s        TEST_BURST          = 40;       // events held in the mailbox at once (> MAILBOX_SIZE)
+const DESL::time_t  TEST_BURST_TIME     = 1000;     // time of the first event of the burst
+const DESL::time_t  TEST_BURST_DELAY    = 2000;     // Delay() of the process while the burst arrives
+const int32s        TEST_MAX_RECORDS    = 64;
+
+
+/////////////////////////////////////////////////////////////////////
+// CLASS:        class Sender
+// PURPOSE:      Sends events of a given type to its output port at
+//               given times; the tag of an event is its PcktSize
+/////////////////////////////////////////////////////////////////////
+class Sender : public SimBase<>
+{
+public:
+    Sender() : SimBase<>( 0 ) {}
+
+    void Send( DESL::time_t time, int8s type, int32s tag )
+    {
+        DESL::evnt_t* ptr  = DESL::AllocateEvent();
+        ptr->Type          = type;
+        ptr->Pckt.PcktSize = tag;
+        ptr->Consumer      = OutPort[0];
+        RegisterEventAbs( ptr, time );
+    }
+
+    virtual void ProcessEvent( DESL::evnt_t* )          {}
+    virtual void Free( void )                           {}
+    virtual void Reset( void )                          {}
+};
+
+
+/////////////////////////////////////////////////////////////////////
+// CLASS:        class Receiver
+// PURPOSE:      Receives events in a fixed order of types and
+//               records the tag and the time of each one
+/////////////////////////////////////////////////////////////////////
+class Receiver : public SimProcess<>
+{
+public:
+    struct Record
+    {
+        int8s           Type;
+        int32s          Tag;
+        DESL::time_t    Time;
+    };
+
+    Record  Log[ TEST_MAX_RECORDS ];
+    int32s  Count;
+
+private:
+    inline void Add( DESL::evnt_t* pEvent )
+    {
+        if( Count < TEST_MAX_RECORDS )
+            Log[ Count++ ] = Record{ pEvent->Type, pEvent->Pckt.PcktSize, DESL::GlobalTime() };
+    }
+
+    virtual PROC::Task Run( void )
+    {
+        /* filtering: the GATE is received after the events sent before it */
+        Add( co_await Receive( EV_MPCP_GATE ));
+
+        /* mailbox: the held packets in order of arrival, then any event */
+        Add( co_await Receive( EV_PCKT_ARRIVAL ));
+        Add( co_await Receive( EV_PCKT_ARRIVAL ));
+        Add( co_await Receive());
+
+        /* empty mailbox: wait for the next packet */
+        Add( co_await Receive( EV_PCKT_ARRIVAL ));
+
+        /* the burst arrives during the delay and is held in the mailbox */
+        co_await DelayUntil( TEST_BURST_DELAY );
+        for( int32s n = 0; n < TEST_BURST / 2; n++ )
+            Add( co_await Receive( EV_MPCP_REPORT ));
+        for( int32s n = 0; n < TEST_BURST / 2; n++ )
+            Add( co_await Receive( EV_PCKT_ARRIVAL ));
+    }
+
+public:
+    Receiver() : SimProcess<>( 0 )   { Count = 0; }
+};
+
+
+/********************************************************************/
+/********************************************************************/
+int main( void )
+{
+    InitAllocator();
+    START_LOG();
+
+    Sender*   pSender   = new Sender;
+    Receiver* pReceiver = new Receiver;
+    pSender->SetPort( pReceiver );
+
+    DESL::GlobalReset();
+    pReceiver->Start();
+
+    ////////////////////////////////////////////////////////////
+    // Events and the expected order of reception
+    ////////////////////////////////////////////////////////////
+    Receiver::Record expected[ TEST_MAX_RECORDS ];
+    int32s           count = 0;
+
+    pSender->Send( 10, EV_PCKT_ARRIVAL, 1 );
+    pSender->Send( 20, EV_MPCP_REPORT,  2 );
+    pSender->Send( 30, EV_PCKT_ARRIVAL, 3 );
+    pSender->Send( 40, EV_MPCP_GATE,    4 );
+    pSender->Send( 50, EV_PCKT_ARRIVAL, 5 );
+
+    expected[ count++ ] = Receiver::Record{ EV_MPCP_GATE,    4, 40 };
+    expected[ count++ ] = Receiver::Record{ EV_PCKT_ARRIVAL, 1, 40 };
+    expected[ count++ ] = Receiver::Record{ EV_PCKT_ARRIVAL, 3, 40 };
+    expected[ count++ ] = Receiver::Record{ EV_MPCP_REPORT,  2, 40 };
+    expected[ count++ ] = Receiver::Record{ EV_PCKT_ARRIVAL, 5, 50 };
+
+    /* alternating types; REPORTs are received first, then packets */
+    for( int32s n = 0; n < TEST_BURST; n++ )
+        pSender->Send( TEST_BURST_TIME + n, ( n & 1 )? EV_PCKT_ARRIVAL: EV_MPCP_REPORT, 100 + n );
+
+    for( int32s n = 0; n < TEST_BURST; n += 2 )
+        expected[ count++ ] = Receiver::Record{ EV_MPCP_REPORT, 100 + n, TEST_BURST_DELAY };
+    for( int32s n = 1; n < TEST_BURST; n += 2 )
+        expected[ count++ ] = Receiver::Record{ EV_PCKT_ARRIVAL, 100 + n, TEST_BURST_DELAY };
+
+    ////////////////////////////////////////////////////////////
+    // Simulate until the event queue is empty
+    ////////////////////////////////////////////////////////////
+    DESL::evnt_t* pEvent;
+    while( ( pEvent = DESL::GetNextEvent()) != NULL )
+        DESL::DispatchEvent( pEvent );
+
+    ////////////////////////////////////////////////////////////
+    // Compare
+    ////////////////////////////////////////////////////////////
+    int32s failed = pReceiver->IsRunning() || pReceiver->Count != count;
+
+    for( int32s n = 0; n < count && n < pReceiver->Count && !failed; n++ )
+    {
+        const Receiver::Record& rec = pReceiver->Log[n];
+        if( rec.Type != expected[n].Type || rec.Tag != expected[n].Tag || rec.Time != expected[n].Time )
+        {
+            printf( "FAIL: event %d: type 0x%02X tag %d time %lld, expected type 0x%02X tag %d time %lld\n",
+                    n, rec.Type, rec.Tag, (long long) rec.Time,
+                    expected[n].Type, expected[n].Tag, (long long) expected[n].Time );
+            failed = 1;
+        }
+    }
+
+    if( failed && pReceiver->Count != count )
+        printf( "FAIL: %d events received, expected %d\n", pReceiver->Count, count );
+    else if( failed && pReceiver->IsRunning() )
+        printf( "FAIL: process did not complete\n" );
+    else if( !failed )
+        printf( "OK: %d events received\n", count );
+
+    DESL::GlobalFree();
+    delete pReceiver;
+    delete pSender;
+    PROC::FramePool::Clear();
+
+    STOP_LOG();
+    return failed;
+}
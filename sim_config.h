@@ -15,7 +15,8 @@
 ///////////////////////////////////////////////////////////
 //  Output options
 ///////////////////////////////////////////////////////////
-#define STOP_ON_WARNING
+//#define STOP_ON_WARNING
+#define WARNING_RATE_LIMIT  100     // warnings per second; excess warnings are only counted
 
 #define WARNING_OUTPUT_FILE 
 #define WARNING_OUTPUT_SCREEN
@@ -36,6 +37,7 @@ const int16s  OLT_BASE_ID               = 0x0100;
 const int16s  ONU_BASE_ID               = 0x1000;
 const int16s  LNK_BASE_ID               = 0x2000;
 const int16s  SRC_BASE_ID               = 0x4000;
+const int16s  DSR_BASE_ID               = SRC_BASE_ID | LNK_BASE_ID;  // downstream sources (at the OLT)
 
 
 ///////////////////////////////////////////////////////////
@@ -45,6 +47,7 @@ const int8s  EV_PCKT_ARRIVAL                = 0x01;
 const int8s  EV_PCKT_ENQUE                  = 0x03;
 const int8s  EV_PCKT_DEQUE                  = 0x04;
 const int8s  EV_PCKT_DROP                   = 0x05;
+const int8s  EV_PCKT_BROADCAST              = 0x06;   // downstream frame (see Splitter in link.h)
 
 const int8s  EV_MPCP_GATE                   = 0x10;
 const int8s  EV_MPCP_REPORT                 = 0x11;
@@ -53,11 +56,21 @@ const int8s  EV_TIMER_NEXT_PACKET           = 0x20;
 const int8s  EV_TIMER_GRANT_REPORT          = 0x21;
 const int8s  EV_TIMER_GRANT_DATA            = 0x22;
 
+const int8s  EV_IDLE_ARRIVAL                = 0x30;   // first packet at an ONU with fast-forwarded idle cycles (olt.h)
+const int8s  EV_TIMER_IDLE_REPORT           = 0x31;   // REPORT of the last fast-forwarded idle cycle
 
+
+#include <string.h>
 #include "sim_output.h"
 #include "trf_gen_v3.h"
 #include "desl.h"
 
+/////////////////////////////////////////////////////////////////////
+// Event data are packed on 4-byte boundary, so that they take 24 
+// bytes and an event fits into one cache line (see desl.h)
+/////////////////////////////////////////////////////////////////////
+#pragma pack( push, 4 )
+
 /////////////////////////////////////////////////////////////////////
 // Format of a data packet
 /////////////////////////////////////////////////////////////////////
@@ -66,6 +79,7 @@ struct Pckt_Data_t
     int64s           PcktTime;
     GEN::pckt_size_t PcktSize;
     GEN::source_id_t SourceId;
+    int16u           LLID;          // destination of a downstream frame
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -88,6 +102,15 @@ struct RPRT_Data_t
 };
 
 
+/////////////////////////////////////////////////////////////////////
+// Format of the events of fast-forwarded idle cycles (see olt.h)
+/////////////////////////////////////////////////////////////////////
+struct IDLE_Data_t
+{
+    int16u      Port;           // OLT port of the ONU
+};
+
+
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 //
@@ -103,15 +126,20 @@ struct EventData
         Pckt_Data_t     Pckt;           /* data associated with a data packet       */
         GATE_Data_t     GATE;           /* data associated with a GATE message      */
         RPRT_Data_t     RPRT;           /* data associated with a REPORT message    */
+        IDLE_Data_t     IDLE;           /* data associated with an idle cycle       */
     };
 };
 
+#pragma pack( pop )
+
 // Disable W4-level warning that class 'DESL' can never be instantiated -
 // this behavior is by design
 #pragma warning( disable : 4610 )
 
 class DESL : public DESL_environment< int64s, EventData > {};
 
+static_assert( sizeof( DESL::evnt_t ) == DESL::EVENT_ALIGN, "event does not fit into one cache line" );
+
 
 
 ///////////////////////////////////////////////////////////
@@ -130,9 +158,11 @@ template < int16u PORTS = 1 > class SimBase :
     public MultiPort< PORTS >
 {
 public:
-    SimBase( DESL::obid_t id = 0 ): CClockSync( id ), MultiPort< PORTS >() {} 
+    SimBase( DESL::obid_t id = 0, int16u ports = PORTS ): CClockSync( id ), MultiPort< PORTS >( ports ) {} 
 };
 
+#include "process.h"
+
 
 
 ///////////////////////////////////////////////////////////
@@ -193,6 +223,7 @@ const GEN::pckt_size_t  PACKET_OVERHEAD     = PREAMBLE_SIZE + MIN_IFG_SIZE;
 #define _ONU_ID( N )                                ( (N) ^ ONU_BASE_ID )
 #define _LNK_ID( N )                                ( (N) ^ LNK_BASE_ID )
 #define _SRC_ID( N )                                ( (N) ^ SRC_BASE_ID )
+#define _DSR_ID( N )                                ( (N) ^ DSR_BASE_ID )
 
 
 ///////////////////////////////////////////////////////////
@@ -214,8 +245,8 @@ const GEN::pckt_size_t  PACKET_OVERHEAD     = PREAMBLE_SIZE + MIN_IFG_SIZE;
 ///////////////////////////////////////////////////////////
 #include "link.h"
 #include "pktsrc.h"
-#include "ONU.h"
-#include "OLT.h"
+#include "onu.h"
+#include "olt.h"
 
 
 ///////////////////////////////////////////////////////////
@@ -236,8 +267,37 @@ const GEN::pckt_size_t  PACKET_OVERHEAD     = PREAMBLE_SIZE + MIN_IFG_SIZE;
 // ARGUMENTS:    
 // RETURN VALUE: 
 ////////////////////////////////////////////////////////////////
-int Simulation( int, char* [] )
+int Simulation( int argc, char* argv[] )
 {
+    const char* name        = ( argc > 1 && argv[1][0] != '-' )? argv[1]: "EPON";
+    const char* resume_file = NULL;
+    int32s      num_llid    = Topology.NumLLID;
+    int32s      packets     = PACKET_LIMIT;
+
+    for( int n = 1; n < argc - 1; n++ )
+    {
+        if( strcmp( argv[n], "--resume" ) == 0 )        resume_file         = argv[n + 1];
+        else if( strcmp( argv[n], "--llid" ) == 0 )     num_llid            = atoi( argv[n + 1] );
+        else if( strcmp( argv[n], "--buffer" ) == 0 )   Topology.BufferSize = atoi( argv[n + 1] );
+        else if( strcmp( argv[n], "--slot" ) == 0 )     Topology.MaxSlot    = atoi( argv[n + 1] );
+        else if( strcmp( argv[n], "--packets" ) == 0 )  packets             = atoi( argv[n + 1] );
+    }
+
+    if( num_llid < 1 || num_llid > MAX_NUM_LLID || Topology.BufferSize < 0 || Topology.MaxSlot <= 0 )
+    {
+        MSG_WARN( "Invalid topology: LLIDs = " << num_llid << " (1.." << MAX_NUM_LLID << "), buffer = " 
+                  << Topology.BufferSize << ", slot = " << Topology.MaxSlot );
+        return 1;
+    }
+    Topology.NumLLID = (int16s) num_llid;
+
+    if( packets <= 0 )
+    {
+        MSG_WARN( "Invalid packet limit: " << packets );
+        return 1;
+    }
+    SetPacketLimit( packets );
+
     _seed();
 
     ////////////////////////////////////////////////////////////
@@ -251,10 +311,10 @@ int Simulation( int, char* [] )
     // Create, execute, and destroy simulation
     ////////////////////////////////////////////////////////////
     InitializeEPON();
-    Execute();
+    Execute( name, resume_file );
     DestroyEPON();
 
     return 0;
 }
 
-#endif _SIMULATION_H_INCLUDED_ 
\ No newline at end of file
+#endif // _SIMULATION_H_INCLUDED_ 
\ No newline at end of file
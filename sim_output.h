@@ -36,7 +36,9 @@
 
 //#include <fstream.h>  // old style for VC++ 6.0
 #include <fstream>      // new style for VC++.NET
-#include <conio.h>
+#include <iostream>
+#include "_compat.h"   // _getch()
+#include "_log.h"
 
 using namespace std;
 
@@ -45,6 +47,11 @@ using namespace std;
 //
 // Output routines
 //
+// All messages are passed to the asynchronous log SimLog, 
+// which writes them to file and screen in a background 
+// thread.  Message types with a rate limit (messages per 
+// second) are checked before the message is formatted.
+//
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 #define REAL_STREAM( n )                                        \
@@ -60,32 +67,46 @@ inline void CLOSE_##n##_STREAM( void )   { LOG_##n.close(); }
 inline void OPEN_##n##_STREAM( char* )   {}                     \
 inline void CLOSE_##n##_STREAM( void )   {}
 
+const int32u LOG_TYPE_WARN = 0;
+const int32u LOG_TYPE_CONF = 1;
+const int32u LOG_TYPE_INFO = 2;
+const int32u LOG_TYPE_RSLT = 3;
+
+#define LOG_MESSAGE( type, msg )  if( SimLog.Admit( type )) { SimLog.Text() << msg; SimLog.Post( type ); }
+
+#if !defined ( WARNING_RATE_LIMIT )
+    #define WARNING_RATE_LIMIT      0
+#endif
 
 ////////////////////////////////////////////////////////////////////////
 // Protocol warnings output
 ////////////////////////////////////////////////////////////////////////
 #if defined ( WARNING_OUTPUT_FILE )
     REAL_STREAM( WARN );
-    #define WARN_FILE_OUT( msg )    LOG_WARN << "WARNING: " << msg << endl
+    #define WARN_FILE               &LOG_WARN
 #else
     DUMMY_STREAM( WARN );
-    #define WARN_FILE_OUT( msg )           
+    #define WARN_FILE               NULL
 #endif
     
 #if defined ( WARNING_OUTPUT_SCREEN )
-    #define WARN_SCREEN_OUT( msg )  cerr << "WARNING: " << msg << endl 
+    #define WARN_SCREEN             &cerr
 #else
-    #define WARN_SCREEN_OUT( msg )           
+    #define WARN_SCREEN             NULL
 #endif
 
 #if defined ( STOP_ON_WARNING )
     #include <signal.h>
-    #define STOP_WARN          { clog << "Press any key to continue ..." << endl; if( _getch() == 0x03 ) raise(SIGINT); } 
+    #define STOP_WARN          { SimLog.Flush(); clog << "Press any key to continue ..." << endl; if( _getch() == 0x03 ) raise(SIGINT); } 
 #else
     #define STOP_WARN           
 #endif
 
-#define MSG_WARN( msg )  { WARN_SCREEN_OUT( msg ); WARN_FILE_OUT( msg ); STOP_WARN; }  
+#if defined ( WARNING_OUTPUT_FILE ) || defined ( WARNING_OUTPUT_SCREEN )
+    #define MSG_WARN( msg )  { if( SimLog.Admit( LOG_TYPE_WARN )) { SimLog.Text() << "WARNING: " << msg << '\n'; SimLog.Post( LOG_TYPE_WARN ); STOP_WARN; } }  
+#else
+    #define MSG_WARN( msg )  { STOP_WARN; }  
+#endif
 
 
 ////////////////////////////////////////////////////////////////////////
@@ -93,38 +114,46 @@ inline void CLOSE_##n##_STREAM( void )   {}
 ////////////////////////////////////////////////////////////////////////
 #if defined ( CONFIGURATION_OUTPUT_FILE )
     REAL_STREAM( CONF );
-    #define CONF_FILE_OUT( msg )    LOG_CONF << msg << endl
+    #define CONF_FILE               &LOG_CONF
 #else
     DUMMY_STREAM( CONF );
-    #define CONF_FILE_OUT( msg )           
+    #define CONF_FILE               NULL
 #endif
     
 #if defined ( CONFIGURATION_OUTPUT_SCREEN )
-    #define CONF_SCREEN_OUT( msg )  clog << msg << endl 
+    #define CONF_SCREEN             &clog
 #else
-    #define CONF_SCREEN_OUT( msg )           
+    #define CONF_SCREEN             NULL
 #endif
 
-#define MSG_CONF( msg )     { CONF_SCREEN_OUT( msg );  CONF_FILE_OUT( msg ); }  
+#if defined ( CONFIGURATION_OUTPUT_FILE ) || defined ( CONFIGURATION_OUTPUT_SCREEN )
+    #define MSG_CONF( msg )     { LOG_MESSAGE( LOG_TYPE_CONF, msg << '\n' ) }  
+#else
+    #define MSG_CONF( msg )     {}  
+#endif
 
 ////////////////////////////////////////////////////////////////////////
 // Information output
 ////////////////////////////////////////////////////////////////////////
 #if defined ( INFORMATION_OUTPUT_FILE )
     REAL_STREAM( INFO );
-    #define INFO_FILE_OUT( msg )    LOG_INFO << "INFO: " << msg << endl
+    #define INFO_FILE               &LOG_INFO
 #else
     DUMMY_STREAM( INFO );
-    #define INFO_FILE_OUT( msg )           
+    #define INFO_FILE               NULL
 #endif
     
 #if defined ( INFORMATION_OUTPUT_SCREEN )
-    #define INFO_SCREEN_OUT( msg )  clog << "INFO: " << msg << endl 
+    #define INFO_SCREEN             &clog
 #else
-    #define INFO_SCREEN_OUT( msg )           
+    #define INFO_SCREEN             NULL
 #endif
 
-#define MSG_INFO( msg )     { INFO_SCREEN_OUT( msg );  INFO_FILE_OUT( msg ); }  
+#if defined ( INFORMATION_OUTPUT_FILE ) || defined ( INFORMATION_OUTPUT_SCREEN )
+    #define MSG_INFO( msg )     { LOG_MESSAGE( LOG_TYPE_INFO, "INFO: " << msg << '\n' ) }  
+#else
+    #define MSG_INFO( msg )     {}  
+#endif
 
 
 ////////////////////////////////////////////////////////////////////////
@@ -132,19 +161,52 @@ inline void CLOSE_##n##_STREAM( void )   {}
 ////////////////////////////////////////////////////////////////////////
 #if defined ( RESULT_OUTPUT_FILE )
     REAL_STREAM( RSLT );
-    #define RSLT_FILE_OUT( msg )        LOG_RSLT << msg
+    #define RSLT_FILE               &LOG_RSLT
 #else
     DUMMY_STREAM( RSLT );
-    #define RSLT_FILE_OUT( msg )           
+    #define RSLT_FILE               NULL
 #endif
     
 #if defined ( RESULT_OUTPUT_SCREEN )
-    #define RSLT_SCREEN_OUT( msg )      cout << msg 
+    #define RSLT_SCREEN             &cout
+#else
+    #define RSLT_SCREEN             NULL
+#endif
+
+#if defined ( RESULT_OUTPUT_FILE ) || defined ( RESULT_OUTPUT_SCREEN )
+    #define MSG_RSLT( msg )     { LOG_MESSAGE( LOG_TYPE_RSLT, msg ) } 
 #else
-    #define RSLT_SCREEN_OUT( msg )           
+    #define MSG_RSLT( msg )     {} 
 #endif
 
-#define MSG_RSLT( msg )     { RSLT_SCREEN_OUT( msg );  RSLT_FILE_OUT( msg ); } 
+
+////////////////////////////////////////////////////////////////////////
+// Asynchronous log.  Must be defined after the output streams, 
+// so that it is destroyed (and flushed) before them.
+////////////////////////////////////////////////////////////////////////
+AsyncLog SimLog;
+
+////////////////////////////////////////////////////////////////////////
+// START_LOG() is called after the output streams are opened;
+// STOP_LOG() reports message counters and writes all pending 
+// messages before the streams are closed.
+////////////////////////////////////////////////////////////////////////
+inline void START_LOG( void )
+{
+    SimLog.SetOutput( LOG_TYPE_WARN, WARN_FILE, WARN_SCREEN, "WARNING: ", WARNING_RATE_LIMIT );
+    SimLog.SetOutput( LOG_TYPE_CONF, CONF_FILE, CONF_SCREEN, "",          0 );
+    SimLog.SetOutput( LOG_TYPE_INFO, INFO_FILE, INFO_SCREEN, "INFO: ",    0 );
+    SimLog.SetOutput( LOG_TYPE_RSLT, RSLT_FILE, RSLT_SCREEN, "",          0 );
+    SimLog.Start();
+}
+
+inline void STOP_LOG( void )
+{
+    MSG_INFO( "Warnings (posted/suppressed/dropped)," << SimLog.GetPosted( LOG_TYPE_WARN )     << "," 
+                                                      << SimLog.GetSuppressed( LOG_TYPE_WARN ) << "," 
+                                                      << SimLog.GetDropped( LOG_TYPE_WARN ) );
+    SimLog.Stop();
+}
 
 
 
@@ -5,6 +5,9 @@
 //              statistical variables
 //                 class Stats, 
 //                 class Distrib
+//                 class HDRDistrib
+//                 class BatchMeans
+//                 class MSER
 //                 class AutoCorr
 //
 // Author:      Glen Kramer (kramer@cs.ucdavis.edu)
@@ -39,7 +42,9 @@
 #define _STATS_H_INCLUDED_
 
 #include <string.h>
+#include <math.h>
 #include "_types.h"
+#include "_ckpt.h"
 
 #define INVALID_VAL     0  // value returned when asking for AVG or VAR of an empty set 
 typedef DOUBLE stat_t;
@@ -88,6 +93,8 @@ public:
         _Cnt += st._Cnt;
         return *this;
     }
+    //////////////////////////////////////////////////////////////////
+    virtual void Serialize( Archive& ar ) { ar & _Max & _Sqr & _Tot & _Cnt; }
 };
 
 
@@ -208,6 +215,415 @@ public:
 	//////////////////////////////////////////////////////////////////
 };
 
+//////////////////////////////////////////////////////////////////////
+// class HDRDistrib 
+// Builds a log-linear (HDR-style) histogram of a series of 
+// non-negative values.  Every power of two between 2^MIN_EXP and 
+// 2^MAX_EXP is split into 2^PRECISION equal sub-bins, so the relative 
+// error of any reported percentile does not exceed 2^-(PRECISION+1)
+// regardless of the range of the series.  Unlike Distrib, the range  
+// does not need to be known in advance.  
+//
+// The bin index is taken directly from the exponent and the top 
+// PRECISION bits of the mantissa of an IEEE-754 double, which makes 
+// Sample() O(1) without any logarithm.  Values below 2^MIN_EXP 
+// (including zero) are counted in the underflow bin and reported as 0; 
+// values above 2^MAX_EXP are counted in the last bin.
+//////////////////////////////////////////////////////////////////////
+template < int32s PRECISION = 7, int32s MIN_EXP = -20, int32s MAX_EXP = 40 > 
+class HDRDistrib : public Stats
+{
+private:
+    enum { MANTISSA_BITS = 52, EXP_BIAS = 1023 };
+    enum { BINS = ( MAX_EXP - MIN_EXP ) << PRECISION };
+
+    stat_t _Under;          // weight of samples below 2^MIN_EXP
+    stat_t _Dstrb[ BINS ];  
+
+    //////////////////////////////////////////////////////////////////
+    // Returns the raw bits of the lowest value in the first bin 
+    //////////////////////////////////////////////////////////////////
+    static inline int64u _BaseBits( void ) 
+    { 
+        return (int64u)( EXP_BIAS + MIN_EXP ) << MANTISSA_BITS;
+    }
+
+    //////////////////////////////////////////////////////////////////
+    // Returns a bin number to which the current sample should be 
+    // added, or -1 if the sample is below the histogram range
+    //////////////////////////////////////////////////////////////////
+    static inline int32s _CalcBin( stat_t sample )
+    {
+        int64u bits;
+        memcpy( &bits, &sample, sizeof( bits ));
+
+        if( sample <= 0 || bits < _BaseBits() )
+            return -1;
+
+        int64u bin = ( bits - _BaseBits() ) >> ( MANTISSA_BITS - PRECISION );
+        return bin < BINS ? (int32s) bin : BINS - 1;
+    }
+
+    //////////////////////////////////////////////////////////////////
+    // Returns the lowest value that falls into a given bin 
+    //////////////////////////////////////////////////////////////////
+    static inline stat_t _BinFloor( int32s bin )
+    {
+        int64u bits = _BaseBits() + ( (int64u) bin << ( MANTISSA_BITS - PRECISION ));
+        stat_t val;
+        memcpy( &val, &bits, sizeof( val ));
+        return val;
+    }
+
+public:
+    HDRDistrib() : Stats()  { Clear(); }
+    virtual ~HDRDistrib()   {}
+
+    //////////////////////////////////////////////////////////////////
+    inline void Clear( void )     
+    { 
+        Stats::Clear();
+        _Under = 0;
+        memset( _Dstrb, 0, BINS * sizeof( stat_t ));
+    }
+    //////////////////////////////////////////////////////////////////
+    inline void Sample( stat_t sample, stat_t weight = 1.0 )
+    {
+        Stats::Sample( sample, weight );
+
+        int32s bin = _CalcBin( sample );
+        if( bin < 0 )   _Under       += weight;
+        else            _Dstrb[ bin ] += weight;
+    }
+    //////////////////////////////////////////////////////////////////
+    inline HDRDistrib operator+ ( HDRDistrib d ) { return d += *this; }
+    //////////////////////////////////////////////////////////////////
+    inline HDRDistrib& operator+= ( const HDRDistrib& d )
+    {
+        Stats::operator += ( d );
+        _Under += d._Under;
+        for( int32s i = 0; i < BINS; i++ )
+            _Dstrb[i] += d._Dstrb[i];
+        return *this;
+    }
+    //////////////////////////////////////////////////////////////////
+    //////////////////////////////////////////////////////////////////
+    // Only the bins that are not empty are written, as pairs of the 
+    // bin index and its value
+    //////////////////////////////////////////////////////////////////
+    virtual void Serialize( Archive& ar ) 
+    { 
+        int32s count = 0;
+
+        Stats::Serialize( ar ); 
+        ar & _Under;
+
+        if( ar.IsWriting() )
+        {
+            for( int32s i = 0; i < BINS; i++ )
+                if( _Dstrb[i] != 0 )  count++;
+
+            ar & count;
+            for( int32s i = 0; i < BINS; i++ )
+                if( _Dstrb[i] != 0 )  ar & i & _Dstrb[i];
+        }
+        else
+        {
+            for( int32s i = 0; i < BINS; i++ )
+                _Dstrb[i] = 0;
+
+            ar & count;
+            for( int32s bin; count > 0 && ar.IsGood(); count-- )
+            {
+                ar & bin;
+                if( bin < 0 || bin >= BINS )
+                    ar.SetFailed();
+                else
+                    ar & _Dstrb[ bin ];
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////
+    // Returns a value such that pcnt (fraction of 1.0) of all samples 
+    // are at or below this value. The returned value is the center 
+    // of the bin in which the percentile falls, but never exceeds 
+    // the largest sample collected.
+    //////////////////////////////////////////////////////////////////
+    stat_t GetPercentileValue( DOUBLE pcnt ) const 
+    {
+        stat_t sum = _Under, limit = pcnt * GetCount();
+
+        if( GetCount() <= 0 )
+            return INVALID_VAL;
+
+        if( sum >= limit )
+            return 0;
+
+        for( int32s bin = 0; bin < BINS; bin++ )
+        {
+            if(( sum += _Dstrb[ bin ] ) >= limit )
+                return MIN( ( _BinFloor( bin ) + _BinFloor( bin + 1 )) / 2, GetMax() );
+        }
+        return GetMax();
+    }
+
+    //////////////////////////////////////////////////////////////////
+    // Returns a percentage of samples <= value 
+    //////////////////////////////////////////////////////////////////
+    DOUBLE GetRank( stat_t val ) const 
+    {
+        DOUBLE rank = _Under;
+
+        for( int32s bin = _CalcBin( val ); bin >= 0; bin-- )
+            rank += _Dstrb[ bin ];
+
+        return GetCount()? rank / GetCount(): INVALID_VAL;
+    }
+    //////////////////////////////////////////////////////////////////
+};
+
+//////////////////////////////////////////////////////////////////////
+// class BatchMeans 
+// Estimates the confidence interval of the mean of a correlated 
+// series by the method of batch means.  Samples are grouped into 
+// consecutive batches of equal weight.  When BATCHES batches are 
+// completed, adjacent pairs are merged and the batch size is doubled, 
+// so the memory stays constant while the batches grow long enough 
+// for their means to become approximately independent.  
+//
+// The half-width is recalculated only when a batch is completed, so 
+// GetHalfWidth() and GetRelHalfWidth() are cheap enough to be polled 
+// after every sample.
+//////////////////////////////////////////////////////////////////////
+template < int32s BATCHES = 64 > class BatchMeans : public Stats
+{
+private:
+    enum { MIN_BATCHES = BATCHES / 2 };  // fewer batches give no estimate
+
+    stat_t _Mean[ BATCHES ];  // means of completed batches
+    stat_t _Wght[ BATCHES ];  // weights of completed batches
+    int32s _Done;             // number of completed batches
+    stat_t _Size;             // target weight of one batch
+    stat_t _BTot;             // weighted sum of the current batch
+    stat_t _BCnt;             // weight of the current batch
+    stat_t _HalfW;            // half-width of the confidence interval
+
+    //////////////////////////////////////////////////////////////////
+    // Returns the 97.5% quantile of Student's t-distribution with 
+    // 'df' degrees of freedom (Cornish-Fisher expansion around the 
+    // normal quantile; accurate to 1e-3 for df >= 5)
+    //////////////////////////////////////////////////////////////////
+    static inline DOUBLE _StudentT975( int32s df )
+    {
+        const DOUBLE z = 1.959963985, z2 = z * z;
+        DOUBLE v = df;
+
+        return z + z * ( z2 + 1 ) / ( 4 * v )
+                 + z * (( 5 * z2 + 16 ) * z2 + 3 ) / ( 96 * v * v )
+                 + z * ((( 3 * z2 + 19 ) * z2 + 17 ) * z2 - 15 ) / ( 384 * v * v * v );
+    }
+
+    //////////////////////////////////////////////////////////////////
+    inline void _CloseBatch( void )
+    {
+        _Mean[ _Done ] = _BTot / _BCnt;
+        _Wght[ _Done ] = _BCnt;
+        _BTot = _BCnt  = 0;
+
+        if( ++_Done == BATCHES )
+        {
+            for( int32s n = 0; n < BATCHES / 2; n++ )
+            {
+                stat_t w = _Wght[ 2*n ] + _Wght[ 2*n + 1 ];
+                _Mean[n] = ( _Mean[ 2*n ] * _Wght[ 2*n ] + _Mean[ 2*n + 1 ] * _Wght[ 2*n + 1 ] ) / w;
+                _Wght[n] = w;
+            }
+            _Done  = BATCHES / 2;
+            _Size *= 2;
+        }
+
+        if( _Done >= MIN_BATCHES )
+        {
+            Stats bm;
+            for( int32s n = 0; n < _Done; n++ )
+                bm.Sample( _Mean[n] );
+
+            _HalfW = _StudentT975( _Done - 1 ) * sqrt( bm.GetVar() / ( _Done - 1 ));
+        }
+    }
+
+public:
+    BatchMeans() : Stats()  { Clear(); }
+    virtual ~BatchMeans()   {}
+
+    //////////////////////////////////////////////////////////////////
+    inline void Clear( void )     
+    { 
+        Stats::Clear();
+        for( int32s n = 0; n < BATCHES; n++ )
+            _Mean[n] = _Wght[n] = 0;
+        _Done  = 0;
+        _Size  = 1;
+        _BTot  = _BCnt = 0;
+        _HalfW = -1;
+    }
+    //////////////////////////////////////////////////////////////////
+    inline void Sample( stat_t sample, stat_t weight = 1.0 )
+    {
+        Stats::Sample( sample, weight );
+
+        _BTot += sample * weight;
+        _BCnt += weight;
+
+        if( _BCnt >= _Size )
+            _CloseBatch();
+    }
+    //////////////////////////////////////////////////////////////////
+    virtual void Serialize( Archive& ar ) 
+    { 
+        Stats::Serialize( ar ); 
+        ar & _Mean & _Wght & _Done & _Size & _BTot & _BCnt & _HalfW; 
+    }
+
+    //////////////////////////////////////////////////////////////////
+    // Returns the half-width of the 95% confidence interval of the 
+    // mean, or a negative value if not enough batches are collected
+    //////////////////////////////////////////////////////////////////
+    inline stat_t GetHalfWidth( void )   const { return _HalfW; }
+    inline int32s GetBatches( void )     const { return _Done;  }
+    inline stat_t GetBatchSize( void )   const { return _Size;  }
+
+    //////////////////////////////////////////////////////////////////
+    // Returns the half-width relative to the mean, or a negative 
+    // value if the precision cannot be estimated yet 
+    //////////////////////////////////////////////////////////////////
+    inline stat_t GetRelHalfWidth( void ) const 
+    { 
+        return ( _HalfW < 0 || GetAvg() == 0 )? -1: _HalfW / fabs( GetAvg() ); 
+    }
+    //////////////////////////////////////////////////////////////////
+};
+
+//////////////////////////////////////////////////////////////////////
+// class MSER 
+// Detects the end of the initial transient of a series using the 
+// MSER-m truncation heuristic (Marginal Standard Error Rule, White 
+// 1997) applied to the means of batches of BATCH samples.  For each 
+// candidate truncation point d, the rule evaluates
+//
+//      MSER(d) = SUM_{i>d}( Z_i - Zavg_d )^2 / (n - d)^2
+//
+// and selects d* that minimizes it.  The series is considered to have 
+// reached the steady state once d* falls into the first half of the 
+// collected batches.  
+//
+// When BATCHES batches are collected, adjacent pairs are merged and 
+// the batch size is doubled, so the memory stays constant.  The rule
+// is evaluated every EVAL_STEP completed batches.
+//////////////////////////////////////////////////////////////////////
+template < int32s BATCH = 5, int32s BATCHES = 512 > class MSER
+{
+private:
+    enum { EVAL_STEP = 16, MIN_BATCHES = 64, MIN_TAIL = 5 };
+
+    stat_t _Mean[ BATCHES ];  // means of completed batches
+    int32s _Done;             // number of completed batches
+    int32s _Size;             // number of samples in one batch
+    stat_t _BTot;             // sum of the current batch
+    int32s _BCnt;             // number of samples in the current batch
+    int32s _Trunc;            // truncation point (in batches)
+    BOOL   _Steady;           // TRUE once the transient is over
+
+    //////////////////////////////////////////////////////////////////
+    // Finds d* by scanning the batches from the end, so that the 
+    // suffix sums are accumulated in one pass
+    //////////////////////////////////////////////////////////////////
+    inline void _Evaluate( void )
+    {
+        stat_t sum = 0, sqr = 0, best = -1;
+
+        for( int32s d = _Done - 1; d >= 0; d-- )
+        {
+            sum += _Mean[d];
+            sqr += _Mean[d] * _Mean[d];
+
+            stat_t m = _Done - d;
+            if( m < (stat_t) MIN_TAIL )
+                continue;
+
+            stat_t mser = ( sqr - sum * sum / m ) / ( m * m );
+            if( best < 0 || mser <= best )
+            {
+                best   = mser;
+                _Trunc = d;
+            }
+        }
+        _Steady = _Trunc <= _Done / 2;
+    }
+
+    //////////////////////////////////////////////////////////////////
+    inline void _CloseBatch( void )
+    {
+        _Mean[ _Done++ ] = _BTot / _BCnt;
+        _BTot = 0;
+        _BCnt = 0;
+
+        if( _Done == BATCHES )
+        {
+            for( int32s n = 0; n < BATCHES / 2; n++ )
+                _Mean[n] = ( _Mean[ 2*n ] + _Mean[ 2*n + 1 ] ) / 2;
+
+            _Done  = BATCHES / 2;
+            _Size *= 2;
+        }
+
+        if( _Done >= MIN_BATCHES && _Done % EVAL_STEP == 0 )
+            _Evaluate();
+    }
+
+public:
+    MSER()              { Clear(); }
+    virtual ~MSER()     {}
+
+    //////////////////////////////////////////////////////////////////
+    inline void Clear( void )     
+    { 
+        _Done   = 0;
+        _Size   = BATCH;
+        _BTot   = 0;
+        _BCnt   = 0;
+        _Trunc  = 0;
+        _Steady = FALSE;
+    }
+    //////////////////////////////////////////////////////////////////
+    inline void Sample( stat_t sample )
+    {
+        _BTot += sample;
+        if( ++_BCnt == _Size )
+            _CloseBatch();
+    }
+    //////////////////////////////////////////////////////////////////
+    inline void Serialize( Archive& ar ) 
+    { 
+        ar & _Mean & _Done & _Size & _BTot & _BCnt & _Trunc & _Steady; 
+    }
+    //////////////////////////////////////////////////////////////////
+    inline BOOL   IsSteady( void )      const { return _Steady; }
+    inline int32s GetBatchSize( void )  const { return _Size;   }
+
+    //////////////////////////////////////////////////////////////////
+    // Returns the truncation point as a number of samples 
+    //////////////////////////////////////////////////////////////////
+    inline int64s GetTruncation( void ) const { return (int64s) _Trunc * _Size; }
+
+    //////////////////////////////////////////////////////////////////
+    // Returns the number of samples collected 
+    //////////////////////////////////////////////////////////////////
+    inline int64s GetCount( void )      const { return (int64s) _Done * _Size + _BCnt; }
+    //////////////////////////////////////////////////////////////////
+};
+
 //////////////////////////////////////////////////////////////////////
 // class AutoCorr 
 // Calculates auto-correlation of a series 
@@ -3,7 +3,8 @@
  *
  * Description: This file contains the simulation scenario 001.
  *              
- *              In this scenario 16 LLIDs are used.
+ *              In this scenario Topology.NumLLID LLIDs are used 
+ *              (NUM_LLID unless changed by the --llid option).
  *              Different parameters are measured as the load
  *              of all LLIDs changes from MIN_LOAD to MAX_LOAD.  
  *              
@@ -18,13 +19,92 @@
  *                                        MIN_LOAD and MAX_LOAD..
  *
  *              4. PACKET_LIMIT:          Number of packtes for which 
- *                                        simulation will run.
+ *                                        simulation will run.  The option 
+ *                                        --packets N runs N packets instead and 
+ *                                        scales MIN_PACKET_LIMIT and 
+ *                                        MAX_PACKET_LIMIT by the same factor.
  *
  *              5. WARMUP_TIME:           A time after which statistic collection starts 
  *
+ *                 WARMUP_DETECTION:      If TRUE, the warm-up ends as soon as the 
+ *                                        MSER-5 rule detects that the packet delay 
+ *                                        and the queue length have left the 
+ *                                        initial transient. WARMUP_TIME then 
+ *                                        becomes the upper bound of the warm-up.
+ *
+ *                 WARMUP_MIN_TIME:       Lower bound of a detected warm-up, so that 
+ *                                        the rule is not applied to a handful of 
+ *                                        early batches.
+ *
+ *              6. FORK_LOAD_POINTS:      If 0 (default), loads are simulated 
+ *                                        sequentially and each one continues from 
+ *                                        the state left by the previous load.
+ *                                        If not 0, every load point is simulated in 
+ *                                        a separate process forked after the warm-up 
+ *                                        (up to FORK_LOAD_POINTS at a time).  This 
+ *                                        changes the meaning of the results: every 
+ *                                        load restarts from the state warmed up at 
+ *                                        MIN_LOAD, and all loads use the same random 
+ *                                        numbers (common random numbers).
+ *                                        Requires fork() (ignored on Windows).
+ *
+ *              7. TARGET_PRECISION:      Relative half-width of the 95% confidence 
+ *                                        interval of the average delay at which 
+ *                                        a load point is considered converged.
+ *                                        Set to 0 to disable run-length control 
+ *                                        (default).  With heavy-tailed traffic 
+ *                                        the estimate is optimistic on short runs, 
+ *                                        so use a tight precision, e.g. 0.01.
+ *
+ *              8. MIN_PACKET_LIMIT,      Bounds on the number of packets simulated 
+ *                 MAX_PACKET_LIMIT:      at each load under run-length control.
+ *                                        MIN_PACKET_LIMIT = PACKET_LIMIT, so that 
+ *                                        run-length control only extends runs.
+ *
+ *              9. CHECKPOINT_INTERVAL:   Wall-clock time (in seconds) between 
+ *                                        checkpoints.  A checkpoint "name.ckpt" is 
+ *                                        written after the warm-up and then 
+ *                                        periodically while loads are simulated 
+ *                                        sequentially.  A forked load point NN 
+ *                                        writes its own checkpoint "name_NN.ckpt" 
+ *                                        periodically and when it completes.  
+ *                                        Set to 0 to disable checkpoints.
+ *                                        Run "EPON name --resume name.ckpt" to 
+ *                                        continue an interrupted simulation; 
+ *                                        forked load points then continue from 
+ *                                        their own checkpoints, and completed 
+ *                                        ones are not simulated again.  The 
+ *                                        checkpoints are deleted when the 
+ *                                        simulation completes.
+ *
+ *             10. TRACE_PACKETS,         If TRUE, every packet received, dropped, or 
+ *                 TRACE_CYCLES:          delivered to the OLT (TRACE_PACKETS), and 
+ *                                        every GATE (TRACE_CYCLES) is written to a 
+ *                                        binary trace "name_NN.trc" of load point NN.
+ *                                        See _trace.h for the file format.  A load 
+ *                                        point resumed from a checkpoint starts its 
+ *                                        trace anew.
+ *
+ *             11. IDLE_FAST_FORWARD:     If TRUE, the OLT computes the polling cycles 
+ *                                        of ONUs with empty queues itself, without  
+ *                                        events, until their next packet arrives 
+ *                                        (see olt.h).  The results are the same with 
+ *                                        fewer events; GATE trace records of skipped 
+ *                                        cycles are not in time order.
+ *
+ *             12. DOWNSTREAM_TRAFFIC:    If TRUE, a downstream source per LLID sends 
+ *                                        packets to the OLT at the same load as the 
+ *                                        upstream sources.  The OLT broadcasts them 
+ *                                        through a Splitter (see link.h) and the 
+ *                                        DS rows are added to the results.
+ *
  *              
  * Note:        For each load the simulation will run until PACKET_LIMIT packets 
- *              are transmitted by all LLIDs together.
+ *              are transmitted by all LLIDs together.  If TARGET_PRECISION is 
+ *              set, the simulation instead runs until the confidence interval 
+ *              of the average delay (estimated by batch means) is narrow enough, 
+ *              but for no fewer than MIN_PACKET_LIMIT and no more than 
+ *              MAX_PACKET_LIMIT packets.
  * 
  * Result Format: Below is sample result output. 
  *
@@ -36,7 +116,10 @@
  *                 CARRIED LOAD 
  *                 AVG DELAY (us)                                                                                
  *                 MAX DELAY (us)     
+ *                 P50 / P99 / P99.9 DELAY (us)
+ *                 DELAY 95% CI HALF-WIDTH (us)
  *                 AVG QUEUE LENGTH (bytes)                                                                                
+ *                 P50 / P99 / P99.9 QUEUE LENGTH (bytes)
  *                 RECV PACKETS                                                                                  
  *                 SENT PACKETS                                                                                  
  *                 DROP PACKETS                                                                                  
@@ -47,7 +130,11 @@
  *                 BYTE LOSS RATIO  
  *                 AVG CYCLE TIME
  *                 MAX CYCLE TIME
+ *                 P50 / P99 / P99.9 CYCLE TIME
  *                 TOTAL CYCLES
+ *                 DS OFFERED / CARRIED LOAD       (if DOWNSTREAM_TRAFFIC)
+ *                 DS AVG / MAX / P99 DELAY (us)
+ *                 DS RECV / SENT / DROP PACKETS
  *
  * 
  * Author:      Glen Kramer (kramer@cs.ucdavis.edu)
@@ -79,7 +166,15 @@ _FILE_ATTRIBUTES( SIMULATION, 001 );
 
 #pragma message( "Using SIMULATION file ......... " __FILE__ )
 
+#include <string>
 #include "stats.h"
+#include "_trace.h"
+
+#if !defined( _WIN32 )
+    #include <unistd.h>
+    #include <sys/wait.h>
+    #define FORK_SUPPORTED
+#endif
 
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
@@ -90,12 +185,25 @@ _FILE_ATTRIBUTES( SIMULATION, 001 );
 ///////////////////////////////////////////////////////////
 
 const int32s PACKET_LIMIT   = 1000000;    
+const DOUBLE TARGET_PRECISION = 0;         // relative CI half-width, e.g. 0.01 (0 = run PACKET_LIMIT packets)
+const int32s MIN_PACKET_LIMIT = PACKET_LIMIT;
+const int32s MAX_PACKET_LIMIT = 5 * PACKET_LIMIT;
 const int64s WARMUP_TIME    = 10 * UNITS_PER_SEC; // 10 seconds
+const BOOL   WARMUP_DETECTION = TRUE;
+const int64s WARMUP_MIN_TIME = 1 * UNITS_PER_SEC; // detected warm-up lasts at least 1 second
+const int16s FORK_LOAD_POINTS = 0;         // concurrent load points forked after warm-up (0 = sequential loads)
+const int32s CHECKPOINT_INTERVAL = 600;    // wall-clock seconds between checkpoints
+const BOOL   TRACE_PACKETS  = FALSE;       // write per-packet trace
+const BOOL   TRACE_CYCLES   = FALSE;       // write per-GATE trace
+const BOOL   IDLE_FAST_FORWARD = FALSE;    // OLT follows idle cycles of empty ONUs without GATE/REPORT events
+const BOOL   DOWNSTREAM_TRAFFIC = FALSE;   // broadcast downstream packets through a splitter
 const float  MIN_LOAD       = 0.05F;
 const float  MAX_LOAD       = 0.90F;
 const int16s NUM_TEST       = 18;   
 const float  LOAD_STEP      = (MAX_LOAD - MIN_LOAD) / (NUM_TEST - 1);
 
+static_assert( !DOWNSTREAM_TRAFFIC || TRAFFIC_TYPE != TRC, "downstream sources cannot replay the upstream trace" );
+
 
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
@@ -112,7 +220,7 @@ const float  LOAD_STEP      = (MAX_LOAD - MIN_LOAD) / (NUM_TEST - 1);
         MSG_RSLT( endl );
 
 
-#define RATIO( val, port )    ( (DOUBLE)( val * ##port##_BYTE_TIME ) / RunTime[t] )
+#define RATIO( val, port )    ( (DOUBLE)( val * port##_BYTE_TIME ) / RunTime[t] )
 #define RATE_MBPS( val )      ( RATIO( val, PON ) * PON_RATE_MBPS )
 
 
@@ -124,10 +232,12 @@ const float  LOAD_STEP      = (MAX_LOAD - MIN_LOAD) / (NUM_TEST - 1);
 ///////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////
 
-OLT*            pOLT;
-ONU*            pONU[ NUM_LLID ];
-BiDirLink*      pLNK[ NUM_LLID ];
-PacketSource*   pSRC[ NUM_LLID ];
+OLT*            pOLT = NULL;
+ONU**           pONU = NULL;                       // Topology.NumLLID ONUs
+BiDirLink**     pLNK = NULL;                       // Topology.NumLLID links
+SRC_CLASS**     pSRC = NULL;                       // Topology.NumLLID sources
+Splitter*       pSPL = NULL;                       // downstream splitter (DOWNSTREAM_TRAFFIC)
+SRC_CLASS**     pDSR = NULL;                       // Topology.NumLLID downstream sources (DOWNSTREAM_TRAFFIC)
 
 
 int16s          NumTest = 0;
@@ -149,9 +259,57 @@ int64s          DropByte[NUM_TEST] = { 0 };        // Total Number of Bytes drop
 int64s          SentByte[NUM_TEST] = { 0 };        // Total Number of Bytes received at OLT 
 int64s          SchdByte[NUM_TEST] = { 0 };        // Total Number of Bytes scheduled by OLT
 
-Stats           DLY[NUM_TEST];                     // Delay statistics 
-Stats           QUE[NUM_TEST];                     // Queue size statistics 
-Stats           CYC[NUM_TEST];                     // Cycle length 
+int32s          DsRcvdPckt[NUM_TEST] = { 0 };      // Total Number of downstream Packets received by OLT
+int32s          DsDropPckt[NUM_TEST] = { 0 };      // Total Number of downstream Packets dropped by OLT
+int32s          DsSentPckt[NUM_TEST] = { 0 };      // Total Number of downstream Packets received at ONUs
+int64s          DsRcvdByte[NUM_TEST] = { 0 };      // Total Number of downstream Bytes received by OLT
+int64s          DsSentByte[NUM_TEST] = { 0 };      // Total Number of downstream Bytes received at ONUs
+
+HDRDistrib<>    DLY[NUM_TEST];                     // Delay statistics 
+HDRDistrib<>    QUE[NUM_TEST];                     // Queue size statistics 
+HDRDistrib<>    CYC[NUM_TEST];                     // Cycle length 
+BatchMeans<>    DCI[NUM_TEST];                     // Confidence interval of average delay
+HDRDistrib<>    DDL[NUM_TEST];                     // Downstream delay statistics
+
+///////////////////////////////////////////////////////////
+// Lists of all per-test results, used to transfer results 
+// between processes and to write checkpoints
+///////////////////////////////////////////////////////////
+#define TEST_COUNTERS( X )                                    \
+    X( TargetLoad ) X( RunTime )                              \
+    X( RcvdPckt )   X( DropPckt )   X( SentPckt ) X( SchdPckt ) \
+    X( RcvdByte )   X( DropByte )   X( SentByte ) X( SchdByte ) \
+    X( DsRcvdPckt ) X( DsDropPckt ) X( DsSentPckt )             \
+    X( DsRcvdByte ) X( DsSentByte )
+
+#define TEST_STATS( X )                                       \
+    X( DLY )        X( QUE )        X( CYC )      X( DCI )      X( DDL )
+
+#define SERIALIZE_COUNTER( var )    ar & var[t];
+#define SERIALIZE_STATS( var )      var[t].Serialize( ar );
+
+const int32u    SIMULATION_TAG = 0x001;            // identifies checkpoints of this scenario
+int32s          PacketLimit    = PACKET_LIMIT;     // packets per load point (--packets)
+int32s          MinPacketLimit = MIN_PACKET_LIMIT;
+int32s          MaxPacketLimit = MAX_PACKET_LIMIT;
+
+std::string     CheckpointFile;                    // checkpoint file name (empty = no checkpoints)
+time_t          NextCheckpoint = 0;                // wall-clock time of the next checkpoint
+
+///////////////////////////////////////////////////////////
+// Trace record types
+///////////////////////////////////////////////////////////
+const int8u     TRACE_PCKT_RCVD = 1;               // packet received by ONU
+const int8u     TRACE_PCKT_DROP = 2;               // packet dropped by ONU
+const int8u     TRACE_PCKT_SENT = 3;               // packet received by OLT (Delay = packet delay)
+const int8u     TRACE_GATE      = 4;               // GATE received by ONU (Time = grant start, Size = grant length)
+
+std::string     RunName;                           // simulation name, used for trace files
+TraceWriter     Trace;                             // trace of the current load point
+
+MSER<>          WarmupDLY;                         // Transient detection on packet delay
+MSER<>          WarmupQUE;                         // Transient detection on queue length
+int32s          WarmupQueueLength = 0;             // total queue length during the warm-up
 
     
 //////////////////////////////////////////////////////////////////
@@ -166,12 +324,19 @@ void PrintResult( void )
    
     PER_PON( "TARGET LOAD",            TargetLoad[t] );
     PER_PON( "SIM TIME (sec)",         ((DOUBLE)RunTime[t]) / UNITS_PER_SEC );
-    PER_PON( "ONU LOAD",               RATIO( RcvdByte[t], UNI ) / NUM_LLID );
+    PER_PON( "ONU LOAD",               RATIO( RcvdByte[t], UNI ) / Topology.NumLLID );
     PER_PON( "OFFERED LOAD",           RATIO( RcvdByte[t], PON ));
     PER_PON( "CARRIED LOAD",           RATIO( SentByte[t], PON ));
     PER_PON( "AVG DLY (ms)",           DLY[t].GetAvg() );
     PER_PON( "MAX DLY (ms)",           DLY[t].GetMax() );
-    PER_PON( "AVG QUEUE (bytes)",      QUE[t].GetAvg() / NUM_LLID );
+    PER_PON( "P50 DLY (ms)",           DLY[t].GetPercentileValue( 0.50 ) );
+    PER_PON( "P99 DLY (ms)",           DLY[t].GetPercentileValue( 0.99 ) );
+    PER_PON( "P99.9 DLY (ms)",         DLY[t].GetPercentileValue( 0.999 ) );
+    PER_PON( "DLY CI95 (ms)",          DCI[t].GetHalfWidth() );
+    PER_PON( "AVG QUEUE (bytes)",      QUE[t].GetAvg() / Topology.NumLLID );
+    PER_PON( "P50 QUEUE (bytes)",      QUE[t].GetPercentileValue( 0.50 ) / Topology.NumLLID );
+    PER_PON( "P99 QUEUE (bytes)",      QUE[t].GetPercentileValue( 0.99 ) / Topology.NumLLID );
+    PER_PON( "P99.9 QUEUE (bytes)",    QUE[t].GetPercentileValue( 0.999 ) / Topology.NumLLID );
     PER_PON( "RECV PACKETS",           RcvdPckt[t] );
     PER_PON( "SENT PACKETS",           SentPckt[t] );
     PER_PON( "DROP PACKETS",           DropPckt[t] );
@@ -182,16 +347,66 @@ void PrintResult( void )
     PER_PON( "BYTE LOSS RATIO",        ((DOUBLE)DropByte[t]) / RcvdByte[t] );
     PER_PON( "AVG CYCLE (ms)",         CYC[t].GetAvg() );
     PER_PON( "MAX CYCLE (ms)",         CYC[t].GetMax() );
+    PER_PON( "P50 CYCLE (ms)",         CYC[t].GetPercentileValue( 0.50 ) );
+    PER_PON( "P99 CYCLE (ms)",         CYC[t].GetPercentileValue( 0.99 ) );
+    PER_PON( "P99.9 CYCLE (ms)",       CYC[t].GetPercentileValue( 0.999 ) );
     PER_PON( "CYCLES",                 CYC[t].GetCount() );
     PER_PON( "SCHD PACKETS",           SchdPckt[t] );
     PER_PON( "SCHD BYTES",             SchdByte[t] );
     //PER_PON( "UTIL",                   (SentByte[t]+RcvdByte[t]) / (1000000 * PON_RATE_MBPS  / 8 ) );
 
+    if( DOWNSTREAM_TRAFFIC )
+    {
+        PER_PON( "DS OFFERED LOAD",        RATIO( DsRcvdByte[t], PON ));
+        PER_PON( "DS CARRIED LOAD",        RATIO( DsSentByte[t], PON ));
+        PER_PON( "DS AVG DLY (ms)",        DDL[t].GetAvg() );
+        PER_PON( "DS MAX DLY (ms)",        DDL[t].GetMax() );
+        PER_PON( "DS P99 DLY (ms)",        DDL[t].GetPercentileValue( 0.99 ) );
+        PER_PON( "DS RECV PACKETS",        DsRcvdPckt[t] );
+        PER_PON( "DS SENT PACKETS",        DsSentPckt[t] );
+        PER_PON( "DS DROP PACKETS",        DsDropPckt[t] );
+    }
+
     MSG_RSLT( endl );
 }
 
 
 
+//////////////////////////////////////////////////////////////////
+// FUNCTION:     void MonitorGATE( int16u onu, DESL::time_t time, DESL::time_t start, int32s length )
+// PURPOSE:      Collects cycle statistics from a GATE arriving at 
+//               an ONU
+// ARGUMENTS:    onu    - index of the ONU
+//               time   - arrival time of the GATE
+//               start  - grant start time
+//               length - grant length
+// RETURN VALUE: 
+// NOTES:        Also receives the GATEs of fast-forwarded idle 
+//               cycles from the OLT (OLT port n is ONU n)
+//////////////////////////////////////////////////////////////////
+void MonitorGATE( int16u onu, DESL::time_t time, DESL::time_t start, int32s length )
+{
+    if( TRACE_CYCLES && Trace.IsOpen() )
+        Trace.Record( start, start - time, length, onu, TRACE_GATE );
+
+    if( onu != 0 )
+        return;
+
+    if( LastCycleStart != 0 )
+        CYC[NumTest].Sample( (DOUBLE)( start - LastCycleStart ) / 1000000 );
+
+    ////////////////////////////////////////////////////////////
+    // Save last cycle start time
+    ////////////////////////////////////////////////////////////
+    LastCycleStart = start;
+
+    ////////////////////////////////////////////////////////////
+    // Counts scheduled packets
+    ////////////////////////////////////////////////////////////
+    SchdByte[NumTest] += length;
+}
+
+
 //////////////////////////////////////////////////////////////////
 // FUNCTION:     void Monitor( DESL::evnt_t* pEvent )
 // PURPOSE:      Monitor function looks into each Event
@@ -210,6 +425,9 @@ void Monitor( DESL::evnt_t* pEvent )
         ////////////////////////////////////////////////////////////
         RcvdPckt[NumTest] ++;
         RcvdByte[NumTest] += pEvent->Pckt.PcktSize;
+
+        if( TRACE_PACKETS && Trace.IsOpen() )
+            Trace.Record( DESL::GlobalTime(), 0, pEvent->Pckt.PcktSize, _ONU_ID( pEvent->Consumer->ID ), TRACE_PCKT_RCVD );
     }
 
     else if( pEvent->Type == EV_PCKT_ARRIVAL && ( pEvent->Producer->ID & ONU_BASE_ID ) )
@@ -222,15 +440,20 @@ void Monitor( DESL::evnt_t* pEvent )
 
 
         DLY[NumTest].Sample( pckt_dly );
+        DCI[NumTest].Sample( pckt_dly );
 
         ////////////////////////////////////////////////////////////
         // Calculate total number of packets and bytes sent by all ONUs 
         ////////////////////////////////////////////////////////////
         SentPckt[NumTest] ++; 
         SentByte[NumTest] += pEvent->Pckt.PcktSize;
+
+        if( TRACE_PACKETS && Trace.IsOpen() )
+            Trace.Record( DESL::GlobalTime(), DESL::GlobalTime() - pEvent->Pckt.PcktTime, 
+                          pEvent->Pckt.PcktSize, _ONU_ID( pEvent->Producer->ID ), TRACE_PCKT_SENT );
     }
 
-    else if( pEvent->Type == EV_PCKT_DROP )
+    else if( pEvent->Type == EV_PCKT_DROP && ( pEvent->Producer->ID & ONU_BASE_ID ) )
     {
         ////////////////////////////////////////////////////////////
         // Calculate total number of packets and bytes dropped by all ONUs 
@@ -238,6 +461,38 @@ void Monitor( DESL::evnt_t* pEvent )
         DropPckt[NumTest] ++;
         DropByte[NumTest] += pEvent->Pckt.PcktSize;
 
+        if( TRACE_PACKETS && Trace.IsOpen() )
+            Trace.Record( DESL::GlobalTime(), 0, pEvent->Pckt.PcktSize, _ONU_ID( pEvent->Producer->ID ), TRACE_PCKT_DROP );
+
+    }
+
+    else if( pEvent->Type == EV_PCKT_ARRIVAL && ( pEvent->Producer->ID & SRC_BASE_ID ) )
+    {
+        ////////////////////////////////////////////////////////////
+        // Downstream packet received by the OLT (the upstream 
+        // sources are handled above)
+        ////////////////////////////////////////////////////////////
+        DsRcvdPckt[NumTest] ++;
+        DsRcvdByte[NumTest] += pEvent->Pckt.PcktSize;
+    }
+
+    else if( pEvent->Type == EV_PCKT_BROADCAST && ( pEvent->Consumer->ID & ONU_BASE_ID ) )
+    {
+        ////////////////////////////////////////////////////////////
+        // Downstream packet delivered to its ONU 
+        ////////////////////////////////////////////////////////////
+        DDL[NumTest].Sample( static_cast<DOUBLE>(DESL::GlobalTime() - pEvent->Pckt.PcktTime) / 1000000 );
+
+        DsSentPckt[NumTest] ++;
+        DsSentByte[NumTest] += pEvent->Pckt.PcktSize;
+    }
+
+    else if( pEvent->Type == EV_PCKT_DROP )
+    {
+        ////////////////////////////////////////////////////////////
+        // Downstream packet dropped by the OLT
+        ////////////////////////////////////////////////////////////
+        DsDropPckt[NumTest] ++;
     }
 
     else if( pEvent->Type == EV_PCKT_ENQUE || pEvent->Type == EV_PCKT_DEQUE )
@@ -248,7 +503,7 @@ void Monitor( DESL::evnt_t* pEvent )
             ////////////////////////////////////////////////////////////
             // First time, calculate the total queue length
             ////////////////////////////////////////////////////////////
-            for( int16s onu_index = 0; onu_index < NUM_LLID; onu_index++ )
+            for( int16s onu_index = 0; onu_index < Topology.NumLLID; onu_index++ )
                 LastQueueLength += pONU[onu_index]->GetQueueLength();
         }
 
@@ -272,21 +527,76 @@ void Monitor( DESL::evnt_t* pEvent )
         LastQueueChange  = DESL::GlobalTime();
     }
 
-    else if( pEvent->Type == EV_MPCP_GATE && pEvent->Consumer->ID == ONU_BASE_ID )
+    else if( pEvent->Type == EV_MPCP_GATE && ( pEvent->Consumer->ID & ONU_BASE_ID ) )
     {
-        if( LastCycleStart != 0 )
-            CYC[NumTest].Sample( (DOUBLE)(pEvent->GATE.StartTime - LastCycleStart ) / 1000000 );
+        MonitorGATE( _ONU_ID( pEvent->Consumer->ID ), DESL::GlobalTime(), pEvent->GATE.StartTime, pEvent->GATE.Length );
+    }
+}
 
-        ////////////////////////////////////////////////////////////
-        // Save last cycle start time
-        ////////////////////////////////////////////////////////////
-        LastCycleStart = pEvent->GATE.StartTime;
 
-        ////////////////////////////////////////////////////////////
-        // Counts scheduled packets
-        ////////////////////////////////////////////////////////////
-        SchdByte[NumTest] += pEvent->GATE.Length;
+//////////////////////////////////////////////////////////////////
+// FUNCTION:     BOOL WarmupMonitor( DESL::evnt_t* pEvent )
+// PURPOSE:      Feeds packet delay and total queue length observed 
+//               at each packet arrival to the OLT into MSER-5 
+//               transient detectors.
+// ARGUMENTS:    
+// RETURN VALUE: TRUE when both series have reached the steady state,
+//               but not before WARMUP_MIN_TIME
+// NOTES:        The total queue length is updated on EV_PCKT_ENQUE 
+//               and EV_PCKT_DEQUE as in Monitor(), so it must see 
+//               every event of the warm-up.
+//////////////////////////////////////////////////////////////////
+BOOL WarmupMonitor( DESL::evnt_t* pEvent )
+{
+    if( pEvent->Type == EV_PCKT_ARRIVAL && ( pEvent->Producer->ID & ONU_BASE_ID ) )
+    {
+        WarmupDLY.Sample( static_cast<DOUBLE>(DESL::GlobalTime() - pEvent->Pckt.PcktTime) / 1000000 );
+        WarmupQUE.Sample( WarmupQueueLength );
     }
+
+    else if( pEvent->Type == EV_PCKT_ENQUE )
+        WarmupQueueLength += pEvent->Pckt.PcktSize;
+
+    else if( pEvent->Type == EV_PCKT_DEQUE )
+        WarmupQueueLength -= pEvent->Pckt.PcktSize;
+
+    return DESL::GlobalTime() >= WARMUP_MIN_TIME && WarmupDLY.IsSteady() && WarmupQUE.IsSteady();
+}
+
+
+//////////////////////////////////////////////////////////////////
+// FUNCTION:     void SetPacketLimit( int32s limit )
+// PURPOSE:      Sets the number of packets per load point (option 
+//               --packets) and scales the bounds of run-length 
+//               control by the same factor
+//////////////////////////////////////////////////////////////////
+void SetPacketLimit( int32s limit )
+{
+    PacketLimit    = limit;
+    MinPacketLimit = (int32s)( (int64s) MIN_PACKET_LIMIT * limit / PACKET_LIMIT );
+    MaxPacketLimit = (int32s)( (int64s) MAX_PACKET_LIMIT * limit / PACKET_LIMIT );
+}
+
+//////////////////////////////////////////////////////////////////
+// FUNCTION:     BOOL LoadPointCompleted( void )
+// PURPOSE:      Decides whether enough packets are collected at 
+//               the current load
+// ARGUMENTS:    
+// RETURN VALUE: TRUE if the simulation of current load should stop
+//////////////////////////////////////////////////////////////////
+inline BOOL LoadPointCompleted( void )
+{
+    if( TARGET_PRECISION <= 0 )
+        return SentPckt[NumTest] >= PacketLimit;
+
+    if( SentPckt[NumTest] < MinPacketLimit )
+        return FALSE;
+
+    if( SentPckt[NumTest] >= MaxPacketLimit )
+        return TRUE;
+
+    stat_t precision = DCI[NumTest].GetRelHalfWidth();
+    return precision >= 0 && precision <= TARGET_PRECISION;
 }
 
 
@@ -300,16 +610,29 @@ void InitializeEPON( void )
 {
     int32s delay;
 
-    pOLT = new OLT( _OLT_ID( 2 ));
+    pOLT = new OLT( _OLT_ID( 2 ), Topology.NumLLID, Topology.MaxSlot );
+    pONU = new ONU*[ Topology.NumLLID ];
+    pLNK = new BiDirLink*[ Topology.NumLLID ];
+    pSRC = new SRC_CLASS*[ Topology.NumLLID ];
 
-    for( int16s n = 0; n < NUM_LLID; n++ )
+    if( DOWNSTREAM_TRAFFIC )
+    {
+        pSPL = new Splitter( _LNK_ID( MAX_NUM_LLID ), Topology.NumLLID );
+        pDSR = new SRC_CLASS*[ Topology.NumLLID ];
+        pOLT->SetSplitter( pSPL, DOWNSTREAM_BUFFER_SIZE );
+    }
+
+    if( TRAFFIC_CACHE )
+        PacketSource::EnableCache( TRAFFIC_CACHE_DIR, TRAFFIC_DESCRIPTOR, TRAFFIC_SEED ^ ( TRAFFIC_CACHE_VERSION << 16 ));
+
+    for( int16s n = 0; n < Topology.NumLLID; n++ )
     {
         /* find prapagation delay to the ONU */
         delay   = _uniform_int_( PON_MIN_LINK_DISTANCE, PON_MAX_LINK_DISTANCE ) * FIBER_DELAY; 
 
         /* Create Network Elements */
         pSRC[n] = new SRC_CTOR( _SRC_ID( n ));
-        pONU[n] = new ONU( _ONU_ID( n )); 
+        pONU[n] = new ONU( _ONU_ID( n ), Topology.BufferSize ); 
         pLNK[n] = new BiDirLink( delay, _LNK_ID( n ));
 
         /* downstream connection */
@@ -320,12 +643,42 @@ void InitializeEPON( void )
         pONU[n]->SetPort( pLNK[n]    );    /* connect ONU to a logical link   */
         pLNK[n]->SetPort( pOLT,    1 );    /* connect logical link to the OLT */
         pSRC[n]->SetPort( pONU[n]    );    /* connect packet source to ONU */
+
+        if( IDLE_FAST_FORWARD )
+            pOLT->SetIdleONU( n, pONU[n] );
+
+        /* downstream broadcast: source -> OLT -> splitter -> ONU */
+        if( DOWNSTREAM_TRAFFIC )
+        {
+            pDSR[n] = new SRC_CTOR( _DSR_ID( n ));
+            pDSR[n]->SetPort( pOLT );
+            pSPL   ->SetPort( pONU[n], n );
+            pSPL   ->SetDelay( n, delay );
+        }
     }
     /**************************************************/
     MSG_INFO( "Created " << DESL::GetObjCount() << " objects" );
 }
 
 
+//////////////////////////////////////////////////////////////////
+// FUNCTION:     void CloseTrafficCache( void )
+// PURPOSE:      Completes the traffic caches written by the sources.
+//               Called at the end of the warm-up and of each load, 
+//               so that forked processes never share a cache file.
+// ARGUMENTS:    
+// RETURN VALUE: 
+//////////////////////////////////////////////////////////////////
+void CloseTrafficCache( void )
+{
+    for( int16s n = 0; n < Topology.NumLLID; n++ )
+    {
+        pSRC[n]->CloseCache();
+        if( pDSR )  pDSR[n]->CloseCache();
+    }
+}
+
+
 //////////////////////////////////////////////////////////////////
 // FUNCTION:     void DestroyEPON( void )
 // PURPOSE:      
@@ -338,44 +691,152 @@ void DestroyEPON( void )
     DESL::GlobalFree();
 
     DELETE( pOLT ); 
-    for( int16s n = 0; n < NUM_LLID; n++ )
+    for( int16s n = 0; pONU && n < Topology.NumLLID; n++ )
     {
         DELETE( pONU[n] );
         DELETE( pLNK[n] );
         DELETE( pSRC[n] );
+        if( pDSR )  DELETE( pDSR[n] );
     }
+    DELETE( pSPL );
+
+    delete [] pONU;     pONU = NULL;
+    delete [] pLNK;     pLNK = NULL;
+    delete [] pSRC;     pSRC = NULL;
+    delete [] pDSR;     pDSR = NULL;
+
+    PacketTrace::ReleaseAll();
+    PROC::FramePool::Clear();
 }
 
 //////////////////////////////////////////////////////////////////
-// FUNCTION:     void Execute( void )
-// PURPOSE:      
-// ARGUMENTS:    
-// RETURN VALUE: 
+// FUNCTION:     BOOL SerializeState( Archive& ar, BOOL& in_progress )
+// PURPOSE:      Writes or reads a checkpoint: random generator, 
+//               scenario state, results of all tests, and the state 
+//               of all simulation objects and of the event queue.
+// ARGUMENTS:    in_progress - whether test NumTest has already started
+// RETURN VALUE: TRUE on success
 //////////////////////////////////////////////////////////////////
-void Execute( void )
+BOOL SerializeState( Archive& ar, BOOL& in_progress )
 {
-    DESL::evnt_t* pEvent;
-    DESL::GlobalReset();
+    MTRand::uint32 rnd[ MTRand::SAVE ];
 
-    MSG_INFO( "Warming-up ..." );
+    if( ar.IsWriting() )
+        RND.save( rnd );
+
+    ar.Header( SIMULATION_TAG );
+    ar.Check( Topology.NumLLID );
+    ar.Check( Topology.BufferSize );
+    ar.Check( NUM_TEST );
+    ar & rnd & NumTest & in_progress;
+    ar & LastQueueLength & LastQueueChange & LastCycleStart;
 
-    ////////////////////////////////////////////////////////////    
-    // Warmup the system 
     ////////////////////////////////////////////////////////////
-    while( DESL::GlobalTime() < WARMUP_TIME ) 
+    // Tests after NumTest have no results yet
+    ////////////////////////////////////////////////////////////
+    for( int16s t = 0; t <= NumTest && t < NUM_TEST; t++ )
     {
-        pEvent = DESL::GetNextEvent();
-        //Monitor(pEvent);
-        DESL::DispatchEvent(pEvent);
+        TEST_COUNTERS( SERIALIZE_COUNTER );
+        TEST_STATS( SERIALIZE_STATS );
     }
 
-    MSG_INFO( "Warm-up completed" );
+    DESL::GlobalSerialize( ar );
 
-   
-    ////////////////////////////////////////////////////////////
-    //  Main loop
-    ////////////////////////////////////////////////////////////
-    for( NumTest = 0; NumTest < NUM_TEST; NumTest++ )
+    if( ar.IsReading() && ar.IsGood() )
+        RND.load( rnd );
+
+    return ar.IsGood();
+}
+
+//////////////////////////////////////////////////////////////////
+// FUNCTION:     std::string LoadPointName( const std::string& base, int16s t, const char* ext )
+// PURPOSE:      Returns name of a file of load point t, "base_NN.ext"
+//////////////////////////////////////////////////////////////////
+std::string LoadPointName( const std::string& base, int16s t, const char* ext )
+{
+    char suffix[16];
+    _snprintf_s( suffix, sizeof( suffix ), sizeof( suffix ) - 1, "_%02i%s", t, ext );
+    return base + suffix;
+}
+
+//////////////////////////////////////////////////////////////////
+// FUNCTION:     void SaveCheckpoint( BOOL in_progress )
+// PURPOSE:      Writes a checkpoint to a temporary file and then 
+//               replaces the previous checkpoint with it, so that 
+//               a crash while writing does not destroy the last 
+//               good checkpoint.
+// ARGUMENTS:    in_progress - whether test NumTest has already started
+// RETURN VALUE: 
+//////////////////////////////////////////////////////////////////
+void SaveCheckpoint( BOOL in_progress )
+{
+    if( CHECKPOINT_INTERVAL <= 0 || CheckpointFile.empty() )
+        return;
+
+    Archive     ar;
+    std::string tmp_file = CheckpointFile + ".tmp";
+
+    if( !ar.Open( tmp_file.c_str(), TRUE ) || !SerializeState( ar, in_progress ) || !ar.Close() )
+    {
+        MSG_WARN( "Cannot write checkpoint " << tmp_file );
+        return;
+    }
+
+    remove( CheckpointFile.c_str() );
+    rename( tmp_file.c_str(), CheckpointFile.c_str() );
+    NextCheckpoint = time( NULL ) + CHECKPOINT_INTERVAL;
+
+    MSG_INFO( "Checkpoint saved at " << DESL::GlobalTime() * 1.0 / UNITS_PER_SEC << " sec (test " << NumTest << ")" );
+}
+
+//////////////////////////////////////////////////////////////////
+// FUNCTION:     void RemoveCheckpoints( void )
+// PURPOSE:      Deletes the checkpoints of a completed simulation: 
+//               "name.ckpt" and those of the forked load points 
+//               "name_NN.ckpt"
+// ARGUMENTS:    
+// RETURN VALUE: 
+//////////////////////////////////////////////////////////////////
+void RemoveCheckpoints( void )
+{
+    if( CHECKPOINT_INTERVAL <= 0 )
+        return;
+
+    remove( ( RunName + ".ckpt" ).c_str() );
+
+    if( FORK_LOAD_POINTS > 0 )
+        for( int16s t = 0; t < NUM_TEST; t++ )
+            remove( LoadPointName( RunName, t, ".ckpt" ).c_str() );
+}
+
+//////////////////////////////////////////////////////////////////
+// FUNCTION:     BOOL LoadCheckpoint( const char* file, BOOL& in_progress )
+// PURPOSE:      Restores simulation from a checkpoint. All objects 
+//               must already be created by InitializeEPON()
+// ARGUMENTS:    
+// RETURN VALUE: TRUE on success
+//////////////////////////////////////////////////////////////////
+BOOL LoadCheckpoint( const char* file, BOOL& in_progress )
+{
+    Archive ar;
+    return ar.Open( file, FALSE ) && SerializeState( ar, in_progress );
+}
+
+
+//////////////////////////////////////////////////////////////////
+// FUNCTION:     void SimulateLoadPoint( BOOL resume )
+// PURPOSE:      Sets the load NumTest and simulates it until 
+//               LoadPointCompleted()
+// ARGUMENTS:    resume - TRUE if the load was already set before 
+//                        the simulation was restored from a checkpoint
+// RETURN VALUE: 
+//////////////////////////////////////////////////////////////////
+void SimulateLoadPoint( BOOL resume = FALSE )
+{
+    DESL::evnt_t* pEvent;
+    int32u        events = 0;
+
+    if( !resume )
     {
         TargetLoad[NumTest] = MIN_LOAD + NumTest * LOAD_STEP;
         MSG_INFO( "load = " << TargetLoad[NumTest] );
@@ -383,29 +844,284 @@ void Execute( void )
         ////////////////////////////////////////////////////////////
         // Set Load
         ////////////////////////////////////////////////////////////
-        for( int16s n =0; n < NUM_LLID; n++ )
+        for( int16s n =0; n < Topology.NumLLID; n++ )
+        {
             pSRC[n]->SetLoad( TargetLoad[NumTest] );
+            if( pDSR )  pDSR[n]->SetLoad( TargetLoad[NumTest] );
+        }
 
         ////////////////////////////////////////////////////////////
         // Remember test start time
         ////////////////////////////////////////////////////////////
         RunTime[NumTest] = DESL::GlobalTime();
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Start trace of this load point
+    ////////////////////////////////////////////////////////////
+    if( TRACE_PACKETS || TRACE_CYCLES )
+    {
+        std::string trace_file = LoadPointName( RunName, NumTest, ".trc" );
+        if( !Trace.Open( trace_file.c_str() ))
+            MSG_WARN( "Cannot open trace " << trace_file );
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Simulate until specified number of packets is received, 
+    // or until the average delay converges.
+    //////////////////////////////////////////// ////////////////
+    pOLT->SetGateMonitor( MonitorGATE );
+
+    while( !LoadPointCompleted() )
+    {
+        pEvent = DESL::GetNextEvent();
+        Monitor( pEvent);
+        DESL::DispatchEvent( pEvent );
 
         ////////////////////////////////////////////////////////////
-        // Simulate until specified number of packets is received.
-        //////////////////////////////////////////// ////////////////
-        while( SentPckt[NumTest] < PACKET_LIMIT )
+        // Check wall-clock time only once in a while
+        ////////////////////////////////////////////////////////////
+        if( ( ++events & 0xFFFF ) == 0 && CHECKPOINT_INTERVAL > 0 && time( NULL ) >= NextCheckpoint )
+            SaveCheckpoint( TRUE );
+    }
+
+    pOLT->CompleteIdleCycles();
+    pOLT->SetGateMonitor( NULL );
+
+    ////////////////////////////////////////////////////////////
+    // Calculate simulated time
+    ////////////////////////////////////////////////////////////
+    RunTime[NumTest] = DESL::GlobalTime() - RunTime[NumTest];
+    CloseTrafficCache();
+
+    if( Trace.IsOpen() )
+    {
+        int64u records = Trace.GetRecords();
+        if( !Trace.Close() )
+            MSG_WARN( "Trace of load " << TargetLoad[NumTest] << " is incomplete" );
+        MSG_INFO( "Trace records," << records );
+    }
+}
+
+
+#if defined( FORK_SUPPORTED )
+//////////////////////////////////////////////////////////////////
+// FUNCTION:     void TransferTestResult( int fd, int16s t, BOOL send )
+// PURPOSE:      Sends results of test t to a pipe (child process) 
+//               or receives them from a pipe (parent process).
+//////////////////////////////////////////////////////////////////
+void TransferTestResult( int fd, int16s t, BOOL send )
+{
+    FILE*   file = fdopen( fd, send? "wb": "rb" );
+    Archive ar( file, send );
+
+    TEST_COUNTERS( SERIALIZE_COUNTER );
+    TEST_STATS( SERIALIZE_STATS );
+
+    if( !ar.Close() )
+        MSG_WARN( "Result transfer failed for test " << t );
+
+    if( file ) fclose( file );
+}
+
+//////////////////////////////////////////////////////////////////
+// FUNCTION:     void SimulateForkedLoadPoint( const std::string& resume_base )
+// PURPOSE:      Simulates load point NumTest in a child process.  
+//               The load point continues from its checkpoint 
+//               "resume_base_NN.ckpt" if there is one, and writes 
+//               its own checkpoints "name_NN.ckpt".  
+// ARGUMENTS:    resume_base - name of the resumed simulation, or 
+//                             empty if not resumed
+// RETURN VALUE: 
+// NOTES:        The final checkpoint is written with NumTest of 
+//               the next load, which marks the load as completed.
+//////////////////////////////////////////////////////////////////
+void SimulateForkedLoadPoint( const std::string& resume_base )
+{
+    int16s test        = NumTest;
+    BOOL   in_progress = FALSE;
+    FILE*  file;
+
+    CheckpointFile = LoadPointName( RunName, test, ".ckpt" );
+    NextCheckpoint = time( NULL ) + CHECKPOINT_INTERVAL;
+
+    if( !resume_base.empty() )
+    {
+        std::string resume_file = LoadPointName( resume_base, test, ".ckpt" );
+
+        if(( file = fopen( resume_file.c_str(), "rb" )) != NULL )
+        {
+            fclose( file );
+            if( !LoadCheckpoint( resume_file.c_str(), in_progress ) || NumTest < test || NumTest > test + 1 )
+            {
+                MSG_WARN( "Cannot resume load point " << test << " from " << resume_file );
+                SimLog.Suspend();
+                _exit( 102 );
+            }
+            MSG_INFO( "Resumed load point " << test << " from " << resume_file );
+        }
+    }
+
+    if( NumTest == test )
+        SimulateLoadPoint( in_progress );
+
+    NumTest = test + 1;
+    SaveCheckpoint( FALSE );
+    NumTest = test;
+}
+
+//////////////////////////////////////////////////////////////////
+// FUNCTION:     void ForkLoadPoints( const std::string& resume_base )
+// PURPOSE:      Simulates every load point in a child process 
+//               forked from the warmed-up system, so that each 
+//               load starts from the same state without repeating 
+//               the warm-up.  fork() shares the warmed-up memory 
+//               copy-on-write; up to FORK_LOAD_POINTS children run 
+//               at the same time.  Results are collected in order.
+// ARGUMENTS:    resume_base - name of the resumed simulation, or 
+//                             empty if not resumed
+// NOTES:        All children inherit the same random generator 
+//               state, i.e., load points use common random numbers.
+//////////////////////////////////////////////////////////////////
+void ForkLoadPoints( const std::string& resume_base )
+{
+    pid_t  pid[ NUM_TEST ];
+    int    pipe_fd[ NUM_TEST ];
+    int16s next = 0;
+
+    for( int16s done = 0; done < NUM_TEST; done++ )
+    {
+        for( ; next < NUM_TEST && next - done < FORK_LOAD_POINTS; next++ )
         {
-            pEvent = DESL::GetNextEvent();
-            Monitor( pEvent);
-            DESL::DispatchEvent( pEvent );
+            int fd[2];
+            SimLog.Suspend();
+            if( pipe( fd ) != 0 || ( pid[next] = fork()) < 0 )
+            {
+                MSG_WARN( "Cannot fork load point " << next );
+                exit( 101 );
+            }
+            SimLog.Start();
+
+            if( pid[next] == 0 )    
+            {
+                // child process: simulate one load and report back
+                close( fd[0] );
+                NumTest = next;
+                SimulateForkedLoadPoint( resume_base );
+                TransferTestResult( fd[1], NumTest, TRUE );
+                PROFILE_DUMP();
+                SimLog.Suspend();
+                _exit( 0 );
+            }
+
+            close( fd[1] );
+            pipe_fd[next] = fd[0];
         }
 
+        TransferTestResult( pipe_fd[done], done, FALSE );
+        waitpid( pid[done], NULL, 0 );
+    }
+}
+#endif // FORK_SUPPORTED
+
+
+//////////////////////////////////////////////////////////////////
+// FUNCTION:     void Warmup( void )
+// PURPOSE:      
+// ARGUMENTS:    
+// RETURN VALUE: 
+//////////////////////////////////////////////////////////////////
+void Warmup( void )
+{
+    DESL::evnt_t* pEvent;
+    DESL::GlobalReset();
+
+    MSG_INFO( "Warming-up ..." );
+
+    ////////////////////////////////////////////////////////////    
+    // Warmup the system 
+    ////////////////////////////////////////////////////////////
+    while( DESL::GlobalTime() < WARMUP_TIME ) 
+    {
+        pEvent = DESL::GetNextEvent();
+        //Monitor(pEvent);
+
+        if( WARMUP_DETECTION && WarmupMonitor( pEvent ))
+        {
+            DESL::DispatchEvent(pEvent);
+            break;
+        }
+        DESL::DispatchEvent(pEvent);
+    }
+
+    pOLT->CompleteIdleCycles();     // GATEs of the warm-up are not monitored
+    CloseTrafficCache();
+    MSG_INFO( "Warm-up completed" );
+    MSG_CONF( "Warm-up end (seconds),"          << DESL::GlobalTime() * 1.0 / UNITS_PER_SEC );
+    MSG_CONF( "Warm-up truncation DLY (pckts)," << WarmupDLY.GetTruncation() << "," << WarmupDLY.GetCount() );
+    MSG_CONF( "Warm-up truncation QUE (pckts)," << WarmupQUE.GetTruncation() << "," << WarmupQUE.GetCount() );
+}
+
+//////////////////////////////////////////////////////////////////
+// FUNCTION:     void Execute( const char* name, const char* resume_file )
+// PURPOSE:      
+// ARGUMENTS:    name        - simulation name used for the checkpoint file
+//               resume_file - checkpoint to resume from, or NULL
+// RETURN VALUE: 
+//////////////////////////////////////////////////////////////////
+void Execute( const char* name, const char* resume_file )
+{
+    BOOL        in_progress = FALSE;
+    std::string resume_base;
+
+    RunName        = name;
+    CheckpointFile = RunName + ".ckpt";
+
+    if( resume_file )
+    {
+        if( !LoadCheckpoint( resume_file, in_progress ))
+        {
+            MSG_WARN( "Cannot resume simulation from " << resume_file );
+            return;
+        }
+        MSG_INFO( "Resumed from " << resume_file << " at " << DESL::GlobalTime() * 1.0 / UNITS_PER_SEC << " sec (test " << NumTest << ")" );
+
         ////////////////////////////////////////////////////////////
-        // Calculate simulated time
+        // Forked load points resume from their own checkpoints 
+        // "resume_base_NN.ckpt"; the resumed checkpoint is the one 
+        // written after the warm-up
         ////////////////////////////////////////////////////////////
-        RunTime[NumTest] = DESL::GlobalTime() - RunTime[NumTest];
+        resume_base = resume_file;
+        if( resume_base.size() > 5 && resume_base.compare( resume_base.size() - 5, 5, ".ckpt" ) == 0 )
+            resume_base.resize( resume_base.size() - 5 );
+
+        if( FORK_LOAD_POINTS > 0 )
+        {
+            if( NumTest != 0 || in_progress )
+            {
+                MSG_WARN( "Forked load points resume only from the warm-up checkpoint, not from " << resume_file );
+                return;
+            }
+            SaveCheckpoint( FALSE );
+        }
+    }
+    else
+    {
+        Warmup();
+        NumTest = 0;
+        SaveCheckpoint( FALSE );
     }
+   
+    ////////////////////////////////////////////////////////////
+    //  Main loop
+    ////////////////////////////////////////////////////////////
+#if defined( FORK_SUPPORTED )
+    if( FORK_LOAD_POINTS > 0 )
+        ForkLoadPoints( resume_base );
+    else
+#endif
+    for( ; NumTest < NUM_TEST; NumTest++, in_progress = FALSE )
+        SimulateLoadPoint( in_progress );
 
     ////////////////////////////////////////////////////////////
     // Print Simulation Results
@@ -413,6 +1129,7 @@ void Execute( void )
     MSG_INFO( "Simulation completed. Printing Results..." );
 
     PrintResult();
+    RemoveCheckpoints();
 
     ////////////////////////////////////////////////////////////
 }
@@ -425,8 +1142,20 @@ void Execute( void )
 //////////////////////////////////////////////////////////////////
 void OutputConfiguration( void )
 {
-    MSG_CONF( "Packet Limit,"               << PACKET_LIMIT );
+    MSG_CONF( "Packet Limit,"               << PacketLimit );
+    MSG_CONF( "Target Precision,"           << TARGET_PRECISION );
+    MSG_CONF( "Min Packet Limit,"           << MinPacketLimit );
+    MSG_CONF( "Max Packet Limit,"           << MaxPacketLimit );
     MSG_CONF( "Warm-up time (seconds),"     << WARMUP_TIME * 1.0 / UNITS_PER_SEC );
+    MSG_CONF( "Warm-up detection,"          << ( WARMUP_DETECTION? "MSER-5": "none" ));
+    MSG_CONF( "Forked load points,"         << FORK_LOAD_POINTS );
+    MSG_CONF( "Checkpoint interval (sec),"  << CHECKPOINT_INTERVAL );
+    MSG_CONF( "Packet trace,"               << ( TRACE_PACKETS? "ON": "OFF" ));
+    MSG_CONF( "Cycle trace,"                << ( TRACE_CYCLES? "ON": "OFF" ));
+    MSG_CONF( "Idle fast-forward,"          << ( IDLE_FAST_FORWARD? "ON": "OFF" ));
+    MSG_CONF( "Downstream traffic,"         << ( DOWNSTREAM_TRAFFIC? "ON": "OFF" ));
+    MSG_CONF( "Traffic cache,"              << ( TRAFFIC_CACHE? TRAFFIC_CACHE_DIR: "OFF" ));
+    MSG_CONF( "Traffic seed,"               << TRAFFIC_SEED );
     MSG_CONF( "Minimum Load,"               << MIN_LOAD );
     MSG_CONF( "Maximum Load,"               << MAX_LOAD );
     MSG_CONF( "Number of Tests,"            << NUM_TEST );
@@ -4,11 +4,16 @@
 // Description: This file contains declarations for
 //              class Packet 
 //              class Stream
+//              class StreamT
 //              class StreamPareto
 //              class StreamExpon
+//              class StreamExponAggregate
 //              class StreamCBR
 //              class StreamVideo
+//              class StreamFGN
 //
+//              class PacketGeneratorBase
+//              class PacketGeneratorT
 //              class PacketGenerator
 //              class PacketGeneratorDist
 //
@@ -43,6 +48,16 @@
 // 12/2/2005 - Changed Stream::Reset() function to prevent alignment of 
 //             OFF periods upon reset.
 // ----------------------------------------------------------------------
+// Stream pool is an indexed binary heap (_heap.h) instead of an AVL 
+// tree.  A stream that produced a burst is sifted down from the head 
+// instead of being removed and re-inserted.  Streams with equal burst 
+// times are returned in the same order as before.
+// ----------------------------------------------------------------------
+// PacketGeneratorT< S > keeps streams of a single type S by value in 
+// one array and generates bursts without virtual calls (see StreamT).
+// PacketGenerator (PacketGeneratorT< Stream >) keeps streams of any 
+// type, e.g., a mixed pool.
+// ----------------------------------------------------------------------
 // 
 //
 /////////////////////////////////////////////////////////////////////////
@@ -54,9 +69,14 @@
 #define _TRF_GEN_H_V003_INCLUDED_
 
 
+#include <float.h>
+#include <new>
+#include <type_traits>
 #include "_types.h"
 #include "_rand_MT.h"
-#include "avltree.h"
+#include "_ckpt.h"
+#include "_heap.h"
+#include "_fft.h"
 
 template < class T > inline T SetInRange( T x, T y, T z ) 
 { 
@@ -117,24 +137,24 @@ namespace GEN
     ///
     /////////////////////////////////////////////////////////////////////
     /////////////////////////////////////////////////////////////////////
-    class Stream: public AVL::AVLNode< bytestamp_t > 
+    class Stream: public HeapNode 
     {
+    template < class S > friend class PacketGeneratorBase;
 
-    #define BurstTime AVL::AVLNode<bytestamp_t>::NodeKey
-
-    friend class PacketGenerator;
-
-    private:
+    protected:
+        bytestamp_t   BurstTime;    // arrival of current burst
         burst_size_t  BurstSize;    // number of bytes in current burst
         
+    private:
         /////////////////////////////////////////////////////////////////    
         virtual inline burst_size_t  NextBurstSize(void)  = 0;
         virtual inline pause_size_t  NextPauseSize(void)  = 0;
         
 
     public:
-        Stream(): AVL::AVLNode< bytestamp_t >( 0 ) 
+        Stream()
         {
+            BurstTime = 0;
             BurstSize = 0;
         }
 
@@ -144,18 +164,58 @@ namespace GEN
         virtual inline void SetLoad( load_t ) = 0;
 
         /////////////////////////////////////////////////////////////////
-        inline void SetLoadRecursive( load_t load )
-        {
-            SetLoad( load );
-            if( LChild )  ((Stream*)LChild)->SetLoadRecursive( load );
-            if( RChild )  ((Stream*)RChild)->SetLoadRecursive( load );
-        }
-       
+        // FUNCTION:    void Reset(void)
+        // DESCRIPTION: Starts the stream at a random point of its 
+        //              ON/OFF cycle (see StreamT)
         /////////////////////////////////////////////////////////////////
-        inline void Reset(void)
+        virtual void Reset(void) = 0;
+
+        /////////////////////////////////////////////////////////////////
+        inline bytestamp_t   GetArrival(void)   const  { return BurstTime; }
+        inline bytestamp_t   GetKey(void)       const  { return BurstTime; }
+        inline burst_size_t  GetBurstSize(void) const  { return BurstSize; }
+
+        /////////////////////////////////////////////////////////////////
+        // FUNCTION:    void Serialize( Archive& ar )
+        // DESCRIPTION: Writes or reads the state of the stream 
+        // NOTES:       Derived classes add their own parameters
+        /////////////////////////////////////////////////////////////////
+        virtual void Serialize( Archive& ar )  { ar & BurstTime & BurstSize; }
+
+        /////////////////////////////////////////////////////////////////
+        // FUNCTION:    void ExtractPacket(void)
+        // DESCRIPTION: Generates new burst
+        // NOTES:       
+        /////////////////////////////////////////////////////////////////
+        virtual void ExtractBurst(void) = 0;
+        /////////////////////////////////////////////////////////////////
+    };  // class Stream
+
+
+
+    /////////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////
+    ///
+    /// class StreamT
+    ///
+    /// Base of a stream class S that implements Reset() and ExtractBurst()
+    /// with S::NextBurstSize() and S::NextPauseSize().  The sizes are 
+    /// called directly, so PacketGeneratorT< S > generates a burst 
+    /// without virtual calls.  S must be a friend of StreamT< S >.
+    /////////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////
+    template < class S > class StreamT: public Stream 
+    {
+    private:
+        inline burst_size_t NextBurst(void) { return static_cast< S* >( this )->S::NextBurstSize(); }
+        inline pause_size_t NextPause(void) { return static_cast< S* >( this )->S::NextPauseSize(); }
+
+    public:
+        /////////////////////////////////////////////////////////////////
+        virtual inline void Reset(void)
         {
-            BurstSize = NextBurstSize();
-            BurstTime = NextPauseSize() + BurstSize;
+            BurstSize = NextBurst();
+            BurstTime = NextPause() + BurstSize;
 
             // quick start: simulate start at random time during ON- or OFF-period
             bytestamp_t start_time = _uniform_int_( 0, (rnd_int_t)BurstTime );
@@ -167,30 +227,22 @@ namespace GEN
             }
             else  // zero time fell on OFF period
             {
-                BurstSize = NextBurstSize(); 
+                BurstSize = NextBurst(); 
                 BurstTime -= start_time;
             }
         }
 
         /////////////////////////////////////////////////////////////////
-        inline bytestamp_t   GetArrival(void)   const  { return BurstTime; }
-        inline burst_size_t  GetBurstSize(void) const  { return BurstSize; }
-
-        /////////////////////////////////////////////////////////////////
-        // FUNCTION:    void ExtractPacket(void)
-        // DESCRIPTION: Generates new burst
-        // NOTES:       
-        /////////////////////////////////////////////////////////////////
-        inline void ExtractBurst(void)
+        virtual inline void ExtractBurst(void)
         {
-            BurstTime += BurstSize + NextPauseSize(); // Update BurstTime to point to 
+            BurstTime += BurstSize + NextPause();     // Update BurstTime to point to 
                                                       // PauseSize after the end of burst.
 
-            BurstSize  = NextBurstSize();             // Get next burst size.
+            BurstSize  = NextBurst();                 // Get next burst size.
                                                       // This burst starts at BurstTime.
         }
         /////////////////////////////////////////////////////////////////
-    };  // class Stream
+    };  // class StreamT
 
 
 
@@ -201,8 +253,10 @@ namespace GEN
     ///
     /////////////////////////////////////////////////////////////////////
     /////////////////////////////////////////////////////////////////////
-    class StreamPareto : public Stream
+    class StreamPareto : public StreamT< StreamPareto >
     {
+    friend class StreamT< StreamPareto >;
+
     private:
         float    MinBurst;    // minimum burst length (in bytes)
         float    MinPause;    // minimum inter-burst gap value (in bytes) 
@@ -214,7 +268,7 @@ namespace GEN
         /////////////////////////////////////////////////////////////////
 
     public:
-        StreamPareto( load_t ld, float mean_burst, shape_t shape ) : Stream()
+        StreamPareto( load_t ld, float mean_burst, shape_t shape ) : StreamT< StreamPareto >()
         { 
             Shape = SetInRange<shape_t>( shape,  MIN_ALPHA, MAX_ALPHA );
             MinBurst = mean_burst * ( 1.0F - 1.0F / Shape );
@@ -230,6 +284,13 @@ namespace GEN
         {
             MinPause = MinBurst * ( 1.0F / SetInRange(load, MIN_LOAD, MAX_LOAD) - 1.0F );
         }
+
+        /////////////////////////////////////////////////////////////////
+        virtual void Serialize( Archive& ar )  
+        { 
+            Stream::Serialize( ar ); 
+            ar & MinBurst & MinPause & Shape; 
+        }
     };  // class StreamPareto
 
 
@@ -241,8 +302,10 @@ namespace GEN
     ///
     /////////////////////////////////////////////////////////////////////
     /////////////////////////////////////////////////////////////////////
-    class StreamExpon : public Stream
+    class StreamExpon : public StreamT< StreamExpon >
     {
+    friend class StreamT< StreamExpon >;
+
     private:
         float    MeanPause;      // mean inter-burst gap value (in bytes)
         float    MeanBurst;      // mean burst size (in bytes)
@@ -254,7 +317,7 @@ namespace GEN
                 
     public:
 
-        StreamExpon( load_t ld, float mean_burst ) : Stream()
+        StreamExpon( load_t ld, float mean_burst ) : StreamT< StreamExpon >()
         { 
             MeanBurst = mean_burst;
             SetLoad( ld );
@@ -269,10 +332,197 @@ namespace GEN
             MeanPause = MeanBurst * ( 1.0F / SetInRange(load, MIN_LOAD, MAX_LOAD) - 1.0F );
         }
         /////////////////////////////////////////////////////////////////
+        virtual void Serialize( Archive& ar )  
+        { 
+            Stream::Serialize( ar ); 
+            ar & MeanPause & MeanBurst; 
+        }
+        /////////////////////////////////////////////////////////////////
 
     };  // class StreamExpon
 
 
+    /////////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////
+    ///
+    /// class StreamExponAggregate
+    ///
+    /// Superposition of 'sources' independent StreamExpon streams, each 
+    /// with 1/sources of the load, generated as a single stream.  The 
+    /// cost of a burst does not grow with the number of sources the way
+    /// a pool of separate streams does.
+    ///
+    /// A source in its OFF period waits an exponential time, so the next 
+    /// burst from the Idle sources arrives after an exponential time with 
+    /// mean MeanPause / Idle.  A burst of size B keeps its source ON for 
+    /// exactly B byte times, so the ends of the ON periods are kept in a 
+    /// heap (one entry per active source).  When a source turns idle, the 
+    /// remaining wait for the next idle arrival is scaled by 
+    /// Idle / (Idle + 1), which is exact for exponential times.
+    ///
+    /// Reset() starts every source at a random point of its ON/OFF cycle, 
+    /// like StreamT::Reset().  A source that starts in an OFF period waits 
+    /// the rest of that period (which is not exponential), so these first 
+    /// arrivals are kept in a separate heap.  Bursts of the sources that 
+    /// start in an ON period all arrive at time 0 and are merged into a 
+    /// single burst.
+    /////////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////
+    class StreamExponAggregate final : public Stream
+    {
+    private:
+        float                   MeanPause;      // mean inter-burst gap of one source (in bytes)
+        float                   MeanBurst;      // mean burst size (in bytes)
+        int32s                  Sources;        // number of superposed sources
+        int32s                  Idle;           // sources in exponential OFF period
+        DOUBLE                  IdleArrival;    // next burst from idle sources (if Idle > 0)
+        KeyHeap< bytestamp_t >  OnEnd;          // ends of ON periods of active sources
+        KeyHeap< bytestamp_t >  FirstArrival;   // first bursts of sources that started OFF
+
+        virtual  inline burst_size_t NextBurstSize(void) { return round<burst_size_t>(_exponent_() * MeanBurst); }
+        virtual  inline pause_size_t NextPauseSize(void) { return round<pause_size_t>(_exponent_() * MeanPause); }
+
+        /////////////////////////////////////////////////////////////////
+        // A burst arrives at 'arrival' and keeps its source ON
+        /////////////////////////////////////////////////////////////////
+        inline void StartBurst( bytestamp_t arrival )
+        {
+            BurstTime = arrival;
+            BurstSize = NextBurstSize();
+            OnEnd.Push( BurstTime + BurstSize );
+        }
+
+        /////////////////////////////////////////////////////////////////
+                
+    public:
+
+        StreamExponAggregate( load_t ld, float mean_burst, int32s sources ) : Stream()
+        { 
+            MeanBurst = mean_burst;
+            Sources   = MAX< int32s >( sources, 1 );
+            SetLoad( ld );
+            Reset();
+        }
+        /////////////////////////////////////////////////////////////////
+        virtual ~StreamExponAggregate()       {}
+        /////////////////////////////////////////////////////////////////
+       
+        virtual inline void SetLoad( load_t load )
+        {
+            MeanPause = MeanBurst * ( 1.0F / SetInRange(load / Sources, MIN_LOAD, MAX_LOAD) - 1.0F );
+        }
+
+        /////////////////////////////////////////////////////////////////
+        virtual void Reset(void)
+        {
+            burst_size_t initial = 0;
+
+            OnEnd.Clear();
+            FirstArrival.Clear();
+            Idle = 0;
+
+            for( int32s n = 0; n < Sources; n++ )
+            {
+                burst_size_t burst_size  = NextBurstSize();
+                bytestamp_t  cycle       = NextPauseSize() + burst_size;
+                bytestamp_t  start_time  = _uniform_int_( 0, (rnd_int_t)cycle );
+
+                if( start_time < burst_size )   // zero time fell on ON period 
+                {
+                    initial += burst_size - (burst_size_t)start_time;
+                    OnEnd.Push( burst_size - start_time );
+                }
+                else                            // zero time fell on OFF period
+                    FirstArrival.Push( cycle - start_time );
+            }
+
+            if( initial > 0 )
+            {
+                BurstTime = 0;
+                BurstSize = initial;
+            }
+            else
+            {
+                BurstTime = BurstSize = 0;
+                ExtractBurst();
+            }
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // FUNCTION:    void ExtractBurst(void)
+        // DESCRIPTION: Advances to the next burst of the superposition
+        /////////////////////////////////////////////////////////////////
+        virtual void ExtractBurst(void)
+        {
+            for( ;; )
+            {
+                DOUBLE idle  = Idle? IdleArrival: DBL_MAX;
+                DOUBLE first = FirstArrival.GetCount()? (DOUBLE) FirstArrival.GetTop(): DBL_MAX;
+                DOUBLE end   = OnEnd.GetCount()? (DOUBLE) OnEnd.GetTop(): DBL_MAX;
+
+                if( end < idle && end < first )
+                {
+                    /* a source ends its ON period and turns idle */
+                    OnEnd.Pop();
+                    IdleArrival = Idle? end + ( IdleArrival - end ) * Idle / ( Idle + 1 ):
+                                        end + _exponent_() * MeanPause;
+                    Idle++;
+                }
+                else if( first <= idle )
+                {
+                    StartBurst( FirstArrival.Pop() );
+                    return;
+                }
+                else
+                {
+                    /* arrivals are in whole bytes, like the pauses of StreamExpon */
+                    StartBurst( MAX< bytestamp_t >( BurstTime, (bytestamp_t)( IdleArrival + 0.5 )));
+                    if( --Idle )
+                        IdleArrival += _exponent_() * MeanPause / Idle;
+                    return;
+                }
+            }
+        }
+
+        /////////////////////////////////////////////////////////////////
+        virtual void Serialize( Archive& ar )  
+        { 
+            Stream::Serialize( ar ); 
+            ar & MeanPause & MeanBurst & Sources & Idle & IdleArrival; 
+            SerializeHeap( ar, OnEnd );
+            SerializeHeap( ar, FirstArrival );
+        }
+
+        /////////////////////////////////////////////////////////////////
+        static void SerializeHeap( Archive& ar, KeyHeap< bytestamp_t >& heap )
+        {
+            int32s count = heap.GetCount();
+            ar & count;
+
+            if( ar.IsWriting() )
+            {
+                for( int32s n = 0; n < count; n++ )
+                {
+                    bytestamp_t key = heap.GetKey( n );
+                    ar & key;
+                }
+            }
+            else
+            {
+                heap.Clear();
+                for( int32s n = 0; n < count && ar.IsGood(); n++ )
+                {
+                    bytestamp_t key;
+                    ar & key;
+                    heap.Push( key );
+                }
+            }
+        }
+        /////////////////////////////////////////////////////////////////
+
+    };  // class StreamExponAggregate
+
+
     /////////////////////////////////////////////////////////////////////
     /////////////////////////////////////////////////////////////////////
     ///
@@ -280,8 +530,10 @@ namespace GEN
     ///
     /////////////////////////////////////////////////////////////////////
     /////////////////////////////////////////////////////////////////////
-    class StreamCBR : public Stream
+    class StreamCBR : public StreamT< StreamCBR >
     {
+    friend class StreamT< StreamCBR >;
+
     private:
         burst_size_t BurstSize;        // burst length (in bytes)
         pause_size_t PauseSize;        // inter-burst gap value (in bytes)
@@ -293,7 +545,7 @@ namespace GEN
         
     public:
 
-        StreamCBR( load_t ld, float mean_burst ) : Stream()
+        StreamCBR( load_t ld, float mean_burst ) : StreamT< StreamCBR >()
         { 
             BurstSize = round<burst_size_t>( mean_burst );
             SetLoad( ld );
@@ -308,6 +560,12 @@ namespace GEN
             PauseSize = round<pause_size_t>(BurstSize * (1.0F / SetInRange(load, MIN_LOAD, MAX_LOAD) - 1.0F));
         }
         /////////////////////////////////////////////////////////////////
+        virtual void Serialize( Archive& ar )  
+        { 
+            Stream::Serialize( ar ); 
+            ar & BurstSize & PauseSize; 
+        }
+        /////////////////////////////////////////////////////////////////
 
     };  // class StreamCBR
 
@@ -319,8 +577,10 @@ namespace GEN
     ///
     /////////////////////////////////////////////////////////////////////
     /////////////////////////////////////////////////////////////////////
-    class StreamVideo : public Stream
+    class StreamVideo : public StreamT< StreamVideo >
     {
+    friend class StreamT< StreamVideo >;
+
     private:
         burst_size_t    Tokens;
         burst_size_t    LastBurst;
@@ -348,12 +608,14 @@ namespace GEN
     public:
         //StreamVideo(load_t ld, burst_size_t max_burst, pause_size_t burst_period, shape_t shape) : Stream()
 
-        StreamVideo( load_t ld, float max_burst, pause_size_t burst_period, shape_t shape ) : Stream()
+        StreamVideo( load_t ld, float max_burst, pause_size_t burst_period, shape_t shape ) : StreamT< StreamVideo >()
         { 
             Shape = SetInRange<shape_t>( shape,  MIN_ALPHA, MAX_ALPHA );
             MaxBurst = max_burst;
             //MaxBurst = round<burst_size_t>( max_burst );
             BurstPrd = burst_period;
+            Tokens    = 0;
+            LastBurst = 0;
 
             SetLoad( ld );
             Reset();
@@ -366,30 +628,244 @@ namespace GEN
         {
             MinBurst = round<burst_size_t>( (1.0 - 1.0/Shape) * SetInRange(load, MIN_LOAD, MAX_LOAD) * BurstPrd );
         }
+        /////////////////////////////////////////////////////////////////
+        virtual void Serialize( Archive& ar )  
+        { 
+            Stream::Serialize( ar ); 
+            ar & Tokens & LastBurst & BurstPrd & MinBurst & MaxBurst & Shape; 
+        }
     };  // class StreamVideo
 
 
-
     /////////////////////////////////////////////////////////////////////
     /////////////////////////////////////////////////////////////////////
     ///
-    /// class PacketGenerator
+    /// class StreamFGN
+    ///
+    /// Fractional Brownian traffic (Norros): the number of bytes arriving 
+    /// in each interval of T byte times is
+    ///
+    ///     A[k] = m * T + sqrt( a * m ) * T^H * X[k]
     ///
+    /// where m is the load, a the variance coefficient (in bytes), and 
+    /// X[k] is fractional Gaussian noise with Hurst parameter H.  The 
+    /// bytes of each interval form one burst at the start of the interval.
+    /// T is chosen so that the mean burst is 'mean_burst' bytes, which 
+    /// keeps the cost per packet independent of the load.
+    ///
+    /// X[k] is synthesized by circulant embedding (Davies and Harte, 1987;
+    /// Wood and Chan, 1994): one FFT of size 2*block of complex Gaussian 
+    /// values weighted by the eigenvalues of the embedding gives two 
+    /// independent blocks of fGn (real and imaginary parts), each of 
+    /// 'block' intervals.  Blocks are independent, so the correlation does
+    /// not extend beyond block * interval byte times.
+    ///
+    /// Negative and fractional counts are carried to the next interval, 
+    /// so the mean rate is exact.
     /////////////////////////////////////////////////////////////////////
     /////////////////////////////////////////////////////////////////////
-    typedef Stream*  (*PF_STREAM_CTOR)( load_t, float );
+    class StreamFGN final : public Stream
+    {
+    private:
+        shape_t         Hurst;          // Hurst parameter, 0.5 < H < 1
+        float           Variance;       // variance coefficient a (in bytes)
+        float           MeanBurst;      // mean burst size (in bytes)
+        pause_size_t    Interval;       // interval T (in bytes)
+        int32s          Block;          // intervals per block (power of 2)
+        DOUBLE          Mean;           // mean bytes per interval
+        DOUBLE          Scale;          // std. deviation of bytes per interval
+        DOUBLE          Carry;          // bytes not yet assigned to a burst
+        int32s          Pos;            // next noise value in the block
+
+        FFT             Transform;
+        DOUBLE*         pEigen;         // sqrt of circulant eigenvalues (scaled)
+        FFT::complex_t* pWork;
+        DOUBLE*         pNoise;         // current two blocks of X[k]
+
+        /////////////////////////////////////////////////////////////////
+        // Autocovariance of unit-variance fGn at lag k
+        /////////////////////////////////////////////////////////////////
+        inline DOUBLE Covariance( int32s k ) const
+        {
+            DOUBLE h2 = 2.0 * Hurst;
+            return 0.5 * ( pow( k + 1.0, h2 ) - 2.0 * pow( (DOUBLE) k, h2 ) + pow( fabs( k - 1.0 ), h2 ));
+        }
 
-    class PacketGenerator
+        /////////////////////////////////////////////////////////////////
+        // Eigenvalues of the circulant matrix whose first row is 
+        // c = [ r(0) .. r(N) r(N-1) .. r(1) ], with N = Block
+        /////////////////////////////////////////////////////////////////
+        void InitEigen( void )
+        {
+            int32s size = 2 * Block;
+
+            for( int32s k = 0; k <= Block; k++ )
+                pWork[k] = Covariance( k );
+            for( int32s k = Block + 1; k < size; k++ )
+                pWork[k] = pWork[ size - k ];
+
+            Transform.Transform( pWork );
+
+            /* eigenvalues are real and non-negative for fGn; round-off is clipped */
+            for( int32s k = 0; k < size; k++ )
+                pEigen[k] = sqrt( MAX< DOUBLE >( pWork[k].real(), 0.0 ) / size );
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // Synthesizes the next two blocks of fGn
+        /////////////////////////////////////////////////////////////////
+        void Synthesize( void )
+        {
+            int32s size = 2 * Block;
+            DOUBLE z1, z2;
+
+            for( int32s k = 0; k < size; k++ )
+            {
+                _normal_pair_( z1, z2 );
+                pWork[k] = FFT::complex_t( pEigen[k] * z1, pEigen[k] * z2 );
+            }
+
+            Transform.Transform( pWork );
+
+            for( int32s k = 0; k < Block; k++ )
+            {
+                pNoise[k]         = pWork[k].real();
+                pNoise[k + Block] = pWork[k].imag();
+            }
+            Pos = 0;
+        }
+
+        /////////////////////////////////////////////////////////////////
+        virtual inline burst_size_t NextBurstSize(void)
+        {
+            if( Pos == 2 * Block )
+                Synthesize();
+
+            Carry += Mean + Scale * pNoise[ Pos++ ];
+            if( Carry < 1.0 )
+                return 0;
+
+            burst_size_t burst = (burst_size_t) Carry;
+            Carry -= burst;
+            return burst;
+        }
+
+        /* not used: bursts arrive every Interval (see ExtractBurst) */
+        virtual inline pause_size_t NextPauseSize(void) { return 0; }
+
+        /////////////////////////////////////////////////////////////////
+
+    public:
+        StreamFGN( load_t ld, float mean_burst, shape_t hurst, float variance, int32s block ) 
+            : Stream(), Transform( 2 * block )
+        { 
+            Hurst     = SetInRange<shape_t>( hurst, 0.5F, 0.99F );
+            Variance  = variance;
+            MeanBurst = mean_burst;
+            Block     = block;
+            pEigen    = new DOUBLE[ 2 * Block ];
+            pWork     = new FFT::complex_t[ 2 * Block ];
+            pNoise    = new DOUBLE[ 2 * Block ];
+
+            InitEigen();
+            SetLoad( ld );
+            Reset();
+        }
+        /////////////////////////////////////////////////////////////////
+        virtual ~StreamFGN()       
+        {
+            delete [] pEigen;
+            delete [] pWork;
+            delete [] pNoise;
+        }
+        /////////////////////////////////////////////////////////////////
+                
+        virtual inline void SetLoad( load_t load )
+        {
+            DOUBLE rate = SetInRange(load, MIN_LOAD, MAX_LOAD);
+            Interval = MAX< pause_size_t >( round<pause_size_t>( MeanBurst / rate ), 1 );
+            Mean     = rate * Interval;
+            Scale    = sqrt( Variance * rate ) * pow( (DOUBLE) Interval, (DOUBLE) Hurst );
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // Starts a new, independent block at time 0.  The first interval 
+        // starts at a random offset, like the quick start of StreamT::Reset().
+        /////////////////////////////////////////////////////////////////
+        virtual void Reset(void)
+        {
+            Carry     = 0;
+            Synthesize();
+            BurstSize = NextBurstSize();
+            BurstTime = _uniform_int_( 0, (rnd_int_t)Interval - 1 );
+        }
+
+        /////////////////////////////////////////////////////////////////
+        virtual void ExtractBurst(void)
+        {
+            BurstTime += Interval;
+            BurstSize  = NextBurstSize();
+        }
+
+        /////////////////////////////////////////////////////////////////
+        virtual void Serialize( Archive& ar )  
+        { 
+            Stream::Serialize( ar ); 
+            ar & Hurst & Variance & MeanBurst & Interval & Mean & Scale & Carry & Pos; 
+            ar.Check( Block );
+            ar.Raw( pNoise, 2 * Block * sizeof( DOUBLE ));
+        }
+    };  // class StreamFGN
+
+
+
+    /////////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////
+    ///
+    /// class PacketGeneratorBase
+    ///     Aggregates the bursts of a pool of streams of type S into 
+    ///     packets.  S is Stream for a pool of streams of any type.
+    ///
+    /////////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////
+    template < class S > class PacketGeneratorBase
     {
         //////////////////////////////////////////////////////////////////
-        // Nested class StreamPool
+        // Nested class StreamPool: streams ordered by their next burst
         //////////////////////////////////////////////////////////////////
-        class StreamPool: public AVL::AVLTree< bytestamp_t >
+        class StreamPool: public IndexedHeap< S, bytestamp_t >
         {
+            typedef IndexedHeap< S, bytestamp_t > heap_t;
+
         public:
-            inline Stream* GetRoot( void )  { return static_cast<Stream*>( pRoot ); }
+            //////////////////////////////////////////////////////////////
+            // Writes or reads the states of the streams in heap order.  
+            // When reading, the streams already in the pool receive the
+            // saved states, so the heap keeps the same layout.
+            //////////////////////////////////////////////////////////////
+            void Serialize( Archive& ar )
+            {
+                ar & heap_t::Inserted;
+                for( int32s n = 0; n < heap_t::Count; n++ )
+                {
+                    ar & heap_t::pHeap[n].Order;
+                    heap_t::pHeap[n].pNode->Serialize( ar );
+                    heap_t::pHeap[n].Key = heap_t::pHeap[n].pNode->GetKey();
+                }
+            }
         };
 
+        /////////////////////////////////////////////////////////////////
+        // Calls S::ExtractBurst() directly, unless S is Stream
+        /////////////////////////////////////////////////////////////////
+        static inline void ExtractBurst( S* pStrm )
+        {
+            if constexpr( std::is_same< S, Stream >::value )
+                pStrm->ExtractBurst();
+            else
+                pStrm->S::ExtractBurst();
+        }
+
 
     protected:
         
@@ -410,56 +886,27 @@ namespace GEN
 
     public:
         /////////////////////////////////////////////////////////////////
-        // FUNCTION:    PacketGenerator( pckt_size_t IFG )
+        // FUNCTION:    PacketGeneratorBase( source_id_t  source_id, 
+        //                                   pckt_size_t  IFG,
+        //                                   PF_PCKT_SIZE pf_size )
         // DESCRIPTION: Constructor
+        // NOTES:       Without pf_size, the first packet has size 0
         /////////////////////////////////////////////////////////////////
-        PacketGenerator( source_id_t source_id, pckt_size_t inter_packet_gap )                   
+        PacketGeneratorBase( source_id_t source_id, pckt_size_t inter_packet_gap, PF_PCKT_SIZE pf_size = NULL )                   
         { 
-            MinIFG    = inter_packet_gap;
-            BusyPool  = &Pool1;
-            IdlePool  = &Pool2;
-
-            Tokens = 0;
-            Elapsed   = 0;
-
-            NextPacket.SourceId = source_id;
-            NextPacket.PcktSize = 0;
-            NextPacket.Interval = NextPacket.PcktSize + MinIFG;
-        }
-
-        /////////////////////////////////////////////////////////////////
-        PacketGenerator( source_id_t     source_id,
-                         pckt_size_t     inter_packet_gap, 
-                         float           mean_burst,
-                         PF_STREAM_CTOR  pf_strm,
-                         PF_PCKT_SIZE    pf_size,
-                         int16s          pool_size,
-                         load_t          load )                   
-        {
             MinIFG     = inter_packet_gap;
             BusyPool   = &Pool1;
             IdlePool   = &Pool2;
             pfPcktSize = pf_size;
-            Tokens  = 0;
+            Tokens     = 0;
             Elapsed    = 0;
-            
+
             NextPacket.SourceId = source_id;
-            NextPacket.PcktSize = pfPcktSize();
+            NextPacket.PcktSize = pfPcktSize? pfPcktSize(): 0;
             NextPacket.Interval = NextPacket.PcktSize + MinIFG;
-
-            for( int16s s = 0; s < pool_size; s++ )
-            {
-                AddStream( pf_strm( load / pool_size, mean_burst ) );
-            }
-
         }
 
-        /////////////////////////////////////////////////////////////////
-        // FUNCTION:    ~PacketGenerator()
-        // DESCRIPTION: Destructor
-        // NOTES:
-        /////////////////////////////////////////////////////////////////
-        virtual ~PacketGenerator()        { Clear(); }
+        virtual ~PacketGeneratorBase()    {}
 
         /////////////////////////////////////////////////////////////////
         // FUNCTION:    void Reset( void )
@@ -469,7 +916,7 @@ namespace GEN
         /////////////////////////////////////////////////////////////////
         void Reset( void )
         {
-            for( Stream* pNode = RemoveStream(); pNode; pNode = RemoveStream() )
+            for( S* pNode = RemoveStream(); pNode; pNode = RemoveStream() )
             {
                 pNode->Reset();
                 IdlePool->AddNode( pNode );
@@ -487,15 +934,15 @@ namespace GEN
         // FUNCTION:    void AddSource( Source* )
         // DESCRIPTION: Adds a new source of to the PacketGenerator.
         /////////////////////////////////////////////////////////////////
-        inline void AddStream( Stream* pSrc )         { BusyPool->AddNode( pSrc ); }
+        inline void AddStream( S* pSrc )         { BusyPool->AddNode( pSrc ); }
 
         /////////////////////////////////////////////////////////////////
         // FUNCTION:    RemoveSource( Source* )  
         // DESCRIPTION: Removes source
         // NOTES:
         /////////////////////////////////////////////////////////////////
-        inline void     RemoveStream( Stream* pSrc )  { BusyPool->RemoveNode( pSrc ); }
-        inline Stream*  RemoveStream( void )          { return (Stream*)BusyPool->RemoveHead(); }
+        inline void     RemoveStream( S* pSrc )  { BusyPool->RemoveNode( pSrc ); }
+        inline S*       RemoveStream( void )     { return BusyPool->RemoveHead(); }
 
         /////////////////////////////////////////////////////////////////
         // FUNCTION:    Packet PeekNextPacket(void)
@@ -512,22 +959,22 @@ namespace GEN
         /////////////////////////////////////////////////////////////////
         Packet GetNextPacket(void)
         {
-            Stream*     pStrm;
+            S*          pStrm;
             Packet      next_packet = NextPacket;
             pckt_size_t pckt_size   = pfPcktSize();
             bytestamp_t pckt_time   = Elapsed;
 
             // if the remaining burst size is less thn the packet size,
             // aggregate additional bursts
-            while( Tokens < pckt_size && (pStrm = (Stream*)BusyPool->RemoveHead()) != NULL ) 
+            while( Tokens < pckt_size && (pStrm = BusyPool->GetHead()) != NULL ) 
             {
                 if( pStrm->GetArrival() > pckt_time + Tokens )
                     pckt_time = pStrm->GetArrival() - Tokens;
 
                 Tokens += pStrm->GetBurstSize();
                 
-                pStrm->ExtractBurst();        // receive new burst
-                BusyPool->AddNode( pStrm );   // place the stream in BusyPool
+                ExtractBurst( pStrm );        // receive new burst
+                BusyPool->UpdateHead();       // move the stream to its new place in BusyPool
             }
 
             Tokens -= pckt_size;
@@ -550,8 +997,8 @@ namespace GEN
         /////////////////////////////////////////////////////////////////
         void SetLoad( load_t load )
         {
-            if( BusyPool->GetRoot() )
-                BusyPool->GetRoot()->SetLoadRecursive( load / GetStreams() );
+            for( int32s n = 0; n < GetStreams(); n++ )
+                BusyPool->GetNode( n )->SetLoad( load / GetStreams() );
         }
     
         /////////////////////////////////////////////////////////////////
@@ -568,7 +1015,7 @@ namespace GEN
         {
             load /= GetStreams();
 
-            for( Stream* pNode = RemoveStream(); pNode; pNode = RemoveStream() )
+            for( S* pNode = RemoveStream(); pNode; pNode = RemoveStream() )
             {
                 pNode->SetLoad( load );
                 pNode->Reset();
@@ -579,6 +1026,139 @@ namespace GEN
             Elapsed = 0;
         }
 
+        /////////////////////////////////////////////////////////////////
+        // FUNCTION:    void Serialize( Archive& ar )
+        // DESCRIPTION: Writes or reads the state of the generator and 
+        //              of all its streams
+        // NOTES:       Streams are interchangeable, so when reading, the 
+        //              saved states are assigned to the streams already 
+        //              in the pool (see StreamPool::Serialize).
+        /////////////////////////////////////////////////////////////////
+        void Serialize( Archive& ar )
+        {
+            ar & NextPacket & Elapsed & MinIFG & Tokens;
+            ar.Check( GetStreams() );
+            BusyPool->Serialize( ar );
+        }
+
+    };  // class PacketGeneratorBase
+
+
+
+    /////////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////
+    ///
+    /// class PacketGeneratorT
+    ///     Packet generator with a pool of streams of type S, stored by 
+    ///     value in one array.  Streams are constructed in place by 
+    ///     pf_strm( ptr, load, mean_burst ).
+    ///
+    /////////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////
+    template < class S > class PacketGeneratorT : public PacketGeneratorBase< S >
+    {
+    public:
+        typedef void (*ctor_t)( S*, load_t, float );
+
+    private:
+        S*          pStreams;
+        int16s      StreamCount;
+
+    public:
+        /////////////////////////////////////////////////////////////////
+        PacketGeneratorT( source_id_t     source_id,
+                          pckt_size_t     inter_packet_gap, 
+                          float           mean_burst,
+                          ctor_t          pf_strm,
+                          PF_PCKT_SIZE    pf_size,
+                          int16s          pool_size,
+                          load_t          load ) : 
+            PacketGeneratorBase< S >( source_id, inter_packet_gap, pf_size )
+        {
+            pStreams    = static_cast< S* >( ::operator new( pool_size * sizeof( S )));
+            StreamCount = 0;
+
+            for( int16s s = 0; s < pool_size; s++ )
+            {
+                pf_strm( &pStreams[s], load / pool_size, mean_burst );
+                this->AddStream( &pStreams[s] );
+                StreamCount++;
+            }
+        }
+
+        /////////////////////////////////////////////////////////////////
+        virtual ~PacketGeneratorT()        { Clear(); }
+
+        /////////////////////////////////////////////////////////////////
+        // FUNCTION:    Clear( void )
+        // DESCRIPTION: destroys all streams
+        // NOTES:
+        /////////////////////////////////////////////////////////////////
+        void Clear( void )
+        {
+            while( this->RemoveStream() )
+                ;
+
+            for( int16s s = 0; s < StreamCount; s++ )
+                pStreams[s].~S();
+            ::operator delete( pStreams );
+
+            pStreams    = NULL;
+            StreamCount = 0;
+            this->Reset();
+        }
+
+    };  // class PacketGeneratorT
+
+
+
+    /////////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////
+    ///
+    /// class PacketGenerator
+    ///     Packet generator with a pool of streams of any type, created 
+    ///     by pf_strm( load, mean_burst ) or added with AddStream()
+    ///
+    /////////////////////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////////////////////
+    typedef Stream*  (*PF_STREAM_CTOR)( load_t, float );
+
+    template <> class PacketGeneratorT< Stream > : public PacketGeneratorBase< Stream >
+    {
+    public:
+        typedef PF_STREAM_CTOR ctor_t;
+
+        /////////////////////////////////////////////////////////////////
+        // FUNCTION:    PacketGenerator( pckt_size_t IFG )
+        // DESCRIPTION: Constructor
+        /////////////////////////////////////////////////////////////////
+        PacketGeneratorT( source_id_t source_id, pckt_size_t inter_packet_gap ) :
+            PacketGeneratorBase< Stream >( source_id, inter_packet_gap ) {}
+
+        /////////////////////////////////////////////////////////////////
+        PacketGeneratorT( source_id_t     source_id,
+                          pckt_size_t     inter_packet_gap, 
+                          float           mean_burst,
+                          PF_STREAM_CTOR  pf_strm,
+                          PF_PCKT_SIZE    pf_size,
+                          int16s          pool_size,
+                          load_t          load ) : 
+            PacketGeneratorBase< Stream >( source_id, inter_packet_gap, pf_size )
+        {
+            for( int16s s = 0; s < pool_size; s++ )
+            {
+                AddStream( pf_strm( load / pool_size, mean_burst ) );
+            }
+
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // FUNCTION:    ~PacketGenerator()
+        // DESCRIPTION: Destructor
+        // NOTES:
+        /////////////////////////////////////////////////////////////////
+        virtual ~PacketGeneratorT()        { Clear(); }
+
         /////////////////////////////////////////////////////////////////
         // FUNCTION:    Clear( void )
         // DESCRIPTION: deletes all allocated streams
@@ -594,6 +1174,8 @@ namespace GEN
 
     };  // class PacketGenerator
 
+    typedef PacketGeneratorT< Stream >  PacketGenerator;
+
 
 
     /////////////////////////////////////////////////////////////////////
@@ -601,12 +1183,13 @@ namespace GEN
     ///
     /// class PacketGeneratorDist
     ///     Generates packets with a specified distribution of sizes
+    ///     with packet generator G (PacketGenerator or PacketGeneratorT)
     ///
     /////////////////////////////////////////////////////////////////////
     /////////////////////////////////////////////////////////////////////
 
-    template< class T, int32s N, T (*PF_FREQUENCY)(int32s) > class PacketGeneratorDist : 
-        public PacketGenerator, 
+    template< class T, int32s N, T (*PF_FREQUENCY)(int32s), class G = PacketGenerator > class PacketGeneratorDist : 
+        public G, 
         public GenericDistribByIndex< T, N, PF_FREQUENCY >
     
     {
@@ -617,14 +1200,14 @@ namespace GEN
         PacketGeneratorDist( source_id_t            source_id, 
                              pckt_size_t            inter_packet_gap, 
                              float                  mean_burst,
-                             PF_STREAM_CTOR         pf_strm,
+                             typename G::ctor_t     pf_strm,
                              int16s                 pool_size,
                              load_t                 load ) : 
-            PacketGenerator( source_id, 
+            G(               source_id, 
                              inter_packet_gap, 
                              mean_burst, 
                              pf_strm,
-                             PacketGeneratorDist< T, N, PF_FREQUENCY >::GetPacketSize,
+                             PacketGeneratorDist< T, N, PF_FREQUENCY, G >::GetPacketSize,
                              pool_size,
                              load ), 
             GenericDistribByIndex< T, N, PF_FREQUENCY >() {}